@@ -0,0 +1,165 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/Culling.hpp"
+#include "scene/Scene.hpp"
+
+namespace {
+
+// Boxes scattered over a region about twice the frustum's size, so roughly an eighth survive
+ENG::CullingBounds random_bounds(size_t count, std::vector<ENG::AABB>& boxes)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-2.f, 2.f);
+	std::uniform_real_distribution<float> size(0.01f, 0.1f);
+	ENG::CullingBounds bounds;
+	bounds.resize(count);
+	boxes.resize(count);
+	for (uint32_t i = 0; i < count; ++i) {
+		const glm::vec3 c{ position(rng), position(rng), position(rng) };
+		boxes[i] = ENG::make_aabb(c - glm::vec3(size(rng)), c + glm::vec3(size(rng)));
+		bounds.set(i, boxes[i]);
+	}
+	return bounds;
+}
+
+ENG::Frustum unit_box_frustum()
+{
+	ENG::Frustum frustum;
+	frustum.planes = { glm::vec4(1.f, 0.f, 0.f, 1.f), glm::vec4(-1.f, 0.f, 0.f, 1.f),
+		glm::vec4(0.f, 1.f, 0.f, 1.f), glm::vec4(0.f, -1.f, 0.f, 1.f),
+		glm::vec4(0.f, 0.f, 1.f, 1.f), glm::vec4(0.f, 0.f, -1.f, 1.f) };
+	return frustum;
+}
+
+// One classify() per AABB, as a per-node loop in the recorder would do it
+void BM_CullClassify(benchmark::State& state)
+{
+	std::vector<ENG::AABB> boxes;
+	random_bounds(state.range(0), boxes);
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		visible.clear();
+		for (uint32_t i = 0; i < boxes.size(); ++i) {
+			if (ENG::classify(frustum, boxes[i]) != ENG::Containment::Outside) visible.push_back(i);
+		}
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CullFrustum(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	std::vector<ENG::AABB> boxes;
+	const auto bounds = random_bounds(state.range(0), boxes);
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		ENG::cull_frustum(frustum, bounds, visible, level);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Groups of 640 small boxes, like the planet's tiles, scattered as in random_bounds. Tiles
+// are spread around their group's origin by up to spread.
+void build_grouped_scene(ENG::SceneState& sceneState, size_t count, float spread = 0.05f)
+{
+	constexpr size_t GROUP_SIZE = 640;
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-2.f, 2.f);
+	std::uniform_real_distribution<float> offset(-spread, spread);
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	for (size_t first = 0; first < count; first += GROUP_SIZE) {
+		auto& group = graph.create_node();
+		graph.add_child(root, group);
+		group.translation = { position(rng), position(rng), position(rng) };
+		const auto range = graph.create_nodes(std::min(GROUP_SIZE, count - first), &group);
+		sceneState.aabbs.resize(graph.nodes.size());
+		for (uint32_t i = 0; i < range.count; ++i) {
+			auto& tile = graph.nodes[range.id(i)];
+			tile.translation = { offset(rng), offset(rng), offset(rng) };
+			sceneState.aabbs[tile.nodeId] = ENG::make_aabb(glm::vec3(-0.01f), glm::vec3(0.01f));
+		}
+	}
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+}
+
+void BM_CullHierarchy(benchmark::State& state)
+{
+	ENG::SceneState sceneState;
+	build_grouped_scene(sceneState, state.range(0));
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		ENG::cull_hierarchy(frustum, sceneState.transforms.preorder(), sceneState.subtreeBounds, sceneState.cullingBounds, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// The same grouped scene, testing every node's box
+void BM_CullGroupedFlat(benchmark::State& state)
+{
+	ENG::SceneState sceneState;
+	build_grouped_scene(sceneState, state.range(0));
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		ENG::cull_frustum(frustum, sceneState.cullingBounds, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// Groups spread over the whole region, so most of them straddle the frustum and their
+// tiles go through the SIMD kernel
+void BM_CullHierarchyStraddling(benchmark::State& state)
+{
+	ENG::SceneState sceneState;
+	build_grouped_scene(sceneState, state.range(0), 1.5f);
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		ENG::cull_hierarchy(frustum, sceneState.transforms.preorder(), sceneState.subtreeBounds, sceneState.cullingBounds, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_CullStraddlingFlat(benchmark::State& state)
+{
+	ENG::SceneState sceneState;
+	build_grouped_scene(sceneState, state.range(0), 1.5f);
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> visible;
+	for (auto _ : state) {
+		ENG::cull_frustum(frustum, sceneState.cullingBounds, visible);
+		benchmark::DoNotOptimize(visible.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // end namespace
+
+BENCHMARK(BM_CullClassify)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_CullFrustum, Scalar, ENG::SimdLevel::Scalar)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_CullFrustum, SSE41, ENG::SimdLevel::SSE41)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_CullFrustum, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_CullHierarchy)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_CullGroupedFlat)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_CullHierarchyStraddling)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK(BM_CullStraddlingFlat)->RangeMultiplier(10)->Range(1000, 100000);
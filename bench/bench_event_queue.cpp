@@ -0,0 +1,146 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "application/ConcurrentQueue.hpp"
+#include "application/MpscQueue.hpp"
+
+// Loader threads pushing events while the main thread drains them, as with the graphics
+// event queue. The argument is the number of producer threads; each pushes
+// ITEMS_PER_PRODUCER events while one consumer drains until it has seen them all. The
+// timed region starts when the producers are released and ends when the consumer is done.
+
+namespace {
+
+constexpr size_t ITEMS_PER_PRODUCER = 50000;
+constexpr size_t BOUNDED_CAPACITY = 1024;
+
+// About the size of a CommandCompletionEvent
+struct Event {
+	uint64_t value{ 0 };
+	std::function<void(void)> handler;
+};
+
+template<typename Queue, typename Consume>
+void run_contention(benchmark::State& state, Consume consume)
+{
+	const auto producerCount = static_cast<size_t>(state.range(0));
+	const auto total = producerCount * ITEMS_PER_PRODUCER;
+
+	for (auto _ : state)
+	{
+		Queue queue{};
+		std::atomic<bool> start{ false };
+		std::vector<std::thread> producers;
+		producers.reserve(producerCount);
+		for (size_t p = 0; p < producerCount; ++p)
+		{
+			producers.emplace_back([&queue, &start] {
+				while (!start.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+				for (size_t i = 0; i < ITEMS_PER_PRODUCER; ++i)
+				{
+					queue.push(Event{ i, {} });
+				}
+			});
+		}
+
+		const auto begin = std::chrono::steady_clock::now();
+		start.store(true, std::memory_order_release);
+		uint64_t sum = 0;
+		size_t received = 0;
+		while (received < total)
+		{
+			const size_t count = consume(queue, sum);
+			if (count == 0)
+			{
+				// Let producers run when there are fewer cores than threads
+				std::this_thread::yield();
+			}
+			received += count;
+		}
+		const auto end = std::chrono::steady_clock::now();
+
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+		benchmark::DoNotOptimize(sum);
+		state.SetIterationTime(std::chrono::duration<double>(end - begin).count());
+	}
+	state.SetItemsProcessed(state.iterations() * total);
+}
+
+struct BoundedMpscQueue : MpscQueue<Event> {
+	BoundedMpscQueue() : MpscQueue<Event>(BOUNDED_CAPACITY) {}
+};
+
+// The pattern handleGraphicsEvents used before: empty() then pop(), one lock each
+size_t consume_locked(ConcurrentQueue<Event>& queue, uint64_t& sum)
+{
+	size_t count = 0;
+	while (!queue.empty())
+	{
+		sum += queue.pop().value;
+		++count;
+	}
+	return count;
+}
+
+size_t consume_try_pop(MpscQueue<Event>& queue, uint64_t& sum)
+{
+	size_t count = 0;
+	while (auto event = queue.try_pop())
+	{
+		sum += event->value;
+		++count;
+	}
+	return count;
+}
+
+size_t consume_drain(MpscQueue<Event>& queue, uint64_t& sum)
+{
+	std::array<Event, 32> events{};
+	const size_t count = queue.drain_into(events);
+	for (size_t i = 0; i < count; ++i)
+	{
+		sum += events[i].value;
+	}
+	return count;
+}
+
+void BM_EventQueueLocked(benchmark::State& state)
+{
+	run_contention<ConcurrentQueue<Event>>(state, consume_locked);
+}
+
+void BM_EventQueueMpscTryPop(benchmark::State& state)
+{
+	run_contention<MpscQueue<Event>>(state, consume_try_pop);
+}
+
+void BM_EventQueueMpscDrain(benchmark::State& state)
+{
+	run_contention<MpscQueue<Event>>(state, consume_drain);
+}
+
+// Producers outrun the consumer and wait for space
+void BM_EventQueueMpscBounded(benchmark::State& state)
+{
+	run_contention<BoundedMpscQueue>(state, [](MpscQueue<Event>& queue, uint64_t& sum) { return consume_drain(queue, sum); });
+}
+
+} // end namespace
+
+BENCHMARK(BM_EventQueueLocked)->RangeMultiplier(2)->Range(1, 8)->UseManualTime();
+BENCHMARK(BM_EventQueueMpscTryPop)->RangeMultiplier(2)->Range(1, 8)->UseManualTime();
+BENCHMARK(BM_EventQueueMpscDrain)->RangeMultiplier(2)->Range(1, 8)->UseManualTime();
+BENCHMARK(BM_EventQueueMpscBounded)->RangeMultiplier(2)->Range(1, 8)->UseManualTime();
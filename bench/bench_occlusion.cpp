@@ -0,0 +1,56 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/Occlusion.hpp"
+
+namespace {
+
+// Triangles of a few pixels to a few dozen pixels, spread over the view
+ENG::TriangleBvh occluder_soup(size_t count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> position(-6.f, 6.f);
+	std::uniform_real_distribution<float> depth(-30.f, -2.f);
+	std::uniform_real_distribution<float> offset(-1.f, 1.f);
+	std::vector<glm::vec3> positions;
+	for (size_t i = 0; i < count; ++i) {
+		const glm::vec3 c{ position(rng), position(rng), depth(rng) };
+		for (int corner = 0; corner < 3; ++corner) {
+			positions.push_back(c + glm::vec3(offset(rng), offset(rng), offset(rng)));
+		}
+	}
+	return ENG::TriangleBvh(&positions[0].x, positions.size(), sizeof(glm::vec3), {});
+}
+
+glm::mat4 camera_view_projection()
+{
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	return glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 100.f) * view;
+}
+
+void BM_OcclusionRasterize(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	const auto mesh = occluder_soup(state.range(0));
+	const auto viewProjection = camera_view_projection();
+	ENG::OcclusionBuffer buffer;
+	for (auto _ : state) {
+		buffer.clear();
+		buffer.rasterize(viewProjection, mesh, level);
+		buffer.build_pyramid();
+		benchmark::DoNotOptimize(buffer.depth_image().data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // end namespace
+
+BENCHMARK_CAPTURE(BM_OcclusionRasterize, Scalar, ENG::SimdLevel::Scalar)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_OcclusionRasterize, SSE41, ENG::SimdLevel::SSE41)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_OcclusionRasterize, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/JCT.hpp"
+
+namespace {
+
+constexpr int RAYS_PER_ITERATION = 16;
+
+// Alternating hexagons and pentagons tangent to the unit sphere
+void goldberg_like_faces(size_t count, std::vector<uint32_t>& offsets, std::vector<glm::vec3>& vertices)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	offsets = { 0 };
+	vertices.clear();
+	for (size_t face = 0; face < count; ++face) {
+		const auto normal = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+		const auto tangent = glm::normalize(glm::cross(normal, std::fabs(normal.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f)));
+		const auto bitangent = glm::cross(normal, tangent);
+		const int corners = face % 2 == 0 ? 6 : 5;
+		for (int k = 0; k < corners; ++k) {
+			const float angle = 6.2831853f * k / corners;
+			vertices.push_back(normal + 0.05f * (std::cos(angle) * tangent + std::sin(angle) * bitangent));
+		}
+		offsets.push_back(static_cast<uint32_t>(vertices.size()));
+	}
+}
+
+std::vector<glm::vec3> ray_origins()
+{
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	std::vector<glm::vec3> origins;
+	for (int i = 0; i < RAYS_PER_ITERATION; ++i) {
+		origins.push_back(3.f * glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng))));
+	}
+	return origins;
+}
+
+struct FanTriangle {
+	glm::vec3 v0, edge1, edge2;
+};
+
+// Every face as a triangle fan, each triangle tested with Moller-Trumbore
+void BM_TriangleFanMollerTrumbore(benchmark::State& state)
+{
+	std::vector<uint32_t> offsets;
+	std::vector<glm::vec3> vertices;
+	goldberg_like_faces(state.range(0), offsets, vertices);
+	std::vector<FanTriangle> triangles;
+	std::vector<uint32_t> triangleFace;
+	for (uint32_t face = 0; face + 1 < offsets.size(); ++face) {
+		const auto& v0 = vertices[offsets[face]];
+		for (auto k = offsets[face] + 1; k + 1 < offsets[face + 1]; ++k) {
+			triangles.push_back({ v0, vertices[k] - v0, vertices[k + 1] - v0 });
+			triangleFace.push_back(face);
+		}
+	}
+	const auto origins = ray_origins();
+
+	for (auto _ : state) {
+		for (const auto& origin : origins) {
+			const auto direction = -origin / 3.f;
+			float bestT = 10.f;
+			uint32_t bestFace = UINT32_MAX;
+			for (size_t i = 0; i < triangles.size(); ++i) {
+				const auto& tri = triangles[i];
+				const auto p = glm::cross(direction, tri.edge2);
+				const float det = glm::dot(tri.edge1, p);
+				if (std::fabs(det) < 1e-12f) continue;
+				const float invDet = 1.f / det;
+				const auto s = origin - tri.v0;
+				const float u = glm::dot(s, p) * invDet;
+				if (u < 0.f || u > 1.f) continue;
+				const auto q = glm::cross(s, tri.edge1);
+				const float v = glm::dot(direction, q) * invDet;
+				if (v < 0.f || u + v > 1.f) continue;
+				const float t = glm::dot(tri.edge2, q) * invDet;
+				if (t >= 0.f && t < bestT) {
+					bestT = t;
+					bestFace = triangleFace[i];
+				}
+			}
+			benchmark::DoNotOptimize(bestFace);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * RAYS_PER_ITERATION);
+}
+
+void BM_PolygonBatch(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	std::vector<uint32_t> offsets;
+	std::vector<glm::vec3> vertices;
+	goldberg_like_faces(state.range(0), offsets, vertices);
+	const PolygonBatch batch(offsets, vertices);
+	const auto origins = ray_origins();
+
+	for (auto _ : state) {
+		for (const auto& origin : origins) {
+			auto hit = batch.intersect(origin, -origin / 3.f, 10.f, level);
+			benchmark::DoNotOptimize(hit);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * RAYS_PER_ITERATION);
+}
+
+} // end namespace
+
+BENCHMARK(BM_TriangleFanMollerTrumbore)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_PolygonBatch, Scalar, ENG::SimdLevel::Scalar)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_PolygonBatch, SSE41, ENG::SimdLevel::SSE41)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_PolygonBatch, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/Picking.hpp"
+#include "scene/RayQueries.hpp"
+
+namespace {
+
+// 8 x 8 grid of selectable triangle soups in front of the origin
+struct RayScene {
+	ENG::SceneState sceneState;
+
+	RayScene()
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> offset(-1.f, 1.f);
+		std::vector<glm::vec3> positions;
+		for (int i = 0; i < 500; ++i) {
+			const glm::vec3 c{ offset(rng), offset(rng), offset(rng) };
+			for (int corner = 0; corner < 3; ++corner) {
+				positions.push_back(c + 0.1f * glm::vec3(offset(rng), offset(rng), offset(rng)));
+			}
+		}
+		const auto soup = std::make_shared<const ENG::TriangleBvh>(&positions[0].x, positions.size(), sizeof(glm::vec3), std::span<const uint32_t>{});
+
+		auto& graph = sceneState.graph;
+		auto& root = graph.create_node();
+		graph.root = &root;
+		std::vector<ENG::Node*> meshes;
+		for (int x = 0; x < 8; ++x) {
+			for (int y = 0; y < 8; ++y) {
+				auto& node = graph.create_node();
+				graph.add_child(root, node);
+				node.translation = { 2.5f * x - 8.75f, 2.5f * y - 8.75f, -20.f };
+				node.selectable = true;
+				meshes.push_back(&node);
+			}
+		}
+		sceneState.aabbs.resize(graph.nodes.size());
+		sceneState.pickMeshes.resize(graph.nodes.size());
+		for (auto* node : meshes) {
+			sceneState.aabbs[node->nodeId] = soup->bounds();
+			sceneState.pickMeshes[node->nodeId] = soup;
+		}
+
+		std::vector<ENG::MatrixRange> ranges;
+		sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+		ENG::update_world_bounds(sceneState, ranges);
+	}
+};
+
+// Row-major sweep over the grid, so consecutive rays are coherent
+std::vector<ENG::Ray> sweep_rays(size_t count)
+{
+	const auto side = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+	std::vector<ENG::Ray> rays(count);
+	for (size_t i = 0; i < count; ++i) {
+		const float x = static_cast<float>(i % side) / static_cast<float>(side) - 0.5f;
+		const float y = static_cast<float>(i / side) / static_cast<float>(side) - 0.5f;
+		rays[i].origin = glm::vec3(0.f);
+		rays[i].direction = glm::normalize(glm::vec3(x, y, -1.f));
+		rays[i].maxT = 100.f;
+	}
+	return rays;
+}
+
+// One pick() per ray, the single ray path
+void BM_RayPickLoop(benchmark::State& state)
+{
+	const RayScene scene;
+	const auto rays = sweep_rays(state.range(0));
+	for (auto _ : state) {
+		size_t hits = 0;
+		for (const auto& ray : rays) {
+			hits += ENG::pick(scene.sceneState, ray).has_value() ? 1 : 0;
+		}
+		benchmark::DoNotOptimize(hits);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_IntersectRays(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	const RayScene scene;
+	const auto rays = sweep_rays(state.range(0));
+	std::vector<ENG::RayHit> hits(rays.size());
+	for (auto _ : state) {
+		ENG::intersect_rays(scene.sceneState, rays, hits, level);
+		benchmark::DoNotOptimize(hits.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_OccludedRays(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	const RayScene scene;
+	const auto rays = sweep_rays(state.range(0));
+	std::vector<uint8_t> occluded(rays.size());
+	for (auto _ : state) {
+		ENG::occluded_rays(scene.sceneState, rays, occluded, level);
+		benchmark::DoNotOptimize(occluded.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // end namespace
+
+BENCHMARK(BM_RayPickLoop)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_IntersectRays, Scalar, ENG::SimdLevel::Scalar)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_IntersectRays, SSE41, ENG::SimdLevel::SSE41)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_IntersectRays, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_OccludedRays, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
@@ -0,0 +1,134 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/Scene.hpp"
+#include "scene/Node.hpp"
+
+// Visibility and draw list passes over the pointer based SceneGraph and the SceneStore
+// arrays, on the same 100k node wide tree. Run with
+// --benchmark_perf_counters=CYCLES,CACHE-MISSES (needs a libpfm enabled build of Google
+// Benchmark) to see the cache miss difference alongside the throughput.
+
+namespace {
+
+constexpr size_t GROUP_COUNT = 100;
+constexpr size_t CHILDREN_PER_GROUP = 999;
+
+bool is_drawn(size_t child) { return child % 4 != 0; }
+bool is_hidden_group(size_t group) { return group % 10 == 0; }
+
+std::unique_ptr<ENG::SceneGraph> make_graph()
+{
+	auto graph = std::make_unique<ENG::SceneGraph>();
+	auto& root = graph->create_node();
+	graph->root = &root;
+	for (size_t g = 0; g < GROUP_COUNT; ++g) {
+		auto& group = graph->create_node();
+		group.visible = !is_hidden_group(g);
+		graph->add_child(root, group);
+		for (size_t c = 0; c < CHILDREN_PER_GROUP; ++c) {
+			auto& child = graph->create_node();
+			if (is_drawn(c)) child.draw_data_idx = child.nodeId;
+			graph->add_child(group, child);
+		}
+	}
+	return graph;
+}
+
+std::unique_ptr<ENG::SceneStore<>> make_store()
+{
+	auto store = std::make_unique<ENG::SceneStore<>>();
+	store->reserve(1 + GROUP_COUNT * (CHILDREN_PER_GROUP + 1));
+	const auto root = store->create();
+	for (size_t g = 0; g < GROUP_COUNT; ++g) {
+		const auto group = store->create(root);
+		if (is_hidden_group(g)) store->clear_property(group, ENG::IS_VISIBLE);
+		for (size_t c = 0; c < CHILDREN_PER_GROUP; ++c) {
+			const auto child = store->create(group);
+			if (is_drawn(c)) store->set_draw_data(child, child);
+		}
+	}
+	return store;
+}
+
+// Same work the renderer does today: walk children pointers, skip hidden subtrees,
+// collect the draw data of visible nodes
+void BM_DrawListSceneGraph(benchmark::State& state)
+{
+	const auto graph = make_graph();
+	std::vector<size_t> drawList;
+	std::vector<const ENG::Node*> stack;
+
+	for (auto _ : state) {
+		drawList.clear();
+		stack.assign(1, graph->root);
+		while (!stack.empty()) {
+			const auto* node = stack.back();
+			stack.pop_back();
+			if (!node->visible) continue;
+			if (node->draw_data_idx) drawList.push_back(*node->draw_data_idx);
+			stack.insert(stack.end(), node->children.begin(), node->children.end());
+		}
+		benchmark::DoNotOptimize(drawList.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph->nodes.live_count()));
+	state.counters["node_footprint_bytes"] = static_cast<double>(sizeof(ENG::Node));
+}
+
+void BM_DrawListSceneStore(benchmark::State& state)
+{
+	const auto store = make_store();
+	std::vector<uint32_t> visible;
+	std::vector<size_t> drawList;
+
+	for (auto _ : state) {
+		drawList.clear();
+		store->gather_visible(visible);
+		store->for_each_drawable([&drawList](uint32_t, uint32_t drawIdx) { drawList.push_back(drawIdx); });
+		benchmark::DoNotOptimize(drawList.data());
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(store->size()));
+	state.counters["node_footprint_bytes"] = static_cast<double>(ENG::SceneStore<>::bytes_per_node());
+	// Bytes read per node by the two passes: parent, flags, visibility and draw index
+	state.counters["bytes_read_per_node"] = static_cast<double>(sizeof(uint32_t) + sizeof(ENG::property_t) + 1 + sizeof(uint32_t));
+}
+
+void BM_DepthFirstSceneGraph(benchmark::State& state)
+{
+	const auto graph = make_graph();
+	std::vector<const ENG::Node*> stack;
+
+	for (auto _ : state) {
+		size_t visited = 0;
+		stack.assign(1, graph->root);
+		while (!stack.empty()) {
+			const auto* node = stack.back();
+			stack.pop_back();
+			++visited;
+			stack.insert(stack.end(), node->children.rbegin(), node->children.rend());
+		}
+		benchmark::DoNotOptimize(visited);
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(graph->nodes.live_count()));
+}
+
+void BM_DepthFirstSceneStore(benchmark::State& state)
+{
+	const auto store = make_store();
+
+	for (auto _ : state) {
+		size_t visited = 0;
+		store->depth_first_traverse([&visited](uint32_t, uint32_t) { ++visited; });
+		benchmark::DoNotOptimize(visited);
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(store->size()));
+}
+
+} // end namespace
+
+BENCHMARK(BM_DrawListSceneGraph);
+BENCHMARK(BM_DrawListSceneStore);
+BENCHMARK(BM_DepthFirstSceneGraph);
+BENCHMARK(BM_DepthFirstSceneStore);
@@ -0,0 +1,60 @@
+#include <memory>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/Scene.hpp"
+#include "scene/Transform.hpp"
+#include "application/ThreadPool.hpp"
+
+namespace {
+
+constexpr size_t GROUP_COUNT = 100;
+constexpr size_t CHILDREN_PER_GROUP = 999;
+
+// 100k nodes shaped like the Goldberg world: a few parents with very wide fan-out
+std::unique_ptr<ENG::SceneGraph> make_wide_scene()
+{
+	auto graph = std::make_unique<ENG::SceneGraph>();
+	auto& root = graph->create_node();
+	graph->root = &root;
+	for (size_t g = 0; g < GROUP_COUNT; ++g) {
+		auto& group = graph->create_node();
+		group.translation = { static_cast<float>(g), 0.f, 0.f };
+		graph->add_child(root, group);
+		for (size_t c = 0; c < CHILDREN_PER_GROUP; ++c) {
+			auto& child = graph->create_node();
+			child.translation = { 0.f, static_cast<float>(c), 0.f };
+			child.rotation = glm::angleAxis(0.001f * c, glm::vec3(0.f, 1.f, 0.f));
+			graph->add_child(group, child);
+		}
+	}
+	return graph;
+}
+
+// Full world pass over every node; Arg is the worker count, -1 for no pool at all
+void BM_TransformHierarchyFullUpdate(benchmark::State& state)
+{
+	const auto graph = make_wide_scene();
+	std::vector<glm::mat4> modelMatrices(graph->nodes.size());
+
+	std::unique_ptr<ThreadPool> pool;
+	ENG::TransformHierarchy transforms;
+	if (state.range(0) >= 0) {
+		pool = std::make_unique<ThreadPool>(static_cast<size_t>(state.range(0)));
+		transforms.set_thread_pool(pool.get());
+	}
+	transforms.sync_structure(*graph);
+	transforms.gather_local_transforms(*graph);
+
+	for (auto _ : state) {
+		transforms.update_world_matrices(modelMatrices);
+		benchmark::DoNotOptimize(modelMatrices.data());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(modelMatrices.size()));
+}
+
+} // end namespace
+
+BENCHMARK(BM_TransformHierarchyFullUpdate)->Arg(-1)->Arg(1)->Arg(3)->Arg(7)->UseRealTime();
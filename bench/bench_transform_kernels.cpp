@@ -0,0 +1,70 @@
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+#include "scene/TransformKernels.hpp"
+
+namespace {
+
+std::vector<ENG::TRS> random_transforms(size_t count)
+{
+	std::mt19937 rng(42);
+	std::uniform_real_distribution<float> dist(-2.f, 2.f);
+	std::vector<ENG::TRS> transforms(count);
+	for (auto& trs : transforms) {
+		trs.translation = { dist(rng), dist(rng), dist(rng) };
+		trs.rotation = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+		trs.scale = { dist(rng), dist(rng), dist(rng) };
+	}
+	return transforms;
+}
+
+void set_counters(benchmark::State& state)
+{
+	const auto count = static_cast<int64_t>(state.range(0));
+	state.SetItemsProcessed(state.iterations() * count);
+	state.SetBytesProcessed(state.iterations() * count * static_cast<int64_t>(sizeof(ENG::TRS) + sizeof(glm::mat4)));
+}
+
+// Previous per-node path: translate * mat4_cast * scale through glm
+void BM_ComposeTrsGlm(benchmark::State& state)
+{
+	const auto transforms = random_transforms(state.range(0));
+	std::vector<glm::mat4> out(transforms.size());
+	for (auto _ : state) {
+		for (size_t i = 0; i < transforms.size(); ++i) {
+			const auto& trs = transforms[i];
+			out[i] = glm::translate(glm::mat4(1.f), trs.translation)
+				* glm::mat4_cast(trs.rotation)
+				* glm::scale(glm::mat4(1.f), trs.scale);
+		}
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	set_counters(state);
+}
+
+void BM_ComposeTrsBatch(benchmark::State& state, ENG::SimdLevel level)
+{
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		state.SkipWithError("SIMD level not supported on this CPU");
+		return;
+	}
+
+	const auto transforms = random_transforms(state.range(0));
+	std::vector<glm::mat4> out(transforms.size());
+	for (auto _ : state) {
+		ENG::compose_trs_batch(transforms.data(), out.data(), transforms.size(), level);
+		benchmark::DoNotOptimize(out.data());
+		benchmark::ClobberMemory();
+	}
+	set_counters(state);
+}
+
+} // end namespace
+
+BENCHMARK(BM_ComposeTrsGlm)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_ComposeTrsBatch, Scalar, ENG::SimdLevel::Scalar)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_ComposeTrsBatch, SSE41, ENG::SimdLevel::SSE41)->RangeMultiplier(10)->Range(1000, 100000);
+BENCHMARK_CAPTURE(BM_ComposeTrsBatch, AVX2, ENG::SimdLevel::AVX2)->RangeMultiplier(10)->Range(1000, 100000);
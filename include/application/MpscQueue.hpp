@@ -0,0 +1,171 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <utility>
+
+// Lock-free queue for any number of producer threads and a single consumer thread.
+// Producers push nodes onto a shared stack with one CAS. The consumer takes the whole
+// stack with a single exchange, reverses it into a private FIFO list and pops from that,
+// so draining a burst of items costs one atomic operation instead of a lock per item.
+//
+// With a capacity, push blocks while the queue holds capacity items and try_push fails
+// instead. A capacity of zero leaves the queue unbounded and skips the size counter.
+// The consumer must not push into a bounded queue it drains, it would wait on itself.
+template<typename T>
+class MpscQueue
+{
+public:
+	explicit MpscQueue(size_t capacity = 0) : m_capacity(capacity) {}
+
+	~MpscQueue()
+	{
+		free_list(m_head.load(std::memory_order_acquire));
+		free_list(m_cache);
+	}
+
+	MpscQueue(const MpscQueue&) = delete;
+	MpscQueue& operator=(const MpscQueue&) = delete;
+
+	size_t capacity() const { return m_capacity; }
+
+	// Any thread. Blocks while a bounded queue is full.
+	void push(T item)
+	{
+		while (!reserve_slot())
+		{
+			const auto size = m_size.load(std::memory_order_relaxed);
+			if (size >= m_capacity)
+			{
+				m_size.wait(size, std::memory_order_relaxed);
+			}
+		}
+		link(new Node{ std::move(item), nullptr });
+	}
+
+	// Any thread. Returns false and leaves item untouched if a bounded queue is full.
+	bool try_push(T&& item)
+	{
+		if (!reserve_slot()) return false;
+		link(new Node{ std::move(item), nullptr });
+		return true;
+	}
+
+	// Consumer thread only
+	std::optional<T> try_pop()
+	{
+		if (m_cache == nullptr && !refill()) return std::nullopt;
+
+		Node* node = m_cache;
+		m_cache = node->next;
+		std::optional<T> item{ std::move(node->value) };
+		delete node;
+		release_slots(1);
+		return item;
+	}
+
+	// Consumer thread only. Moves up to out.size() items into out, oldest first, and returns
+	// how many were written. Everything pushed before the call is taken with at most one
+	// exchange; items that do not fit stay queued for the next call.
+	size_t drain_into(std::span<T> out)
+	{
+		size_t count = 0;
+		bool refilled = false;
+		while (count < out.size())
+		{
+			if (m_cache == nullptr)
+			{
+				if (refilled || !refill()) break;
+				refilled = true;
+			}
+			Node* node = m_cache;
+			m_cache = node->next;
+			out[count++] = std::move(node->value);
+			delete node;
+		}
+		release_slots(count);
+		return count;
+	}
+
+	// Consumer thread only
+	bool empty() const
+	{
+		return m_cache == nullptr && m_head.load(std::memory_order_acquire) == nullptr;
+	}
+
+private:
+	struct Node {
+		T value;
+		Node* next;
+	};
+
+	// Newest first, shared with producers
+	alignas(64) std::atomic<Node*> m_head{ nullptr };
+	// Items reserved by producers and not yet taken by the consumer, bounded queues only
+	alignas(64) std::atomic<size_t> m_size{ 0 };
+	// Oldest first, owned by the consumer
+	alignas(64) Node* m_cache{ nullptr };
+	const size_t m_capacity;
+
+	bool reserve_slot()
+	{
+		if (m_capacity == 0) return true;
+
+		auto size = m_size.load(std::memory_order_relaxed);
+		do
+		{
+			if (size >= m_capacity) return false;
+		} while (!m_size.compare_exchange_weak(size, size + 1, std::memory_order_relaxed));
+		return true;
+	}
+
+	void release_slots(size_t count)
+	{
+		if (m_capacity == 0 || count == 0) return;
+
+		// Producers only wait on a full queue, so below capacity there is nobody to wake
+		const auto previous = m_size.fetch_sub(count, std::memory_order_relaxed);
+		if (previous >= m_capacity)
+		{
+			m_size.notify_all();
+		}
+	}
+
+	void link(Node* node)
+	{
+		node->next = m_head.load(std::memory_order_relaxed);
+		while (!m_head.compare_exchange_weak(node->next, node,
+			std::memory_order_release, std::memory_order_relaxed))
+		{
+		}
+	}
+
+	// Moves everything producers pushed so far into the consumer's list
+	bool refill()
+	{
+		Node* stack = m_head.exchange(nullptr, std::memory_order_acquire);
+		if (stack == nullptr) return false;
+
+		Node* reversed = nullptr;
+		while (stack != nullptr)
+		{
+			Node* next = stack->next;
+			stack->next = reversed;
+			reversed = stack;
+			stack = next;
+		}
+		m_cache = reversed;
+		return true;
+	}
+
+	static void free_list(Node* node)
+	{
+		while (node != nullptr)
+		{
+			Node* next = node->next;
+			delete node;
+			node = next;
+		}
+	}
+};
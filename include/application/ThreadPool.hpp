@@ -0,0 +1,143 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Fixed set of worker threads for fork-join data parallel work on the frame.
+// The calling thread takes part in every parallel_for, so a pool with zero workers
+// simply runs the loop inline.
+class ThreadPool
+{
+public:
+	explicit ThreadPool(size_t workerCount = default_worker_count())
+	{
+		m_workers.reserve(workerCount);
+		for (size_t i = 0; i < workerCount; ++i)
+		{
+			m_workers.emplace_back([this] { worker_loop(); });
+		}
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_cv.notify_all();
+		for (auto& worker : m_workers)
+		{
+			worker.join();
+		}
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	// Leaves one hardware thread for the caller
+	static size_t default_worker_count()
+	{
+		const auto hardwareThreads = std::thread::hardware_concurrency();
+		return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	size_t worker_count() const { return m_workers.size(); }
+
+	// Runs fn(i) for every i in [0, count) and blocks until all calls returned.
+	// Indices are claimed dynamically, so fn must only write state owned by index i.
+	// The first exception thrown by fn is rethrown on the calling thread.
+	void parallel_for(size_t count, const std::function<void(size_t)>& fn)
+	{
+		if (count == 0) return;
+
+		std::lock_guard<std::mutex> submitLock(m_submitMutex);
+		if (m_workers.empty() || count == 1)
+		{
+			for (size_t i = 0; i < count; ++i) fn(i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_job = &fn;
+			m_jobCount = count;
+			m_next.store(0, std::memory_order_relaxed);
+			m_activeWorkers = m_workers.size();
+			m_error = nullptr;
+			++m_generation;
+		}
+		m_cv.notify_all();
+
+		run_tasks(fn, count);
+
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_doneCv.wait(lock, [this] { return m_activeWorkers == 0; });
+		m_job = nullptr;
+		if (m_error)
+		{
+			std::rethrow_exception(std::exchange(m_error, nullptr));
+		}
+	}
+
+private:
+	std::vector<std::thread> m_workers;
+	std::mutex m_submitMutex;
+	std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::condition_variable m_doneCv;
+	const std::function<void(size_t)>* m_job{ nullptr };
+	size_t m_jobCount{ 0 };
+	std::atomic<size_t> m_next{ 0 };
+	size_t m_activeWorkers{ 0 };
+	uint64_t m_generation{ 0 };
+	std::exception_ptr m_error;
+	bool m_stop{ false };
+
+	void run_tasks(const std::function<void(size_t)>& fn, size_t count)
+	{
+		for (size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < count;
+			i = m_next.fetch_add(1, std::memory_order_relaxed))
+		{
+			try
+			{
+				fn(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (!m_error) m_error = std::current_exception();
+			}
+		}
+	}
+
+	void worker_loop()
+	{
+		uint64_t seenGeneration = 0;
+		while (true)
+		{
+			const std::function<void(size_t)>* job = nullptr;
+			size_t count = 0;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_cv.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+				if (m_stop) return;
+				seenGeneration = m_generation;
+				job = m_job;
+				count = m_jobCount;
+			}
+
+			run_tasks(*job, count);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				if (--m_activeWorkers == 0) m_doneCv.notify_one();
+			}
+		}
+	}
+};
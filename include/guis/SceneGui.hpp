@@ -4,6 +4,7 @@
 
 namespace ENG {
 	class Node;
+	class SceneGraph;
 	class SceneState;
 }
 
@@ -24,6 +25,6 @@ class SceneGui
 public:
 	GUISettings settings;
 	void MySaveFunction();
-	void DrawNodeTree(ENG::Node* node);
+	void DrawNodeTree(ENG::SceneState& sceneState, ENG::Node* node);
 	void drawGui(ENG::SceneState& sceneState);
 };
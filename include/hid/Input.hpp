@@ -20,6 +20,7 @@ struct WindowUserData {
 	int windowHeightScreenCoords{ 0 };
 	std::deque<ClientHidEvent> eventQueue;
 	bool windowResized{ false };
+	bool selectRequested{ false };  // left click not yet handled by the scene
 };
 
 struct InputController {
@@ -27,7 +27,7 @@ public:
 
 	static void createLogicalDevice(const VkSurfaceKHR &surface, const VkPhysicalDevice &physicalDevice,
 				 const std::vector<const char*> &validationLayers,
-				 VkQueue &graphicsQueue, VkQueue &presentQueue, VkDevice &device);
+				 VkQueue &graphicsQueue, VkQueue &presentQueue, VkQueue &transferQueue, VkDevice &device);
 };
 }
 #endif
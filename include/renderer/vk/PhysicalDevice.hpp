@@ -28,8 +28,12 @@ struct SwapChainSupportDetails {
 struct QueueFamilyIndices {
 	std::optional<uint32_t> graphicsFamily;
 	std::optional<uint32_t> presentFamily;
+	// Transfer capable family without graphics, if the device has one and ENG_USE_TRANSFER_QUEUE is on
+	std::optional<uint32_t> transferFamily;
 
 	bool isComplete();
+	// Family uploads are submitted to, the graphics family when there is no dedicated one
+	uint32_t uploadFamily();
 };
 
 class PhysicalDevice {
@@ -17,6 +17,7 @@
 #include "renderer/vk/Buffer.hpp"
 #include "renderer/vk/Command.hpp"
 #include "renderer/vk/Swapchain.hpp"
+#include "renderer/vk/UploadBatcher.hpp"
 #include "scene/Scene.hpp"
 
 
@@ -86,17 +87,23 @@ public:
 	VkDevice device;
 	VkQueue graphicsQueue;
 	VkQueue presentQueue;
+	VkQueue transferQueue;  // the graphics queue when the device has no dedicated transfer family
 	VkSurfaceKHR surface;
 	VkRenderPass renderPass;
 	std::vector<VkSemaphore> imageAvailableSemaphores;
 	std::vector<VkSemaphore> renderFinishedSemaphores;
 	std::vector<VkFence> inFlightFences;
 	uint32_t currentFrame = 0;
+	// Number of frames submitted to the graphics queue, used to retire per-frame resources
+	uint64_t submittedFrameCount = 0;
 	bool& framebufferResized;
 	std::vector<ENG::Buffer> uniformBuffers;
 	std::vector<void*> uniformBuffersMapped;
 	std::vector<ENG::Buffer> modelMatrixBuffers;
 	std::vector<void*> modelMatrixBuffersMapped;
+	// Model matrix ranges not yet copied into each frame-in-flight buffer
+	std::vector<std::vector<ENG::MatrixRange>> pendingModelMatrixRanges;
+	std::vector<ENG::MatrixRange> changedModelMatrixRanges;
 	VkDescriptorPool descriptorPool;
 	VkDescriptorPool imguiPool;
 	Pool<VkDescriptorSet> descriptorSets{ 10 };
@@ -109,6 +116,7 @@ public:
 	std::unique_ptr<ENG::InstanceFactory> instanceFactory;
 	std::unique_ptr<ENG::PipelineFactory> pipelineFactory;
 	std::unique_ptr<ENG::Command> commands;
+	std::unique_ptr<ENG::UploadBatcher> uploads;  // texture and buffer uploads, submitted once per frame
 	std::unique_ptr<ENG::Swapchain> swapchain;
 	std::vector<std::function<void(VkCommandBuffer)>> commandRecorders;
 	std::vector<std::function<void(void)>> initializationFunctions;
@@ -116,7 +124,7 @@ public:
 	std::vector<std::function<void(void)>> renderStateUpdaters;
 	std::function<UniformBufferObject(void)> uniformBufferProducer;
 	std::vector<std::function<void(const UniformBufferObject&)>> uniformBufferConsumers;
-	std::function<std::vector<glm::mat4>&(void)> modelMatrixBufferUpdateFunction;
+	std::function<const std::vector<glm::mat4>&(std::vector<ENG::MatrixRange>&)> modelMatrixBufferUpdateFunction;
 
 	std::mutex scene_mtx;
 	bool sceneReadyToRender = false;
@@ -145,9 +153,9 @@ public:
 	void registerUniformBufferConsumer(std::function<void(const UniformBufferObject&)> consumer);
 	void notifyUboConsumers(const UniformBufferObject& ubo);
 
-	void registerModelMatrixBufferUpdateFunction(std::function<std::vector<glm::mat4>&(void)> bufferUpdater);
+	void registerModelMatrixBufferUpdateFunction(std::function<const std::vector<glm::mat4>&(std::vector<ENG::MatrixRange>&)> bufferUpdater);
 
-	void copyModelMatrixBufferToGpu(const std::vector<glm::mat4>& modelMatrices);
+	void copyModelMatrixBufferToGpu(const std::vector<glm::mat4>& modelMatrices, const std::vector<ENG::MatrixRange>& changedRanges);
 	void copyUniformBufferToGpu(const uint32_t currentImage, const UniformBufferObject& ubo);
 
 	void createDescriptorPool();
@@ -205,6 +213,7 @@ public:
 
 	void createDescriptorSets(
 		std::vector<VkDescriptorSet>& descriptorSetsP, const std::string& shaderId, const std::optional<std::filesystem::path> texturePath);
+	void freeDescriptorSets(const std::vector<VkDescriptorSet>& descriptorSetsP);
 
 	void createTextureImage(const std::filesystem::path& fpath);
 	void createTextureImageView(const std::filesystem::path& fpath);
@@ -0,0 +1,117 @@
+#ifndef ENG_UPLOAD_BATCHER
+#define ENG_UPLOAD_BATCHER
+#include "vulkan/vulkan_core.h"
+#include<cstdint>
+#include<deque>
+#include<functional>
+#include<vector>
+
+namespace ENG
+{
+
+class UploadBatcher {
+	/*
+	 * Collects the copies and layout transitions issued between two submit() calls into one
+	 * command buffer, and submits it once instead of stalling the queue per upload.
+	 * Completion callbacks registered in the meantime run from poll() once the batch has
+	 * executed and its resources are ready for graphics submissions made after that.
+	 *
+	 * Batches are submitted to the upload queue, which is a dedicated transfer queue when the
+	 * device has one, so streaming does not occupy the graphics queue. Each batch signals a
+	 * timeline semaphore with its serial. Resources written by a batch are handed to the
+	 * graphics queue family through release_buffer() and release_image(): the release barriers
+	 * close the batch, and the matching acquire barriers are submitted to the graphics queue
+	 * when poll() sees the batch complete, so frames never wait on the GPU for uploads.
+	 * Without a dedicated queue family both queues are the graphics queue and the releases
+	 * are plain barriers.
+	 *
+	 * Serials increase with every submission, so other resources (the staging ring, released
+	 * draw data) can be tagged with the batch using them and freed once completed_serial()
+	 * passes it.
+	 *
+	 * Must be used from the main thread.
+	 */
+public:
+	UploadBatcher(VkDevice device, uint32_t uploadFamily, VkQueue uploadQueue, uint32_t graphicsFamily, VkQueue graphicsQueue);
+	~UploadBatcher();
+	UploadBatcher(const UploadBatcher&) = delete;
+	UploadBatcher& operator=(const UploadBatcher&) = delete;
+
+	// Command buffer of the open batch, begun on first use. Runs on the upload queue, which
+	// may only support transfer commands.
+	VkCommandBuffer command_buffer();
+
+	// Makes transfer writes to [offset, offset + size) of buffer visible to later graphics
+	// work at dstStage/dstAccess
+	void release_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+		VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+	// Same for a color image, transitioning it from oldLayout to newLayout
+	void release_image(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+		VkPipelineStageFlags dstStage, VkAccessFlags dstAccess);
+
+	// Runs callback once everything recorded up to the next submit() is ready for use
+	void on_complete(std::function<void(void)> callback);
+
+	bool has_pending() const { return openCommandBuffer != VK_NULL_HANDLE; }
+	bool dedicated_queue() const { return uploadFamily != graphicsFamily; }
+
+	// Serial the open batch is submitted with
+	uint64_t open_serial() const { return lastSubmittedSerial + 1; }
+
+	// Every command of the batches up to this serial, including their acquires, has executed
+	uint64_t completed_serial() const;
+
+	// Ends and submits the open batch, if any. Returns its serial, or the last submitted one.
+	uint64_t submit();
+
+	// Retires executed batches oldest first: submits their acquires and runs their callbacks
+	void poll();
+
+	// Blocks until completed_serial() has reached serial, retiring batches on the way
+	void wait(uint64_t serial);
+
+private:
+	struct Batch {
+		uint64_t serial{ 0 };
+		VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+		VkPipelineStageFlags acquireStages{ 0 };
+		std::vector<VkBufferMemoryBarrier> bufferAcquires;
+		std::vector<VkImageMemoryBarrier> imageAcquires;
+		std::vector<std::function<void(void)>> callbacks;
+	};
+
+	// Acquire barriers submitted to the graphics queue, freed once acquireTimeline passes serial
+	struct PendingAcquire {
+		uint64_t serial{ 0 };
+		VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+	};
+
+	VkDevice device;
+	uint32_t uploadFamily;
+	uint32_t graphicsFamily;
+	VkQueue uploadQueue;
+	VkQueue graphicsQueue;
+	VkCommandPool uploadPool{ VK_NULL_HANDLE };
+	VkCommandPool acquirePool{ VK_NULL_HANDLE };
+	VkSemaphore uploadTimeline{ VK_NULL_HANDLE };
+	VkSemaphore acquireTimeline{ VK_NULL_HANDLE };
+
+	// Open batch
+	VkCommandBuffer openCommandBuffer{ VK_NULL_HANDLE };
+	VkPipelineStageFlags releaseStages{ 0 };
+	std::vector<VkBufferMemoryBarrier> bufferReleases;
+	std::vector<VkImageMemoryBarrier> imageReleases;
+	Batch openBatch;
+
+	std::deque<Batch> inFlight;
+	std::deque<PendingAcquire> pendingAcquires;
+	uint64_t lastSubmittedSerial{ 0 };
+	uint64_t lastRetiredSerial{ 0 };
+
+	void retire_oldest();
+	void submit_acquire(Batch& batch);
+	void free_acquires(uint64_t acquiredSerial);
+};
+}
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+#include <cstdint>
+#include <map>
+#include <optional>
+
+class FreeList
+{
+	/*
+	 * Sub-allocates ranges of [0, capacity) in caller defined units, e.g. vertices or indices
+	 * of a shared buffer. Picks the smallest free range that fits, and merges neighbouring
+	 * free ranges when a range is freed, so fragmentation stays bounded by the live ranges.
+	 *
+	 * Only tracks offsets, owns no memory.
+	 */
+public:
+	explicit FreeList(uint32_t capacity);
+
+	uint32_t capacity() const { return listCapacity; }
+	uint32_t free_count() const { return freeCount; }
+
+	// Offset of count free units, a multiple of alignment, or nullopt if no free range can
+	// hold them. Units skipped to align the offset stay free.
+	std::optional<uint32_t> allocate(uint32_t count, uint32_t alignment = 1);
+
+	// Returns a range handed out by allocate
+	void free(uint32_t offset, uint32_t count);
+
+private:
+	uint32_t listCapacity;
+	uint32_t freeCount;
+	std::map<uint32_t, uint32_t> freeByOffset;      // offset -> count
+	std::multimap<uint32_t, uint32_t> freeBySize;   // count -> offset
+
+	void insert_free(uint32_t offset, uint32_t count);
+	void erase_free(std::map<uint32_t, uint32_t>::iterator range);
+};
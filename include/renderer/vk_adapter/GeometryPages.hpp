@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "renderer/vk_adapter/FreeList.hpp"
+
+// Vertex and index ranges of one mesh inside a GeometryPool page. Offsets are in vertices
+// and indices, ready for vkCmdDrawIndexed's vertexOffset and firstIndex.
+struct GeometryAllocation {
+	uint32_t format{ 0 };       // vertex layout, the index of the mesh's ENG::VertexT alternative
+	uint32_t page{ 0 };
+	uint32_t firstVertex{ 0 };
+	uint32_t vertexCount{ 0 };
+	uint32_t firstIndex{ 0 };
+	uint32_t indexCount{ 0 };
+};
+
+class GeometryPages
+{
+	/*
+	 * The bookkeeping of a GeometryPool: which pages each vertex layout has, how many
+	 * vertices and indices they hold and which ranges are free. Owns no buffers, the pool
+	 * creates them for pages added here.
+	 *
+	 * A page holds pageSize bytes of vertices and as much of indices. When no page of a
+	 * layout fits a mesh a new one is added, sized up for meshes larger than a page.
+	 */
+public:
+	explicit GeometryPages(uint64_t pageSize);
+
+	// Ranges in the first page of format that fits them, adding a page if none does
+	GeometryAllocation allocate(uint32_t format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount);
+	void free(const GeometryAllocation& allocation);
+
+	size_t page_count(uint32_t format) const;
+	uint32_t vertex_stride(uint32_t format) const { return formats[format].vertexStride; }
+	uint32_t vertex_capacity(uint32_t format, uint32_t page) const { return formats[format].pages[page].vertices.capacity(); }
+	uint32_t index_capacity(uint32_t format, uint32_t page) const { return formats[format].pages[page].indices.capacity(); }
+
+private:
+	struct Page {
+		FreeList vertices;
+		FreeList indices;
+	};
+
+	struct Format {
+		uint32_t vertexStride{ 0 };
+		std::vector<Page> pages;
+	};
+
+	uint64_t pageSize;
+	std::vector<Format> formats;
+
+	static bool allocate_in_page(Page& page, uint32_t vertexCount, uint32_t indexCount, GeometryAllocation& allocation);
+};
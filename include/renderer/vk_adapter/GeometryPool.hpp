@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "vulkan/vulkan_core.h"
+#include "vk_mem_alloc.h"
+#include "renderer/vk_adapter/GeometryPages.hpp"
+
+class GeometryPool
+{
+	/*
+	 * Shared vertex and index buffers, one set per vertex layout, that meshes are
+	 * sub-allocated from instead of creating a buffer pair each. Consecutive draws from
+	 * the same page bind the same buffers.
+	 *
+	 * Each layout's storage is a list of pages, see GeometryPages for how ranges and pages
+	 * are handed out. Pages are never resized, so buffer handles stay valid while draws
+	 * reference them.
+	 *
+	 * Freed ranges may still be read by frames in flight, callers free them only once those
+	 * have retired. Must be used from the main thread.
+	 */
+public:
+	GeometryPool(VmaAllocator allocator, VkDeviceSize pageSize);
+	~GeometryPool();
+	GeometryPool(const GeometryPool&) = delete;
+	GeometryPool& operator=(const GeometryPool&) = delete;
+
+	// Throws if a page cannot be created
+	GeometryAllocation allocate(uint32_t format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount);
+	void free(const GeometryAllocation& allocation);
+
+	VkBuffer vertex_buffer(const GeometryAllocation& allocation) const;
+	// Only for allocations with indices, pages get an index buffer with the first of them
+	VkBuffer index_buffer(const GeometryAllocation& allocation) const;
+
+	// Byte offsets of the allocation's ranges, for uploads
+	VkDeviceSize vertex_byte_offset(const GeometryAllocation& allocation) const;
+	VkDeviceSize index_byte_offset(const GeometryAllocation& allocation) const;
+
+	size_t page_count() const;
+
+private:
+	struct PageBuffers {
+		VkBuffer vertexBuffer{ VK_NULL_HANDLE };
+		VmaAllocation vertexAllocation{ VK_NULL_HANDLE };
+		VkBuffer indexBuffer{ VK_NULL_HANDLE };
+		VmaAllocation indexAllocation{ VK_NULL_HANDLE };
+	};
+
+	VmaAllocator allocator;
+	GeometryPages pages;
+	std::vector<std::vector<PageBuffers>> buffers;  // by format, then page
+
+	// Creates the vertex buffers of pages added to the allocation's format since the last
+	// call, and the index buffer of the allocation's page if it has indices
+	void create_page_buffers(const GeometryAllocation& allocation);
+};
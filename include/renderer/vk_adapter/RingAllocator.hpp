@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+class RingAllocator
+{
+	/*
+	 * Offsets of a ring of capacity bytes, the bookkeeping of a StagingRing. Owns no memory.
+	 *
+	 * Allocations are handed out front to back and wrap around. They form the open batch
+	 * until close_batch(), which tags them with the serial of the upload batch that reads
+	 * them (see ENG::UploadBatcher). Space is reclaimed oldest batch first once that serial
+	 * has completed. When allocate() fails the caller submits the open batch or waits for
+	 * oldest_serial(), reclaims, and retries.
+	 */
+public:
+	explicit RingAllocator(uint64_t capacity) : ringCapacity(capacity) {}
+
+	uint64_t capacity() const { return ringCapacity; }
+
+	// Offset of size free bytes, a multiple of alignment, or nullopt if they do not fit
+	// until older batches are reclaimed, or ever for sizes above capacity()
+	std::optional<uint64_t> allocate(uint64_t size, uint64_t alignment);
+
+	// Ends the open batch, which is read by the upload batch with this serial.
+	// Does nothing if nothing was allocated since the last call.
+	void close_batch(uint64_t serial);
+
+	// Frees the space of every batch whose serial is at most completedSerial
+	void reclaim(uint64_t completedSerial);
+
+	bool has_open_batch() const { return openBatch; }
+
+	// Serial of the oldest batch still holding space, if any
+	std::optional<uint64_t> oldest_serial() const;
+
+private:
+	struct Batch {
+		uint64_t serial{ 0 };
+		uint64_t end{ 0 };  // head of the ring when the batch was closed
+	};
+
+	uint64_t ringCapacity;
+
+	// Bytes in use are [tail, head), wrapping around the end
+	uint64_t head{ 0 };
+	uint64_t tail{ 0 };
+	bool inUse{ false };
+	bool openBatch{ false };
+	std::deque<Batch> batches;
+
+	std::optional<uint64_t> find_space(uint64_t size, uint64_t alignment) const;
+};
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "vulkan/vulkan_core.h"
+#include "vk_mem_alloc.h"
+#include "renderer/vk_adapter/RingAllocator.hpp"
+
+// Slice of the staging ring, written by the CPU and read by a transfer command
+struct StagingRegion {
+	VkBuffer buffer{ VK_NULL_HANDLE };
+	VkDeviceSize offset{ 0 };
+	VkDeviceSize size{ 0 };
+	std::byte* data{ nullptr };  // persistently mapped
+};
+
+class StagingRing
+{
+	/*
+	 * One persistently mapped, host visible buffer that all uploads sub-allocate from,
+	 * instead of creating, mapping and destroying a staging buffer per upload.
+	 *
+	 * Space is handed out and reclaimed per upload batch by a RingAllocator, see there.
+	 *
+	 * Must be used from the main thread.
+	 */
+public:
+	StagingRing(VmaAllocator allocator, VkDeviceSize capacity);
+	~StagingRing();
+	StagingRing(const StagingRing&) = delete;
+	StagingRing& operator=(const StagingRing&) = delete;
+
+	VkDeviceSize capacity() const { return ring.capacity(); }
+
+	// Uploads larger than this are streamed through the ring in chunks of this size
+	VkDeviceSize max_chunk() const { return ring.capacity() / 4; }
+
+	std::optional<StagingRegion> allocate(VkDeviceSize size, VkDeviceSize alignment = 16);
+
+	// Makes CPU writes to the region visible to the device, on memory that is not coherent
+	void flush(const StagingRegion& region);
+
+	// See RingAllocator
+	void close_batch(uint64_t serial) { ring.close_batch(serial); }
+	void reclaim(uint64_t completedSerial) { ring.reclaim(completedSerial); }
+	bool has_open_batch() const { return ring.has_open_batch(); }
+	std::optional<uint64_t> oldest_serial() const { return ring.oldest_serial(); }
+
+private:
+	VmaAllocator allocator;
+	RingAllocator ring;
+	VkBuffer buffer{ VK_NULL_HANDLE };
+	VmaAllocation allocation{ VK_NULL_HANDLE };
+	std::byte* mapped{ nullptr };
+};
@@ -3,7 +3,10 @@
 #include "scene/Scene.hpp"
 #include "renderer/vk/Renderer.hpp"
 #include "renderer/RendererI.hpp"
-#include "application/ConcurrentQueue.hpp"
+#include "renderer/vk_adapter/StagingRing.hpp"
+#include "renderer/vk_adapter/GeometryPool.hpp"
+#include "application/MpscQueue.hpp"
+#include <deque>
 
 
 enum DrawDataProperties : uint32_t {
@@ -14,17 +17,8 @@ enum DrawDataProperties : uint32_t {
 	INDEXED_DRAW = 0x8,
 };
 
-struct DrawDataAllocationInfo {
-	VkBuffer vertexBuffers[1];
-	VkDeviceSize vertexBufferOffsets[1]{ 0 };
-	VmaAllocation vertexAllocation;
-	VmaAllocationInfo vertexAllocationInfo;
-	VkBuffer indexBuffer;
-	VmaAllocation indexAllocation;
-	VmaAllocationInfo indexAllocationInfo;
-	uint32_t indexCount;
-    uint32_t vertexCount;
-};
+// Ranges of the draw data's mesh in the adapter's GeometryPool
+using DrawDataAllocationInfo = GeometryAllocation;
 
 struct alignas(CACHE_LINE_SIZE) DrawData
 {
@@ -33,8 +27,26 @@ struct alignas(CACHE_LINE_SIZE) DrawData
 	std::optional<std::filesystem::path> texturePath;
 	std::optional<std::vector<VkDescriptorSet>> descriptorSets;
 	std::optional<DrawDataAllocationInfo> bufferAllocationInfo;
+	ENG::MeshBounds localBounds;
+};
+
+
+// GPU resources of released draw data, kept alive until the frames and the upload batch
+// that may still reference them have finished executing
+struct RetiredDrawData
+{
+	uint64_t retireAtFrame{ 0 };
+	uint64_t retireAtUpload{ 0 };  // upload batch serial, see ENG::UploadBatcher
+	std::optional<std::vector<VkDescriptorSet>> descriptorSets;
+	std::optional<DrawDataAllocationInfo> bufferAllocationInfo;
 };
 
+// Copy out of the staging ring into a geometry pool buffer, recorded by VkAdapter::submitUploads
+struct StagedCopy {
+	VkBuffer srcBuffer;
+	VkBuffer dstBuffer;
+	VkBufferCopy region;
+};
 
 struct CommandRecorderEvent {
 	std::function<void(VkCommandBuffer)> commandRecorder;
@@ -60,8 +72,15 @@ public:
 	VkRenderer& renderer;
 	VmaAllocator vmaAllocator;
 	std::vector<DrawData> drawDataBuffer;
+	std::vector<size_t> freeDrawDataSlots;
+	std::deque<RetiredDrawData> retiredDrawData;
+	std::optional<StagingRing> stagingRing;
+	std::optional<GeometryPool> geometry;
+	std::vector<StagedCopy> stagedCopies;  // written to the ring, not submitted yet
 
-	ConcurrentQueue<GraphicsEvent> graphicsEventQueue{};
+	// Pushed by loader threads, drained by the main thread. Unbounded, the main thread queues
+	// completion events into it while draining.
+	MpscQueue<GraphicsEvent> graphicsEventQueue{};
 
 	VkAdapter(VkRenderer& renderer) : renderer(renderer)
 	{
@@ -79,8 +98,8 @@ public:
 		allocatorCreateInfo.pVulkanFunctions = &vulkanFunctions;
 
 		vmaCreateAllocator(&allocatorCreateInfo, &vmaAllocator);
-
-
+		stagingRing.emplace(vmaAllocator, STAGING_RING_SIZE);
+		geometry.emplace(vmaAllocator, GEOMETRY_PAGE_SIZE);
 	}
 
 	bool has_property(const size_t drawDataIdx, const DrawDataProperties propertyEnum)
@@ -101,140 +120,54 @@ public:
 
 	~VkAdapter()
 	{
-		for (auto& drawData : drawDataBuffer)
-		{
-			if (drawData.bufferAllocationInfo.has_value())
-			{
-				vmaDestroyBuffer(
-					vmaAllocator,
-					drawData.bufferAllocationInfo.value().vertexBuffers[0],
-					drawData.bufferAllocationInfo.value().vertexAllocation);
-				vmaDestroyBuffer(
-					vmaAllocator,
-					drawData.bufferAllocationInfo.value().indexBuffer,
-					drawData.bufferAllocationInfo.value().indexAllocation);
-			}
-		}
+		// Draw data only holds ranges, the pool owns every vertex and index buffer
+		geometry.reset();
+		stagingRing.reset();
 		vmaDestroyAllocator(vmaAllocator);
 	}
 
+	void destroyDrawDataBuffers(const DrawDataAllocationInfo& allocationInfo)
+	{
+		geometry->free(allocationInfo);
+	}
+
 	void copyBuffer(VkCommandBuffer cmd, VkBuffer src, VkBuffer dst, VkDeviceSize size) {
 		VkBufferCopy region{};
 		region.size = size;
 		vkCmdCopyBuffer(cmd, src, dst, 1, &region);
 	}
 
+	/*
+	* Sub-allocates the mesh from the geometry pool of its vertex layout and stages its upload.
+	* Must be called from main thread.
+	*/
 	DrawDataAllocationInfo create_draw_data(
 		VertexT&& vertices, 
 		std::vector<uint32_t>&& indices)
 	{
-		DrawDataAllocationInfo drawDataInfo{};
-		drawDataInfo.indexCount = static_cast<uint32_t>(indices.size());
-        
-        
-        auto vertexSize{0};
-        if (std::holds_alternative<std::vector<VertexPosColTex>>(vertices)) {
-            drawDataInfo.vertexCount = static_cast<uint32_t>(std::get<std::vector<VertexPosColTex>>(vertices).size());
-            vertexSize = drawDataInfo.vertexCount * sizeof(VertexPosColTex);
-        } else if (std::holds_alternative<std::vector<VertexPosNorCol>>(vertices)) {
-            drawDataInfo.vertexCount = static_cast<uint32_t>(std::get<std::vector<VertexPosNorCol>>(vertices).size());
-            vertexSize = drawDataInfo.vertexCount * sizeof(VertexPosNorCol);
-        } else if (std::holds_alternative<std::vector<VertexPosNorTex>>(vertices)) {
-            drawDataInfo.vertexCount = static_cast<uint32_t>(std::get<std::vector<VertexPosNorTex>>(vertices).size());
-            vertexSize = drawDataInfo.vertexCount * sizeof(VertexPosNorTex);
-        } else {
-            drawDataInfo.vertexCount = 0;
-            vertexSize = 0;
-        }
-
-
-		const auto* vertexData =
-			std::holds_alternative<std::vector<VertexPosColTex>>(vertices) ? static_cast<void*>(std::get<std::vector<VertexPosColTex>>(vertices).data()) :
-			std::holds_alternative<std::vector<VertexPosNorCol>>(vertices) ? static_cast<void*>(std::get<std::vector<VertexPosNorCol>>(vertices).data()) :
-			std::holds_alternative<std::vector<VertexPosNorTex>>(vertices) ? static_cast<void*>(std::get<std::vector<VertexPosNorTex>>(vertices).data()) :
-			nullptr;
-
-		if (!vertexData)
-		{
-			ENG_LOG_ERROR("Vertex data is null!" << std::endl);
-			return {};
-		}
-
-		VkDeviceSize indexSize = sizeof(uint32_t) * indices.size(); 
-
-		ENG_LOG_DEBUG("Binding vertex and index buffers of size: (" << vertexSize << "," << indexSize << ")" << std::endl);
-		
-		VkBufferCreateInfo vbInfo{}; 
-		vbInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO; 
-		vbInfo.size = vertexSize; 
-		vbInfo.usage = VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT; 
-
-		VkBufferCreateInfo ibInfo{}; 
-		ibInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO; 
-		ibInfo.size = indexSize; 
-		ibInfo.usage = VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT; 
-
-		VmaAllocationCreateInfo gpuAlloc{}; 
-		gpuAlloc.usage = VMA_MEMORY_USAGE_GPU_ONLY; 
-
-		vmaCreateBuffer(vmaAllocator, &vbInfo, &gpuAlloc, &drawDataInfo.vertexBuffers[0], &drawDataInfo.vertexAllocation, &drawDataInfo.vertexAllocationInfo);
-		vmaCreateBuffer(vmaAllocator, &ibInfo, &gpuAlloc, &drawDataInfo.indexBuffer, &drawDataInfo.indexAllocation, &drawDataInfo.indexAllocationInfo);
-
-		// copy vertex data to device staging buffer
-		// Staging buffer creation info
-		VmaAllocationCreateInfo stagingAlloc{};
-		stagingAlloc.usage = VMA_MEMORY_USAGE_CPU_TO_GPU;
-
-		VkBuffer stagingVB;
-		VmaAllocation stagingVBAlloc;
-
-		VkBufferCreateInfo stagingInfoVB = vbInfo;
-		stagingInfoVB.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-		vmaCreateBuffer(vmaAllocator, &stagingInfoVB, &stagingAlloc,
-			&stagingVB, &stagingVBAlloc, nullptr);
-
-		// Map + copy vertex data
-		void* data;
-		vmaMapMemory(vmaAllocator, stagingVBAlloc, &data);
-		memcpy(data, vertexData, vertexSize);
-		vmaUnmapMemory(vmaAllocator, stagingVBAlloc);
-
-		// copy index data over to staging buffer
-		VkBuffer stagingIB;
-		VmaAllocation stagingIBAlloc;
-
-		VkBufferCreateInfo stagingInfoIB = ibInfo;
-		stagingInfoIB.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
-
-		vmaCreateBuffer(vmaAllocator, &stagingInfoIB, &stagingAlloc,
-						&stagingIB, &stagingIBAlloc, nullptr);
+		const auto format = static_cast<uint32_t>(vertices.index());
+		return std::visit([&](const auto& vertexData) -> DrawDataAllocationInfo {
+			using Vertex = typename std::decay_t<decltype(vertexData)>::value_type;
+			if (vertexData.empty())
+			{
+				ENG_LOG_ERROR("Vertex data is empty!" << std::endl);
+				return {};
+			}
 
-		vmaMapMemory(vmaAllocator, stagingIBAlloc, &data);
-		memcpy(data, indices.data(), indexSize);
-		vmaUnmapMemory(vmaAllocator, stagingIBAlloc);
+			const auto vertexCount = static_cast<uint32_t>(vertexData.size());
+			const auto indexCount = static_cast<uint32_t>(indices.size());
+			ENG_LOG_DEBUG("Allocating " << vertexCount << " vertices and " << indexCount << " indices" << std::endl);
 
-		graphicsEventQueue.push(
-			CommandRecorderEvent{
-				[this, stagingVB, stagingIB, stagingVBAlloc, stagingIBAlloc, drawDataInfo, vertexSize, indexSize](VkCommandBuffer cmdBuffer)
-				{
-					copyBuffer(cmdBuffer, stagingVB, drawDataInfo.vertexBuffers[0], vertexSize);
-					copyBuffer(cmdBuffer, stagingIB, drawDataInfo.indexBuffer, indexSize);
-				}
-			}
-		);
-
-		graphicsEventQueue.push(
-			CommandCompletionEvent{
-				[this, stagingVB, stagingIB, stagingVBAlloc, stagingIBAlloc]()
-				{
-					vmaDestroyBuffer(vmaAllocator, stagingVB, stagingVBAlloc);
-					vmaDestroyBuffer(vmaAllocator, stagingIB, stagingIBAlloc);
-				}
+			const auto allocation = geometry->allocate(format, sizeof(Vertex), vertexCount, indexCount);
+			stageUpload(vertexData.data(), sizeof(Vertex) * vertexCount,
+				geometry->vertex_buffer(allocation), geometry->vertex_byte_offset(allocation));
+			if (ENG::draws_indexed(indexCount))
+			{
+				stageUpload(indices.data(), sizeof(uint32_t) * indexCount,
+					geometry->index_buffer(allocation), geometry->index_byte_offset(allocation));
 			}
-		);
-
-		return drawDataInfo;
+			return allocation;
+		}, vertices);
 	}
 
 	void createDescriptorSets(const size_t drawDataIdx, ENG::Node& node)
@@ -263,7 +196,7 @@ public:
 			return;
 		}
 
-		ENG_LOG_DEBUG("Writing descriptor sets for: " << node.name << std::endl);
+		ENG_LOG_DEBUG("Writing descriptor sets for: " << node.name() << std::endl);
 
 		drawData.descriptorSets = std::vector<VkDescriptorSet>{};
 		assert(drawData.descriptorSets.has_value());
@@ -271,26 +204,110 @@ public:
 	}
 
 	/*
-	* Record commands and submit to queue, must be called from main thread
+	* Copies size bytes into the staging ring and queues their copy to dstBuffer at dstOffset. Uploads
+	* larger than the ring's chunk size are streamed through it in chunks. If the ring fills
+	* up, the open upload batch is submitted early, or the oldest batch holding the ring is
+	* waited on. Must be called from main thread.
 	*/
-	void command_recorder_event_handler(CommandRecorderEvent&& commandRecorderEvent) {
-		VkCommandBuffer cmdBuffer = renderer.commands->beginSingleTimeCommands(renderer.device);
+	void stageUpload(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset);
 
-		commandRecorderEvent.commandRecorder(cmdBuffer);
+	/*
+	* Records the staged copies into the renderer's open upload batch and submits everything
+	* recorded this frame at once, then runs the completion handlers of batches that have
+	* finished and reclaims their staging space. Call once per frame, before the frame
+	* that draws the uploaded data is submitted. Must be called from main thread.
+	*/
+	void submitUploads();
 
-		renderer.commands->endSingleTimeCommands(renderer.device, renderer.graphicsQueue, cmdBuffer);
+	/*
+	* Record commands into the open upload batch, submitted by submitUploads. The batch may
+	* run on a transfer only queue. Must be called from main thread.
+	*/
+	void command_recorder_event_handler(CommandRecorderEvent&& commandRecorderEvent) {
+		commandRecorderEvent.commandRecorder(renderer.uploads->command_buffer());
+	}
+
+	/*
+	* Runs the handler once everything recorded into the open upload batch so far has executed.
+	* Must be called from main thread.
+	*/
+	void command_completion_event_handler(CommandCompletionEvent&& commandCompletionEvent) {
+		renderer.uploads->on_complete(std::move(commandCompletionEvent.commandCompletionHandler));
 	}
 
 
 	/*
-	* Returns index of allocated draw data 
+	* Returns index of allocated draw data, reusing released slots first
 	*/
 	size_t emplaceDrawData(DrawData&& drawData) {
 		std::lock_guard<std::mutex> lock(drawDataMutex);
-		drawDataBuffer.emplace_back(drawData);
+		if (!freeDrawDataSlots.empty())
+		{
+			const auto drawDataIdx = freeDrawDataSlots.back();
+			freeDrawDataSlots.pop_back();
+			drawDataBuffer.at(drawDataIdx) = std::move(drawData);
+			return drawDataIdx;
+		}
+		drawDataBuffer.emplace_back(std::move(drawData));
 		return drawDataBuffer.size() - 1;
 	}
 
+	/*
+	* Frees the draw data slot for reuse. Its buffers and descriptor sets are destroyed by
+	* collectRetiredDrawData once every frame in flight recorded before this call has retired,
+	* along with the upload batch that may still be copying into its buffers.
+	* Must be called from main thread, between frames.
+	*/
+	void releaseDrawData(const size_t drawDataIdx)
+	{
+		std::lock_guard<std::mutex> lock(drawDataMutex);
+		assert(drawDataIdx < drawDataBuffer.size());
+		auto& drawData = drawDataBuffer.at(drawDataIdx);
+
+		// Staged copies are recorded into the open batch when it is submitted
+		const bool uploadOpen = renderer.uploads->has_pending() || !stagedCopies.empty();
+		retiredDrawData.push_back(RetiredDrawData{
+			renderer.submittedFrameCount + MAX_FRAMES_IN_FLIGHT,
+			uploadOpen ? renderer.uploads->open_serial() : renderer.uploads->open_serial() - 1,
+			std::move(drawData.descriptorSets),
+			std::move(drawData.bufferAllocationInfo)
+		});
+		drawData = DrawData{};
+		freeDrawDataSlots.push_back(drawDataIdx);
+	}
+
+	/*
+	* Destroys GPU resources of released draw data whose frames and uploads have completed.
+	* The frame that submits retireAtFrame has waited on the fence of the last frame
+	* that could have used them. Uploads may run on another queue, so they are tracked
+	* separately. Must be called from main thread.
+	*/
+	void collectRetiredDrawData()
+	{
+		std::lock_guard<std::mutex> lock(drawDataMutex);
+		while (!retiredDrawData.empty()
+			&& retiredDrawData.front().retireAtFrame <= renderer.submittedFrameCount
+			&& retiredDrawData.front().retireAtUpload <= renderer.uploads->completed_serial())
+		{
+			auto& retired = retiredDrawData.front();
+			if (retired.descriptorSets.has_value())
+			{
+				renderer.freeDescriptorSets(retired.descriptorSets.value());
+			}
+			if (retired.bufferAllocationInfo.has_value())
+			{
+				destroyDrawDataBuffers(retired.bufferAllocationInfo.value());
+			}
+			retiredDrawData.pop_front();
+		}
+	}
+
+	/*
+	* Destroys node and its descendants: releases their draw data, resets their model matrix
+	* slots and returns their nodeIds to the scene graph pool. Must be called from main thread.
+	*/
+	void destroyNodeSubtree(SceneState& sceneState, ENG::Node& node);
+
 	void recordCommandsForSceneGraph2(VkRenderer& renderer, VkCommandBuffer& commandBuffer, SceneState& sceneState);
 
 	/*
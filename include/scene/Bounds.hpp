@@ -0,0 +1,124 @@
+#pragma once
+#include <array>
+#include <limits>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+
+#include "scene/CpuFeatures.hpp"
+
+namespace ENG
+{
+
+// Axis aligned box. w is unused and kept at 1 so the box can be uploaded as two vec4s.
+// Default constructed boxes are empty (min > max) and merge as the identity.
+struct AABB {
+	glm::vec4 min{ std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), 1.f };
+	glm::vec4 max{ -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), -std::numeric_limits<float>::max(), 1.f };
+};
+
+struct Sphere {
+	glm::vec3 center{ 0.f };
+	float radius{ 0.f };
+};
+
+// Segment origin + t * direction for t in [0, maxT]
+struct Ray {
+	glm::vec3 origin{ 0.f };
+	glm::vec3 direction{ 0.f, 0.f, -1.f };
+	float maxT{ std::numeric_limits<float>::max() };
+};
+
+// Six inward facing planes (xyz normal, w offset): a point p is inside when
+// dot(normal, p) + w >= 0 for every plane
+struct Frustum {
+	std::array<glm::vec4, 6> planes{};
+};
+
+// Model space bounds of a mesh, computed once when its vertices are loaded
+struct MeshBounds {
+	AABB box;
+	Sphere sphere;
+};
+
+enum class Containment {
+	Outside,
+	Intersects,
+	Inside
+};
+
+inline bool is_empty(const AABB& box)
+{
+	return box.min.x > box.max.x || box.min.y > box.max.y || box.min.z > box.max.z;
+}
+
+inline AABB make_aabb(const glm::vec3& min, const glm::vec3& max)
+{
+	return AABB{ glm::vec4(min, 1.f), glm::vec4(max, 1.f) };
+}
+
+inline AABB merge(const AABB& a, const AABB& b)
+{
+	return make_aabb(glm::min(glm::vec3(a.min), glm::vec3(b.min)), glm::max(glm::vec3(a.max), glm::vec3(b.max)));
+}
+
+inline AABB expand(const AABB& box, float margin)
+{
+	const glm::vec3 r(margin);
+	return make_aabb(glm::vec3(box.min) - r, glm::vec3(box.max) + r);
+}
+
+inline glm::vec3 center(const AABB& box)
+{
+	return 0.5f * (glm::vec3(box.min) + glm::vec3(box.max));
+}
+
+inline glm::vec3 extents(const AABB& box)
+{
+	return 0.5f * (glm::vec3(box.max) - glm::vec3(box.min));
+}
+
+// Used as the insertion cost of the dynamic BVH
+inline float surface_area(const AABB& box)
+{
+	const auto d = glm::vec3(box.max) - glm::vec3(box.min);
+	return 2.f * (d.x * d.y + d.y * d.z + d.z * d.x);
+}
+
+inline bool overlaps(const AABB& a, const AABB& b)
+{
+	return a.min.x <= b.max.x && a.max.x >= b.min.x
+		&& a.min.y <= b.max.y && a.max.y >= b.min.y
+		&& a.min.z <= b.max.z && a.max.z >= b.min.z;
+}
+
+inline bool contains(const AABB& outer, const AABB& inner)
+{
+	return outer.min.x <= inner.min.x && outer.min.y <= inner.min.y && outer.min.z <= inner.min.z
+		&& outer.max.x >= inner.max.x && outer.max.y >= inner.max.y && outer.max.z >= inner.max.z;
+}
+
+// World box of a local box under an affine transform
+AABB transform_aabb(const glm::mat4& transform, const AABB& local);
+
+bool overlaps(const AABB& box, const Sphere& sphere);
+
+// Slab test. On a hit, tEntry is where the ray enters the box (0 if it starts inside).
+bool intersect_ray(const Ray& ray, const AABB& box, float& tEntry);
+
+// Planes extracted from a Vulkan style view-projection matrix (clip depth in [0, 1] when
+// GLM_FORCE_DEPTH_ZERO_TO_ONE is defined, [-1, 1] otherwise), normalised so plane
+// distances are in world units
+Frustum frustum_from_matrix(const glm::mat4& viewProjection);
+
+Containment classify(const Frustum& frustum, const AABB& box);
+
+// Bounds of count points read as three floats every stride bytes, in a single SIMD pass.
+// The sphere is centered on the box and circumscribes it. Empty box for count == 0.
+MeshBounds compute_point_bounds(const float* positions, size_t count, size_t stride);
+
+// Same as above with an explicit code path, used by tests and benchmarks.
+// Requesting a level the CPU does not support is undefined behaviour.
+MeshBounds compute_point_bounds(const float* positions, size_t count, size_t stride, SimdLevel level);
+
+} // end namespace
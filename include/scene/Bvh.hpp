@@ -0,0 +1,249 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+
+namespace ENG
+{
+
+// Fattening applied to leaf boxes, so small movements do not touch the tree
+constexpr float BVH_AABB_MARGIN = 0.1f;
+
+class DynamicAabbTree {
+	/*
+	 * Incremental bounding volume hierarchy over proxies, in the style of Box2D's
+	 * b2DynamicTree.
+	 *
+	 * Leaves hold a fattened copy of the proxy box. move_proxy() is free while the new box
+	 * stays inside the fat box; otherwise the leaf is removed and reinserted, and only its
+	 * ancestors are refitted. Insertion descends by surface area cost, and every refitted
+	 * ancestor is rebalanced with AVL style rotations, so the tree height stays logarithmic
+	 * however proxies are added, moved and removed.
+	 *
+	 * Queries call fn(userData) for every leaf whose fat box passes the test; returning false
+	 * from fn stops the query. Results are conservative by the margin, so callers that need
+	 * exact answers test their own bounds on the reported proxies.
+	 *
+	 * Not synchronised. Queries are const and may run concurrently with each other.
+	 */
+public:
+	static constexpr int32_t NULL_NODE = -1;
+
+	explicit DynamicAabbTree(float margin = BVH_AABB_MARGIN) : margin(margin) {}
+
+	int32_t create_proxy(const AABB& box, uint32_t userData);
+	void destroy_proxy(int32_t proxyId);
+
+	// Returns true if the leaf had to be reinserted
+	bool move_proxy(int32_t proxyId, const AABB& box);
+
+	void clear();
+
+	uint32_t user_data(int32_t proxyId) const { return nodes[proxyId].userData; }
+	const AABB& fat_aabb(int32_t proxyId) const { return nodes[proxyId].box; }
+
+	size_t proxy_count() const { return proxyCount; }
+	// 0 for an empty tree or a single leaf
+	int32_t height() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+	// Sum of internal node areas over the root area; lower is better
+	float area_ratio() const;
+
+	// Checks parent links, heights and that every parent box contains its children.
+	// Returns false instead of asserting so tests can report it.
+	bool validate() const;
+
+	template<typename Fn>
+	void query(const AABB& box, Fn&& fn) const
+	{
+		traverse([&box](const AABB& nodeBox) { return overlaps(nodeBox, box); }, fn);
+	}
+
+	template<typename Fn>
+	void query(const Sphere& sphere, Fn&& fn) const
+	{
+		traverse([&sphere](const AABB& nodeBox) { return overlaps(nodeBox, sphere); }, fn);
+	}
+
+	// Subtrees entirely inside the frustum are reported without testing their children
+	template<typename Fn>
+	void query(const Frustum& frustum, Fn&& fn) const
+	{
+		if (root == NULL_NODE) return;
+
+		Stack stack;
+		stack.push(root);
+		while (!stack.empty())
+		{
+			const auto id = stack.pop();
+			const auto& node = nodes[id];
+			const auto containment = classify(frustum, node.box);
+			if (containment == Containment::Outside) continue;
+
+			if (containment == Containment::Inside)
+			{
+				if (!report_subtree(id, fn)) return;
+			}
+			else if (node.is_leaf())
+			{
+				if (!fn(node.userData)) return;
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	// Generic form of the queries above, for callers with their own bounds test, such as ray
+	// packets: descends into every node for which test(box) is true
+	template<typename Test, typename Fn>
+	void query_if(const Test& test, Fn&& fn) const
+	{
+		traverse(test, fn);
+	}
+
+	// fn(userData, ray) returns the new maxT for the rest of the cast: ray.maxT to keep
+	// going, a smaller value to clip the ray at a hit, or 0 to stop. Children are visited
+	// nearest first, so clipping prunes as early as possible.
+	template<typename Fn>
+	void ray_cast(const Ray& input, Fn&& fn) const
+	{
+		if (root == NULL_NODE) return;
+
+		auto ray = input;
+		float tEntry = 0.f;
+		Stack stack;
+		stack.push(root);
+		while (!stack.empty())
+		{
+			const auto id = stack.pop();
+			const auto& node = nodes[id];
+			if (!intersect_ray(ray, node.box, tEntry)) continue;
+
+			if (node.is_leaf())
+			{
+				const float newMaxT = fn(node.userData, ray);
+				if (newMaxT <= 0.f) return;
+				ray.maxT = std::min(ray.maxT, newMaxT);
+				continue;
+			}
+
+			float t1 = 0.f;
+			float t2 = 0.f;
+			const bool hit1 = intersect_ray(ray, nodes[node.child1].box, t1);
+			const bool hit2 = intersect_ray(ray, nodes[node.child2].box, t2);
+			// Push the farther child first so the nearer one is popped next
+			if (hit1 && hit2)
+			{
+				stack.push(t1 <= t2 ? node.child2 : node.child1);
+				stack.push(t1 <= t2 ? node.child1 : node.child2);
+			}
+			else if (hit1) stack.push(node.child1);
+			else if (hit2) stack.push(node.child2);
+		}
+	}
+
+private:
+	struct TreeNode {
+		AABB box;
+		int32_t parent{ NULL_NODE };  // next free node while on the free list
+		int32_t child1{ NULL_NODE };
+		int32_t child2{ NULL_NODE };
+		int32_t height{ -1 };         // 0 for leaves, -1 for free nodes
+		uint32_t userData{ 0 };
+
+		bool is_leaf() const { return child1 == NULL_NODE; }
+	};
+
+	// Traversal stack that only touches the heap for trees deeper than its inline storage
+	class Stack {
+	public:
+		void push(int32_t id)
+		{
+			if (count < inlineIds.size()) inlineIds[count] = id;
+			else overflow.push_back(id);
+			++count;
+		}
+		int32_t pop()
+		{
+			--count;
+			if (count < inlineIds.size()) return inlineIds[count];
+			const auto id = overflow.back();
+			overflow.pop_back();
+			return id;
+		}
+		bool empty() const { return count == 0; }
+
+	private:
+		std::array<int32_t, 64> inlineIds;
+		std::vector<int32_t> overflow;
+		size_t count{ 0 };
+	};
+
+	std::vector<TreeNode> nodes;
+	int32_t root{ NULL_NODE };
+	int32_t freeList{ NULL_NODE };
+	size_t proxyCount{ 0 };
+	float margin;
+
+	int32_t allocate_node();
+	void free_node(int32_t id);
+	void insert_leaf(int32_t leaf);
+	void remove_leaf(int32_t leaf);
+	// Rotates the subtree at a if it is unbalanced; returns the new subtree root
+	int32_t balance(int32_t a);
+	// Recomputes boxes and heights from id to the root, rebalancing on the way
+	void refit_ancestors(int32_t id);
+	int32_t validate_subtree(int32_t id, bool& ok) const;
+
+	template<typename Test, typename Fn>
+	void traverse(const Test& test, Fn& fn) const
+	{
+		if (root == NULL_NODE) return;
+
+		Stack stack;
+		stack.push(root);
+		while (!stack.empty())
+		{
+			const auto& node = nodes[stack.pop()];
+			if (!test(node.box)) continue;
+
+			if (node.is_leaf())
+			{
+				if (!fn(node.userData)) return;
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+	}
+
+	template<typename Fn>
+	bool report_subtree(int32_t subtreeRoot, Fn& fn) const
+	{
+		Stack stack;
+		stack.push(subtreeRoot);
+		while (!stack.empty())
+		{
+			const auto& node = nodes[stack.pop()];
+			if (node.is_leaf())
+			{
+				if (!fn(node.userData)) return false;
+			}
+			else
+			{
+				stack.push(node.child1);
+				stack.push(node.child2);
+			}
+		}
+		return true;
+	}
+};
+
+} // end namespace
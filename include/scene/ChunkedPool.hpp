@@ -0,0 +1,239 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+namespace ENG
+{
+
+// Index plus the generation of the slot at the time the handle was taken.
+// A handle goes stale once its slot is released, even if the index is reused.
+struct PoolHandle {
+	uint32_t index{ UINT32_MAX };
+	uint32_t generation{ 0 };
+
+	bool operator==(const PoolHandle&) const = default;
+};
+
+template<typename T, size_t ChunkSize = 256, size_t MaxChunks = 4096>
+class ChunkedPool
+{
+	/*
+	 * Slot storage that never moves its elements.
+	 *
+	 * Elements live in fixed size chunks that are allocated on demand and never freed until
+	 * the pool is destroyed, so references and pointers to elements stay valid while the pool
+	 * grows. Released slots go on a free list and are handed out again by allocate(), with
+	 * their generation bumped so old handles can be detected.
+	 *
+	 * Indices are dense over [0, size()), and size() only ever grows; use is_alive() or the
+	 * iterators, which skip released slots. Not internally synchronised: serialise
+	 * allocate/release with the owner's lock.
+	 */
+	struct Chunk {
+		std::array<T, ChunkSize> items{};
+		std::array<uint32_t, ChunkSize> generations{};
+		std::array<bool, ChunkSize> alive{};
+	};
+
+public:
+	static constexpr size_t chunk_size = ChunkSize;
+	static constexpr size_t max_size = ChunkSize * MaxChunks;
+
+	ChunkedPool() : chunks(std::make_unique<std::atomic<Chunk*>[]>(MaxChunks)) {}
+
+	~ChunkedPool()
+	{
+		for (size_t i = 0; i < MaxChunks; ++i)
+		{
+			delete chunks[i].load(std::memory_order_relaxed);
+		}
+	}
+
+	ChunkedPool(const ChunkedPool&) = delete;
+	ChunkedPool& operator=(const ChunkedPool&) = delete;
+
+	// Returns the index of a live, default constructed element. O(1).
+	uint32_t allocate()
+	{
+		uint32_t index;
+		if (!freeList.empty())
+		{
+			index = freeList.back();
+			freeList.pop_back();
+		}
+		else
+		{
+			index = static_cast<uint32_t>(slotCount.load(std::memory_order_relaxed));
+			if (index >= max_size)
+			{
+				throw std::runtime_error("ChunkedPool capacity exceeded");
+			}
+			ensure_chunk(index / ChunkSize);
+		}
+
+		auto& chunk = chunk_of(index);
+		chunk.alive[index % ChunkSize] = true;
+		if (index == slotCount.load(std::memory_order_relaxed))
+		{
+			slotCount.store(index + 1, std::memory_order_release);
+		}
+		++liveCount;
+		return index;
+	}
+
+	// Allocates count fresh slots with consecutive indices and returns the first one.
+	// The free list is bypassed so the run is contiguous; released slots stay for allocate().
+	uint32_t allocate_range(size_t count)
+	{
+		const auto first = slotCount.load(std::memory_order_relaxed);
+		if (count > max_size - first)
+		{
+			throw std::runtime_error("ChunkedPool capacity exceeded");
+		}
+		for (size_t c = first / ChunkSize; c * ChunkSize < first + count; ++c)
+		{
+			ensure_chunk(c);
+		}
+
+		for (size_t index = first; index < first + count; ++index)
+		{
+			chunk_of(index).alive[index % ChunkSize] = true;
+		}
+		liveCount += count;
+		slotCount.store(first + count, std::memory_order_release);
+		return static_cast<uint32_t>(first);
+	}
+
+	// Resets the element and puts its slot on the free list. O(1).
+	void release(uint32_t index)
+	{
+		assert(is_alive(index));
+		auto& chunk = chunk_of(index);
+		const auto offset = index % ChunkSize;
+		chunk.items[offset] = T{};
+		chunk.alive[offset] = false;
+		++chunk.generations[offset];
+		freeList.push_back(index);
+		--liveCount;
+	}
+
+	// Preallocates chunks so the first count slots need no allocation
+	void reserve(size_t count)
+	{
+		if (count > max_size) throw std::runtime_error("ChunkedPool capacity exceeded");
+		for (size_t c = 0; c * ChunkSize < count; ++c)
+		{
+			ensure_chunk(c);
+		}
+	}
+
+	// Number of slots ever allocated, live or released; every index is below this
+	size_t size() const { return slotCount.load(std::memory_order_acquire); }
+	size_t live_count() const { return liveCount; }
+	bool empty() const { return liveCount == 0; }
+
+	bool is_alive(uint32_t index) const
+	{
+		return index < size() && chunk_of(index).alive[index % ChunkSize];
+	}
+
+	PoolHandle handle_of(uint32_t index) const
+	{
+		assert(is_alive(index));
+		return PoolHandle{ index, chunk_of(index).generations[index % ChunkSize] };
+	}
+
+	bool is_valid(const PoolHandle& handle) const
+	{
+		return is_alive(handle.index) && chunk_of(handle.index).generations[handle.index % ChunkSize] == handle.generation;
+	}
+
+	// nullptr when the handle is stale
+	T* get(const PoolHandle& handle) { return is_valid(handle) ? &(*this)[handle.index] : nullptr; }
+	const T* get(const PoolHandle& handle) const { return is_valid(handle) ? &(*this)[handle.index] : nullptr; }
+
+	T& operator[](size_t index) { return chunk_of(index).items[index % ChunkSize]; }
+	const T& operator[](size_t index) const { return chunk_of(index).items[index % ChunkSize]; }
+
+	T& at(size_t index)
+	{
+		if (!is_alive(static_cast<uint32_t>(index))) throw std::out_of_range("ChunkedPool::at: slot is not alive");
+		return (*this)[index];
+	}
+
+	const T& at(size_t index) const
+	{
+		if (!is_alive(static_cast<uint32_t>(index))) throw std::out_of_range("ChunkedPool::at: slot is not alive");
+		return (*this)[index];
+	}
+
+	template<typename Pool, typename Value>
+	class Iterator {
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = Value*;
+		using reference = Value&;
+
+		Iterator() = default;
+		Iterator(Pool* pool, size_t index) : pool(pool), index(index) { skip_released(); }
+
+		reference operator*() const { return (*pool)[index]; }
+		pointer operator->() const { return &(*pool)[index]; }
+		Iterator& operator++() { ++index; skip_released(); return *this; }
+		Iterator operator++(int) { auto copy = *this; ++(*this); return copy; }
+		bool operator==(const Iterator& other) const { return index == other.index; }
+		bool operator!=(const Iterator& other) const { return index != other.index; }
+
+	private:
+		Pool* pool{ nullptr };
+		size_t index{ 0 };
+
+		void skip_released()
+		{
+			const auto end = pool->size();
+			while (index < end && !pool->is_alive(static_cast<uint32_t>(index))) ++index;
+			if (index > end) index = end;
+		}
+	};
+
+	using iterator = Iterator<ChunkedPool, T>;
+	using const_iterator = Iterator<const ChunkedPool, const T>;
+
+	// Iterates live elements in index order. The end is fixed when end() is called.
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, size()); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, size()); }
+
+private:
+	// Fixed directory, so lookups never race with a reallocation while chunks are added
+	std::unique_ptr<std::atomic<Chunk*>[]> chunks;
+	std::atomic<size_t> slotCount{ 0 };
+	size_t liveCount{ 0 };
+	std::vector<uint32_t> freeList;
+
+	void ensure_chunk(size_t chunkIndex)
+	{
+		if (chunks[chunkIndex].load(std::memory_order_acquire) == nullptr)
+		{
+			chunks[chunkIndex].store(new Chunk(), std::memory_order_release);
+		}
+	}
+
+	Chunk& chunk_of(size_t index) const
+	{
+		auto* chunk = chunks[index / ChunkSize].load(std::memory_order_acquire);
+		assert(chunk != nullptr);
+		return *chunk;
+	}
+};
+
+} // end namespace
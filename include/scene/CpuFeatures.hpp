@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+// x86 SIMD code paths are compiled per function with target attributes, so the rest of
+// the project does not need -mavx2. Use ENG_SIMD_X86 to guard intrinsics includes and
+// ENG_TARGET_* on every function that uses the matching instruction set.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define ENG_SIMD_X86 1
+#else
+#define ENG_SIMD_X86 0
+#endif
+
+#if ENG_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ENG_TARGET_SSE41 __attribute__((target("sse4.1")))
+#define ENG_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#else
+#define ENG_TARGET_SSE41
+#define ENG_TARGET_AVX2
+#endif
+
+namespace ENG
+{
+
+enum class SimdLevel : uint8_t {
+	Scalar,
+	SSE41,
+	AVX2
+};
+
+struct CpuFeatures {
+	bool sse41{ false };
+	bool avx2{ false };
+	bool fma{ false };
+};
+
+// Detected once on first use
+const CpuFeatures& cpu_features();
+
+// Highest level supported by both the CPU and this build
+SimdLevel best_simd_level();
+
+const char* to_string(SimdLevel level);
+
+} // end namespace
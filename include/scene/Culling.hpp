@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+#include "scene/CpuFeatures.hpp"
+#include "scene/PreorderIndex.hpp"
+#include "scene/Transform.hpp"
+
+namespace ENG
+{
+
+class CullingBounds {
+	/*
+	 * World bounds by nodeId in structure-of-arrays form, as centers and half extents, so
+	 * the culling kernels test 4 or 8 boxes per instruction.
+	 *
+	 * Slots are "unbounded" until set, so nodes whose bounds are not known yet are never
+	 * culled, and "hidden" once cleared, so released nodeIds are never reported.
+	 */
+public:
+	void resize(size_t count);
+	size_t size() const { return centerX.size(); }
+
+	void set(uint32_t nodeId, const AABB& worldBounds);
+	void set_unbounded(uint32_t nodeId);
+	void set_hidden(uint32_t nodeId);
+
+	// True for slots holding a world box, false for unbounded and hidden ones
+	bool bounded(uint32_t nodeId) const;
+	AABB box(uint32_t nodeId) const;
+
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;
+};
+
+class SubtreeBounds {
+	/*
+	 * World bounds of every node merged with those of all its descendants, by nodeId, so a
+	 * whole subtree can be rejected with one test. Only bounded nodes contribute; a subtree
+	 * without any has an empty box.
+	 *
+	 * Refits are incremental: a changed node and its ancestors are recomputed, children
+	 * before parents, by merging the node's own box with the subtree boxes of its children.
+	 * Children are found through the preorder's subtree ends, without touching the graph.
+	 */
+public:
+	size_t size() const { return boxes.size(); }
+	const AABB& operator[](uint32_t nodeId) const { return boxes[nodeId]; }
+
+	// Refits the nodes of ranges and their ancestors from own, the nodes' world bounds.
+	// order must be the layout the ranges were written with.
+	void update(const PreorderIndex& order, const CullingBounds& own, std::span<const MatrixRange> ranges);
+
+private:
+	std::vector<AABB> boxes;
+	std::vector<uint32_t> dirtySlots;  // scratch, kept to reuse its capacity
+	std::vector<uint8_t> queued;       // by slot, cleared again after every update
+};
+
+struct CullStats {
+	uint32_t tested{ 0 };
+	uint32_t visible{ 0 };
+	uint32_t culled{ 0 };
+	uint32_t occluded{ 0 };  // inside the frustum but hidden behind occluders, see cull_scene
+};
+
+// Replaces visible with the nodeIds whose bounds intersect the frustum, in ascending order.
+// Dispatches to the widest SIMD path the CPU supports.
+CullStats cull_frustum(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible);
+
+// Same as above with an explicit code path, used by tests and benchmarks.
+// Requesting a level the CPU does not support is undefined behaviour.
+CullStats cull_frustum(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible, SimdLevel level);
+
+// Same result as cull_frustum for the nodes of order, except that unbounded nodes are
+// dropped along with a subtree that is rejected, walking in preorder. A subtree whose box is
+// outside the frustum is skipped with one test and one fully inside is kept without testing
+// its nodes. The nodes of straddling subtrees go through the same SIMD kernel as
+// cull_frustum, in runs of consecutive nodeIds; nodes created one by one with scattered
+// ids get runs of one and are tested without SIMD. visible is in preorder and tested
+// counts the boxes actually tested.
+CullStats cull_hierarchy(const Frustum& frustum, const PreorderIndex& order, const SubtreeBounds& subtrees,
+	const CullingBounds& bounds, std::vector<uint32_t>& visible);
+
+} // end namespace
@@ -1,7 +1,59 @@
 #pragma once
+#include <cstdint>
 #include <optional>
+#include <span>
 #include <vector>
 #include "glm/glm.hpp"
+#include "scene/CpuFeatures.hpp"
 
+// line_strip lists the vertices of a planar polygon, convex or concave, counter-clockwise seen
+// from the front. The closing edge back to the first vertex is implied; repeating the first
+// vertex at the end is also accepted. Only front faces are hit.
 bool ray_polygon_intersection(const glm::vec3 ray_origin, const glm::vec3 ray_direction, const std::vector<glm::vec3>& line_strip);
+// As above, also giving the ray parameter of the hit
+bool ray_polygon_intersection(const glm::vec3 ray_origin, const glm::vec3 ray_direction, const std::vector<glm::vec3>& line_strip, float& distance);
+// Point where a ray crosses a segment lying in the same plane, if it does
+std::optional<glm::vec3> ray_line_intersection(const glm::vec3& ray_origin, const glm::vec3& ray_direction, const glm::vec3& segment_start, const glm::vec3& segment_end);
 std::optional<glm::vec3> ray_plane_intersection(const glm::vec3& ray_origin, const glm::vec3& ray_direction, const glm::vec3& plane_p0, const glm::vec3& plane_normal);
+
+constexpr uint32_t POLYGON_BATCH_MAX_VERTICES = 6;
+
+struct PolygonHit {
+	uint32_t polygon;
+	float distance;  // ray parameter of the hit
+};
+
+class PolygonBatch {
+	/*
+	 * One ray against many small convex polygons, such as the pentagons and hexagons of a
+	 * Goldberg polyhedron, without triangulating them.
+	 *
+	 * Every polygon is stored as its plane and one inward facing plane per edge, in blocks of
+	 * 8 polygons laid out for SIMD. A test is a plane intersection followed by up to 6 edge
+	 * side tests, for 4 (SSE4.1) or 8 (AVX2) polygons at a time. Pentagons repeat a vertex,
+	 * which gives an edge that always passes. Both faces are hit.
+	 */
+public:
+	PolygonBatch() = default;
+	// Polygon i is vertices[offsets[i], offsets[i + 1]), 3 to POLYGON_BATCH_MAX_VERTICES
+	// vertices in order around the boundary. Throws std::runtime_error otherwise.
+	PolygonBatch(std::span<const uint32_t> offsets, std::span<const glm::vec3> vertices);
+
+	// Closest polygon hit within [0, maxT]
+	std::optional<PolygonHit> intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT) const;
+	std::optional<PolygonHit> intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT, ENG::SimdLevel level) const;
+
+	size_t size() const { return polygonCount; }
+
+	struct alignas(32) Block {
+		float nx[8], ny[8], nz[8], d[8];  // polygon plane, n . p = d
+		float ex[POLYGON_BATCH_MAX_VERTICES][8];  // edge planes, inside where e . p >= c
+		float ey[POLYGON_BATCH_MAX_VERTICES][8];
+		float ez[POLYGON_BATCH_MAX_VERTICES][8];
+		float c[POLYGON_BATCH_MAX_VERTICES][8];
+	};
+
+private:
+	std::vector<Block> blocks;
+	size_t polygonCount{ 0 };
+};
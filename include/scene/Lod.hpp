@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+
+namespace ENG
+{
+
+constexpr uint32_t LOD_CULLED = UINT32_MAX;
+
+struct LodSettings {
+	// Relative band around every threshold: a node switches to a coarser level once it is
+	// this much below the threshold, and back once it is this much above
+	float hysteresis{ 0.1f };
+	// Contribution cutoff, as a fraction of the viewport height: bounded nodes whose
+	// projected bounding sphere is smaller are not drawn. 0 disables it.
+	float minScreenSize{ 0.001f };
+};
+
+struct LodLevel {
+	size_t drawDataIdx{ 0 };
+	// Used while the projected bounding sphere is at least this tall, as a fraction of the
+	// viewport height. The coarsest level is used below its threshold down to the cutoff.
+	float minScreenSize{ 0.f };
+};
+
+// Contribution cutoff with the same hysteresis band as the level switches: a drawn node is
+// dropped once it is below the band around settings.minScreenSize, a dropped one comes back
+// once it is above it
+bool below_cutoff(float screenSize, bool wasCulled, const LodSettings& settings);
+
+class LodGroup {
+	/*
+	 * Draw data of one node at several levels of detail, finest first, and the level
+	 * selected for it last frame, which is what the hysteresis is relative to.
+	 */
+public:
+	void add_level(size_t drawDataIdx, float minScreenSize);
+	const std::vector<LodLevel>& levels() const { return lodLevels; }
+	bool empty() const { return lodLevels.empty(); }
+
+	// Index into levels(), or LOD_CULLED
+	uint32_t current() const { return currentLevel; }
+
+	// Selects, stores and returns the level for a projected size, or LOD_CULLED below the
+	// settings' cutoff
+	uint32_t select(float screenSize, const LodSettings& settings);
+
+private:
+	std::vector<LodLevel> lodLevels;
+	uint32_t currentLevel{ 0 };
+};
+
+// Bounding sphere of a model space sphere after the model matrix, scaled by its largest axis
+Sphere transform_sphere(const glm::mat4& model, const Sphere& sphere);
+
+// Height of the sphere's projection as a fraction of the viewport height. Perspective
+// projections shrink it with distance, orthographic ones do not. Spheres around the camera
+// get the largest float.
+float projected_screen_size(const Sphere& worldSphere, const glm::vec3& cameraPosition, const glm::mat4& projection);
+
+struct LodStats {
+	uint32_t selected{ 0 };   // nodes with LOD groups that are drawn
+	uint32_t switched{ 0 };   // of those, nodes whose level changed this frame
+	uint32_t culled{ 0 };     // nodes dropped by the contribution cutoff
+};
+
+} // end namespace
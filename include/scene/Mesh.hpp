@@ -15,6 +15,8 @@
 #include "renderer/vk/Buffer.hpp"
 #include "renderer/vk/Command.hpp"
 #include "scene/Primitives.hpp"
+#include "scene/Bounds.hpp"
+#include "scene/TriangleBvh.hpp"
 #include "logger/Logging.hpp"
 
 namespace ENG
@@ -28,14 +30,35 @@ namespace ENG
 
 	struct HostMeshData {
 		VertexT vertexBuffer;
-		std::vector<uint32_t> indexBuffer;
+		std::vector<uint32_t> indexBuffer;  // empty for meshes drawn non-indexed, see draws_indexed
 		std::string shaderId;
 		std::optional<std::filesystem::path> texturePath;
+		// Filled by prepare_host_mesh_data on the loader thread
+		MeshBounds localBounds;
+		std::shared_ptr<const TriangleBvh> pickMesh;
 	};
 
+	// Meshes with indices are drawn indexed. Meshes without are drawn as consecutive vertex
+	// triples, and their pick mesh, which ray queries and occlusion also read, is built from
+	// the same triples.
+	constexpr bool draws_indexed(size_t indexCount)
+	{
+		return indexCount > 0;
+	}
+
+	// Computes localBounds and builds the picking triangle BVH from the vertex and index
+	// data, so the render thread never has to walk the vertex data again. Loaders wrap every
+	// HostMeshData they queue with this.
+	HostMeshData prepare_host_mesh_data(HostMeshData&& meshData);
+
 	struct BindHostMeshDataEvent {
 		HostMeshData meshData;
 		uint32_t nodeId;
+		// Binds the mesh as a level of detail of the node, used while its projected bounding
+		// sphere is at least this tall (see LodLevel). The first mesh bound to a node also
+		// provides its bounds and pick mesh; later levels only add draw data. A node bound
+		// without a level cannot take levels later, and the other way around.
+		std::optional<float> lodMinScreenSize{};
 	};
 
 	class Mesh {
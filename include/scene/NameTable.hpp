@@ -0,0 +1,53 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ENG
+{
+
+// 32-bit handle to an interned string. Equal symbols mean equal strings.
+using NameSymbol = uint32_t;
+
+// Symbol of the empty string, which every table starts with
+constexpr NameSymbol EMPTY_NAME = 0;
+
+class NameTable {
+	/*
+	 * Append-only string interner.
+	 *
+	 * Every distinct string is stored once and identified by a dense symbol, so hot structs
+	 * hold 4 bytes instead of an owning std::string and names compare by integer. Interned
+	 * strings are never freed or moved, so references returned by str() stay valid for the
+	 * lifetime of the table. Safe to use from the loader and render threads concurrently.
+	 */
+public:
+	NameTable();
+
+	NameTable(const NameTable&) = delete;
+	NameTable& operator=(const NameTable&) = delete;
+
+	// Returns the symbol for name, adding it on first use
+	NameSymbol intern(std::string_view name);
+
+	// Looks up an existing symbol without adding one
+	std::optional<NameSymbol> find(std::string_view name) const;
+
+	const std::string& str(NameSymbol symbol) const;
+
+	size_t size() const;
+
+private:
+	mutable std::shared_mutex mut;
+	std::deque<std::string> strings;  // deque keeps element addresses stable on push_back
+	std::unordered_map<std::string_view, NameSymbol> symbols;  // views into strings
+};
+
+// Process wide table shared by all scene graphs, so symbols can be compared across scenes
+NameTable& node_names();
+
+} // end namespace
@@ -1,19 +1,23 @@
 #pragma once
+#include<algorithm>
 #include<cstdint>
+#include<limits>
+#include<stdexcept>
+#include<string_view>
+#include<type_traits>
 #include<vector>
 
 #include<glm/glm.hpp>
 #include<glm/gtc/quaternion.hpp>
 
-#include "renderer/vk_adapter/VkAdapter.hpp"
+#include "scene/Transform.hpp"
+#include "scene/NameTable.hpp"
 
 namespace ENG {
-	using id_t = uint8_t;
 	using property_t = uint16_t;
 
-	// Size of statically allocated arrays
-	constexpr size_t MAX_NUMBER_OF_NODES = 255;
-	constexpr size_t MAX_NAME_LENGTH_CHARS = 16;
+	// Default capacity of a SceneStore
+	constexpr size_t MAX_NUMBER_OF_NODES = 1 << 20;
 
 	// Property flags
 	constexpr property_t HAS_DRAW_DATA = 0x1;
@@ -26,30 +30,203 @@ namespace ENG {
 	constexpr property_t IS_SELECTED = 0x1 << 7;
 	constexpr property_t IS_LAST_CHILD = 0x1 << 8;
 
-	struct TRS {
-		glm::vec3 scale{ 1.f };
-		glm::vec3 translation{ 0.f };
-		glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
-	};
+	constexpr void set_property(property_t& flags, const property_t propertyFlag)
+	{
+		flags |= propertyFlag;
+	}
 
-	struct Node2 {
-		id_t                       nodeId{ 0 };  // index into "nodes" vector
-		id_t                       parent{ 0 };
-		property_t          propertyFlags{ 0 };
-	};
+	constexpr void clear_property(property_t& flags, const property_t propertyFlag)
+	{
+		flags &= static_cast<property_t>(~propertyFlag);
+	}
+
+	// True when every bit of propertyFlag is set
+	constexpr bool has_property(const property_t flags, const property_t propertyFlag)
+	{
+		return (flags & propertyFlag) == propertyFlag;
+	}
+
+	template<typename Id = uint32_t, size_t MaxNodes = MAX_NUMBER_OF_NODES>
+	class SceneStore {
+		/*
+		 * Structure-of-arrays scene storage.
+		 *
+		 * Each attribute lives in its own array indexed by node id, so a pass only streams the
+		 * bytes it reads: a visibility pass touches 2 bytes of flags and one id per node rather
+		 * than a whole ENG::Node. Nodes are append-only and a parent must exist before its
+		 * children, so parent ids are always lower than child ids and hierarchical passes are
+		 * a single forward sweep.
+		 *
+		 * Id sets the width of node ids and links; MaxNodes must fit in Id. Arrays grow on
+		 * demand up to MaxNodes. Not synchronised: build on one thread, then read freely.
+		 *
+		 * Not used by the renderer yet, scenes still live in SceneGraph. This is the storage
+		 * the graph is meant to move to, exercised by its test and bench_scene_store.
+		 */
+		static_assert(std::is_unsigned_v<Id>, "SceneStore ids must be unsigned");
+		static_assert(MaxNodes > 0 && MaxNodes <= std::numeric_limits<Id>::max(),
+			"MaxNodes must fit in the id type, leaving its maximum free for NO_NODE");
+
+	public:
+		using id_type = Id;
+		static constexpr Id NO_NODE = std::numeric_limits<Id>::max();
+		static constexpr size_t max_size = MaxNodes;
+		static constexpr uint32_t NO_DRAW_DATA = UINT32_MAX;
+
+		void reserve(size_t count)
+		{
+			if (count > MaxNodes) throw std::runtime_error("SceneStore capacity exceeded");
+			parents.reserve(count);
+			firstChildren.reserve(count);
+			lastChildren.reserve(count);
+			nextSiblings.reserve(count);
+			flags.reserve(count);
+			names.reserve(count);
+			locals.reserve(count);
+			drawDataIdx.reserve(count);
+		}
+
+		// Appends a visible node under parent, or a root when parent is NO_NODE
+		Id create(Id parent = NO_NODE, property_t propertyFlags = IS_VISIBLE)
+		{
+			if (parents.size() >= MaxNodes) throw std::runtime_error("SceneStore capacity exceeded");
+			if (parent != NO_NODE && parent >= parents.size()) throw std::out_of_range("SceneStore: parent does not exist");
+
+			const auto id = static_cast<Id>(parents.size());
+			parents.push_back(parent);
+			firstChildren.push_back(NO_NODE);
+			lastChildren.push_back(NO_NODE);
+			nextSiblings.push_back(NO_NODE);
+			flags.push_back(propertyFlags);
+			names.push_back(EMPTY_NAME);
+			locals.emplace_back();
+			drawDataIdx.push_back(NO_DRAW_DATA);
+
+			if (parent != NO_NODE)
+			{
+				// Children are linked in creation order
+				if (lastChildren[parent] == NO_NODE)
+				{
+					firstChildren[parent] = id;
+				}
+				else
+				{
+					nextSiblings[lastChildren[parent]] = id;
+				}
+				lastChildren[parent] = id;
+			}
+			return id;
+		}
+
+		size_t size() const { return parents.size(); }
+
+		// Bytes stored per node across all arrays, excluding vector slack
+		static constexpr size_t bytes_per_node()
+		{
+			return 4 * sizeof(Id) + sizeof(property_t) + sizeof(NameSymbol) + sizeof(TRS)
+				+ sizeof(uint32_t) + sizeof(uint8_t);
+		}
+		bool empty() const { return parents.empty(); }
 
-	using name_t = std::array<char, MAX_NAME_LENGTH_CHARS>;
-	using names_array_t = std::array<name_t, MAX_NUMBER_OF_NODES>;
-	using node_array_t = std::array<Node2, MAX_NUMBER_OF_NODES>;
-	using draw_data_array_t = std::array<DrawData, MAX_NUMBER_OF_NODES>;
-	using trs_array_t = std::array<TRS, MAX_NUMBER_OF_NODES>;
+		Id parent(Id id) const { return parents[id]; }
+		Id first_child(Id id) const { return firstChildren[id]; }
+		Id next_sibling(Id id) const { return nextSiblings[id]; }
 
-	names_array_t     names;
-	node_array_t      nodes;
-	draw_data_array_t drawData;
-	trs_array_t       trs;
+		property_t properties(Id id) const { return flags[id]; }
+		bool has_property(Id id, property_t propertyFlag) const { return ENG::has_property(flags[id], propertyFlag); }
+		void set_property(Id id, property_t propertyFlag) { ENG::set_property(flags[id], propertyFlag); }
+		void clear_property(Id id, property_t propertyFlag) { ENG::clear_property(flags[id], propertyFlag); }
+
+		void set_name(Id id, std::string_view name)
+		{
+			names[id] = node_names().intern(name);
+			if (names[id] == EMPTY_NAME) clear_property(id, HAS_NAME);
+			else set_property(id, HAS_NAME);
+		}
+		const std::string& name(Id id) const { return node_names().str(names[id]); }
+
+		TRS& local_transform(Id id) { return locals[id]; }
+		const TRS& local_transform(Id id) const { return locals[id]; }
+		const std::vector<TRS>& local_transforms() const { return locals; }
+
+		void set_draw_data(Id id, uint32_t drawIdx)
+		{
+			drawDataIdx[id] = drawIdx;
+			if (drawIdx == NO_DRAW_DATA) clear_property(id, HAS_DRAW_DATA);
+			else set_property(id, HAS_DRAW_DATA);
+		}
+		uint32_t draw_data(Id id) const { return drawDataIdx[id]; }
+
+		// Calls fn(id, depth) for every node in depth-first preorder, roots in id order.
+		// Children are visited in creation order.
+		template<typename Fn>
+		void depth_first_traverse(Fn&& fn) const
+		{
+			std::vector<std::pair<Id, uint32_t>> stack;
+			for (size_t root = 0; root < parents.size(); ++root)
+			{
+				if (parents[root] != NO_NODE) continue;
+
+				stack.emplace_back(static_cast<Id>(root), 0u);
+				while (!stack.empty())
+				{
+					const auto [id, depth] = stack.back();
+					stack.pop_back();
+					fn(id, depth);
+
+					// Next sibling goes under the first child, so the child's subtree is finished
+					// first. The stack only ever holds one entry per level.
+					if (nextSiblings[id] != NO_NODE) stack.emplace_back(nextSiblings[id], depth);
+					if (firstChildren[id] != NO_NODE) stack.emplace_back(firstChildren[id], depth + 1);
+				}
+			}
+		}
+
+		// A node is effectively visible when it and all of its ancestors have IS_VISIBLE.
+		// Writes the ids of effectively visible nodes to visible, in id order.
+		void gather_visible(std::vector<Id>& visible)
+		{
+			visible.clear();
+			effectiveVisible.resize(parents.size());
+			for (size_t id = 0; id < parents.size(); ++id)
+			{
+				const auto parentId = parents[id];
+				const bool parentVisible = parentId == NO_NODE || effectiveVisible[parentId];
+				effectiveVisible[id] = parentVisible && ENG::has_property(flags[id], IS_VISIBLE);
+				if (effectiveVisible[id]) visible.push_back(static_cast<Id>(id));
+			}
+		}
+
+		// Calls fn(id, drawDataIdx) for every effectively visible node with draw data.
+		// Uses the visibility computed by the last gather_visible call.
+		template<typename Fn>
+		void for_each_drawable(Fn&& fn) const
+		{
+			const auto count = std::min(parents.size(), effectiveVisible.size());
+			for (size_t id = 0; id < count; ++id)
+			{
+				if (effectiveVisible[id] && ENG::has_property(flags[id], HAS_DRAW_DATA))
+				{
+					fn(static_cast<Id>(id), drawDataIdx[id]);
+				}
+			}
+		}
+
+	private:
+		// Hierarchy links
+		std::vector<Id> parents;
+		std::vector<Id> firstChildren;
+		std::vector<Id> lastChildren;
+		std::vector<Id> nextSiblings;
+		// Attributes
+		std::vector<property_t> flags;
+		std::vector<NameSymbol> names;
+		std::vector<TRS> locals;
+		std::vector<uint32_t> drawDataIdx;
+		// Cached by gather_visible; uint8_t rather than vector<bool> to keep the sweep branch free
+		std::vector<uint8_t> effectiveVisible;
+	};
 
-	inline static void set_property(Node2& node, const property_t propertyFlag);
-	inline static bool has_property(const Node2& node, const property_t propertyFlag);
-	inline static void depth_first_traverse(node_array_t& nodes);
+	// Scenes up to 65535 nodes halve the size of every link array
+	using SmallSceneStore = SceneStore<uint16_t, 0xFFFE>;
 }
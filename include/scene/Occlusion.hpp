@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+#include "scene/CpuFeatures.hpp"
+#include "scene/TriangleBvh.hpp"
+
+namespace ENG
+{
+
+class OcclusionBuffer {
+	/*
+	 * Low resolution depth buffer rasterized on the CPU from a few occluder meshes, and a
+	 * min/max depth pyramid over it for testing bounding boxes against them.
+	 *
+	 * Depth is z / w of the clip space position, smaller is nearer, cleared to 1 (the far
+	 * plane). Pixels are covered when their center is inside a triangle, and triangles that
+	 * cross the near plane are skipped. Rasterization gives bit identical images on every
+	 * SIMD level, so depth images can be compared exactly in tests.
+	 */
+public:
+	// width is rounded up to a multiple of 8
+	explicit OcclusionBuffer(uint32_t width = 256, uint32_t height = 144);
+
+	uint32_t width() const { return bufferWidth; }
+	uint32_t height() const { return bufferHeight; }
+
+	// Resets every pixel to the far plane
+	void clear();
+
+	// Rasterizes the mesh's triangles, both faces, with clipFromModel = viewProjection * model.
+	// Dispatches to the widest SIMD path the CPU supports.
+	void rasterize(const glm::mat4& clipFromModel, const TriangleBvh& mesh);
+	// Same as above with an explicit code path, used by tests and benchmarks.
+	// Requesting a level the CPU does not support is undefined behaviour.
+	void rasterize(const glm::mat4& clipFromModel, const TriangleBvh& mesh, SimdLevel level);
+
+	// Rebuilds the pyramid from the depth image; call after the last rasterize of a frame
+	void build_pyramid();
+
+	// True if the world box lies entirely behind rasterized occluders. Boxes that cross the
+	// near plane or fall outside the viewport are never occluded.
+	bool occluded(const glm::mat4& viewProjection, const AABB& worldBox) const;
+
+	// Level 0 is the depth image itself; level i + 1 halves level i, rounding up
+	uint32_t level_count() const { return static_cast<uint32_t>(levels.size()); }
+	float depth(uint32_t x, uint32_t y) const { return depthImage[y * bufferWidth + x]; }
+	float min_depth(uint32_t level, uint32_t x, uint32_t y) const { return levels[level].minDepth[y * levels[level].width + x]; }
+	float max_depth(uint32_t level, uint32_t x, uint32_t y) const { return levels[level].maxDepth[y * levels[level].width + x]; }
+	const std::vector<float>& depth_image() const { return depthImage; }
+
+private:
+	struct Level {
+		uint32_t width{ 0 };
+		uint32_t height{ 0 };
+		std::vector<float> minDepth;
+		std::vector<float> maxDepth;
+	};
+
+	uint32_t bufferWidth;
+	uint32_t bufferHeight;
+	std::vector<float> depthImage;
+	std::vector<Level> levels;
+};
+
+} // end namespace
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+
+#include "scene/Scene.hpp"
+
+namespace ENG
+{
+
+struct PickHit {
+	uint32_t nodeId{ 0 };
+	uint32_t triangleId{ 0 };     // triangle of the node's mesh, in index buffer order
+	glm::vec3 barycentrics{ 0.f };  // weights of the triangle's three vertices
+	float distance{ 0.f };        // world space distance from the ray origin
+};
+
+// World space ray from the camera through a cursor position in normalized device
+// coordinates, ending at the far plane. proj is the Vulkan projection (y flipped).
+Ray cursor_ray(const glm::mat4& view, const glm::mat4& proj, const glm::vec2& cursorNdc);
+
+// Closest selectable node hit by the ray. Candidates come from the scene BVH in
+// nearest-first order, and each is refined against its mesh's triangle BVH in model space,
+// so only nodes whose world bounds the ray crosses are tested.
+// Expects a normalized direction, so that distances are in world units.
+std::optional<PickHit> pick(const SceneState& sceneState, const Ray& worldRay);
+
+} // end namespace
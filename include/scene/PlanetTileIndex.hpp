@@ -0,0 +1,52 @@
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+
+namespace ENG
+{
+
+class PlanetTileIndex {
+	/*
+	 * Direction to tile lookup for a planet made of convex tiles covering a sphere, such as
+	 * the Goldberg polyhedra of the world scene.
+	 *
+	 * Directions are binned on an equal-angle cube map. Every cell lists the tiles whose
+	 * projection overlaps it, and the resolution grows with the tile count so a cell only
+	 * overlaps a handful of tiles. A lookup is one cube map projection plus a spherical
+	 * point-in-polygon test per candidate, whatever the number of tiles.
+	 */
+public:
+	// tilePolygons holds the boundary vertices of every tile in model space, tile after tile;
+	// tile i is [polygonOffsets[i], polygonOffsets[i + 1]). Tile ids are their indices, so
+	// pass tiles in faceId order. The sphere is centered on the model space origin.
+	void build(std::span<const uint32_t> polygonOffsets, std::span<const glm::vec3> tilePolygons);
+	void clear();
+
+	// Tile containing the direction from the planet center, if the index is not empty
+	std::optional<uint32_t> tile_at(const glm::vec3& direction) const;
+
+	// Tile under the first point where a model space ray meets the planet's bounding sphere
+	std::optional<uint32_t> pick(const Ray& modelRay) const;
+
+	size_t tile_count() const { return polygonOffsets.empty() ? 0 : polygonOffsets.size() - 1; }
+	uint32_t resolution() const { return cellsPerEdge; }
+	// Longest candidate list of any cell
+	size_t max_candidates() const;
+
+private:
+	uint32_t cellsPerEdge{ 0 };
+	float radius{ 0.f };
+	std::vector<uint32_t> polygonOffsets;
+	std::vector<glm::vec3> polygons;  // normalized tile vertices
+	std::vector<glm::vec3> centers;   // normalized tile centroids, the fallback near edges
+	std::vector<uint32_t> cellOffsets;  // candidates of cell c are cellTiles[cellOffsets[c], cellOffsets[c + 1])
+	std::vector<uint32_t> cellTiles;
+
+	bool contains(uint32_t tile, const glm::vec3& direction) const;
+};
+
+} // end namespace
@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace ENG
+{
+
+class Node;
+class SceneGraph;
+
+class PreorderIndex {
+	/*
+	 * Cached depth-first preorder of a scene graph.
+	 *
+	 * Each node gets a slot; slots are in preorder, so every subtree is the contiguous slot
+	 * range [slot, subtreeEnd). Iterating the whole tree or one subtree is then a loop over
+	 * a span of nodeIds, with no stack and no allocation.
+	 *
+	 * The index is rebuilt by sync() only when the graph's structure version moved, and the
+	 * rebuild reuses its buffers, so steady state frames never allocate. Both hold the
+	 * graph's lock while they read its structure, so they may run while loaders add nodes.
+	 */
+public:
+	static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+	// Rebuilds if the graph structure changed since the last build. Returns true if it did.
+	bool sync(const SceneGraph& graph);
+	void rebuild(const SceneGraph& graph);
+
+	size_t size() const { return nodeIds.size(); }
+
+	// nodeIds of every node, the root tree first, then trees detached from the root
+	std::span<const uint32_t> all() const { return nodeIds; }
+
+	// nodeIds of nodeId and its descendants, nodeId first. Empty if the node has no slot.
+	std::span<const uint32_t> subtree(uint32_t nodeId) const;
+
+	uint32_t slot_of(uint32_t nodeId) const { return nodeId < slotOfNode.size() ? slotOfNode[nodeId] : NO_SLOT; }
+
+	const std::vector<uint32_t>& node_ids() const { return nodeIds; }
+	const std::vector<uint32_t>& parent_slots() const { return parentSlots; }
+	const std::vector<uint32_t>& subtree_ends() const { return subtreeEnds; }
+	const std::vector<uint32_t>& slot_of_node() const { return slotOfNode; }
+
+private:
+	std::vector<uint32_t> nodeIds;      // nodeId stored at each slot
+	std::vector<uint32_t> parentSlots;  // slot of the parent, NO_SLOT for roots
+	std::vector<uint32_t> subtreeEnds;  // one past the last slot of this slot's subtree
+	std::vector<uint32_t> slotOfNode;   // inverse of nodeIds, NO_SLOT for released nodeIds
+	uint64_t builtStructureVersion{ UINT64_MAX };
+
+	std::vector<std::pair<const Node*, uint32_t>> stack;  // kept to reuse its capacity
+
+	// Caller holds the graph's lock
+	void build(const SceneGraph& graph);
+};
+
+} // end namespace
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <span>
+
+#include "scene/Scene.hpp"
+
+namespace ENG
+{
+
+constexpr uint32_t RAY_MISS = UINT32_MAX;
+
+struct RayHit {
+	uint32_t nodeId{ RAY_MISS };  // RAY_MISS when nothing was hit
+	uint32_t triangleId{ 0 };
+	float t{ 0.f };               // ray parameter of the hit, world distance for unit directions
+	float u{ 0.f };               // barycentric weights of the triangle's second and third vertices
+	float v{ 0.f };
+
+	bool hit() const { return nodeId != RAY_MISS; }
+};
+
+/*
+ * Batched ray queries against every node with a pick mesh (SceneState::pickMeshes).
+ *
+ * Rays are processed in packets of 4 (SSE4.1) or 8 (AVX2) consecutive rays. A packet walks
+ * the scene BVH and each mesh's triangle BVH once, testing all of its rays per box and per
+ * triangle, and descends while any ray is still interested. Packets share the most work
+ * when neighbouring rays are coherent, as in sensor sweeps or rays toward nearby targets,
+ * so order the span accordingly.
+ *
+ * Queries only read the scene and may run concurrently with each other, but not with
+ * update_world_bounds().
+ */
+
+// Closest hit of every ray within [0, maxT]. hits must be as long as rays.
+void intersect_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<RayHit> hits);
+void intersect_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<RayHit> hits, SimdLevel level);
+
+// Line of sight: occluded[i] is 1 if anything hits ray i within [0, maxT], else 0.
+// Stops at the first hit of each ray, so it is cheaper than intersect_rays.
+void occluded_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<uint8_t> occluded);
+void occluded_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<uint8_t> occluded, SimdLevel level);
+
+} // end namespace
@@ -3,6 +3,12 @@
 #include<optional>
 #include<random>
 #include<chrono>
+#include<atomic>
+#include<mutex>
+#include<functional>
+#include<span>
+#include<string_view>
+#include<unordered_map>
 
 #include "tiny_gltf.h"
 #define GLM_FORCE_RADIANS
@@ -11,6 +17,16 @@
 #include <glm/gtc/quaternion.hpp>
 
 #include "scene/Mesh.hpp"
+#include "scene/Transform.hpp"
+#include "scene/ChunkedPool.hpp"
+#include "scene/NameTable.hpp"
+#include "scene/Bounds.hpp"
+#include "scene/Bvh.hpp"
+#include "scene/Culling.hpp"
+#include "scene/Occlusion.hpp"
+#include "scene/Lod.hpp"
+#include "scene/TriangleBvh.hpp"
+#include "scene/PlanetTileIndex.hpp"
 
 using namespace tinygltf;
 
@@ -36,19 +52,13 @@ struct Properties {
 	std::uint32_t propertyFlags;
 };
 
-struct AABB {
-	glm::vec4 min;
-	glm::vec4 max;
-};
-
 class Node {
 	/*
 	 * Base class entities in a scene graph
 	 */
 
 public:
-	unsigned int nodeId;  // index into "nodes" vector
-	std::string name{};
+	unsigned int nodeId{ 0 };  // slot index into the "nodes" pool
 	glm::vec3 scale { 1.f };
 	glm::vec3 translation{ 0.f };
 	glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
@@ -62,26 +72,147 @@ public:
 	Camera* camera { nullptr };
 	bool visible{ true };
 	bool selectable{ false };
+	bool occluder{ false };  // rasterized into SceneState::occlusion from its pick mesh
+	int32_t bvhProxy{ DynamicAabbTree::NULL_NODE };  // leaf in SceneGraph::bvh, if the node has bounds
+
+	// Interned, so the string lives in node_names() rather than in every node
+	const std::string& name() const { return node_names().str(nameSymbol); }
+	NameSymbol name_symbol() const { return nameSymbol; }
+
+private:
+	friend class SceneGraph;
+	NameSymbol nameSymbol{ EMPTY_NAME };  // written by SceneGraph::set_name only, to keep the name index current
 };
 
 glm::mat4 transformation_matrix(const Node& node);
 
+using NodeHandle = PoolHandle;
+using NodePool = ChunkedPool<Node>;
+
+// Nodes created by one SceneGraph::create_nodes call, with consecutive nodeIds
+struct NodeRange {
+	uint32_t first{ 0 };
+	uint32_t count{ 0 };
+
+	uint32_t id(size_t i) const { return first + static_cast<uint32_t>(i); }
+};
+
 class SceneGraph {
+	/*
+	 * Nodes and the links between them. Methods that change the structure (creating,
+	 * linking, destroying and naming nodes) lock the graph, so several loader threads can
+	 * build subtrees at once.
+	 *
+	 * Reading the structure does not lock: a node's children and parent, root and iteration
+	 * over nodes. Such reads are only safe on a thread that is itself writing, inside
+	 * read_structure, or after loading finished. SceneState::initialized marks that for the
+	 * GUI, and VkRenderer::sceneReadyToRender for the frame path.
+	 */
 public:
 	Node* root{ nullptr };
-	std::vector<Node> nodes;
-	std::vector<AABB> bvh;
+	// Stable storage: Node references and Node* links stay valid as the graph grows
+	NodePool nodes;
+	// World bounds of nodes with local bounds, kept current by update_world_bounds.
+	// Owned by the render thread.
+	DynamicAabbTree bvh;
 	std::vector<Camera> cameras;
 
 	Node& create_node() {
 		std::lock_guard lock(mut);
-		auto& node = nodes.emplace_back();
-		node.nodeId = nodes.size() - 1;
+		const auto nodeId = nodes.allocate();
+		auto& node = nodes[nodeId];
+		node.nodeId = nodeId;
+		structureVersion.fetch_add(1, std::memory_order_release);
 		return node;
 	}
 
+	// Parent entry for create_nodes: attach to the batch's attachment point
+	static constexpr uint32_t BATCH_ROOT = UINT32_MAX;
+
+	// Creates batchParents.size() nodes under a single lock, for loaders. The lock only
+	// orders writers, see the class comment for readers. batchParents[i]
+	// is the position within the batch of node i's parent, or BATCH_ROOT to attach node i
+	// to attachTo (left detached if attachTo is null). Children are linked in batch order.
+	NodeRange create_nodes(std::span<const uint32_t> batchParents, Node* attachTo = nullptr);
+
+	// Creates count sibling nodes under attachTo
+	NodeRange create_nodes(size_t count, Node* attachTo = nullptr);
+
+	// Handles detect a node that was destroyed, even if its nodeId was reused since
+	NodeHandle handle_of(const Node& node) const {
+		return nodes.handle_of(node.nodeId);
+	}
+
+	Node* try_get(const NodeHandle& handle) {
+		return nodes.get(handle);
+	}
+
+	// Attaches child under parent, detaching it from its previous parent first
+	void add_child(Node& parent, Node& child) {
+		std::lock_guard lock(mut);
+		if (child.parent)
+		{
+			std::erase(child.parent->children, &child);
+		}
+		parent.children.push_back(&child);
+		child.parent = &parent;
+		structureVersion.fetch_add(1, std::memory_order_release);
+	}
+
+	// Detaches node from its parent and releases it and all of its descendants back to the
+	// pool, so their nodeIds are handed out again by create_node. onDestroy is called for
+	// every node, parents before children, after the subtree is detached and before its
+	// nodeIds are released. It runs without the graph lock, so it may call SceneGraph
+	// methods, but must not link new nodes into the subtree.
+	void destroy_subtree(Node& node, const std::function<void(Node&)>& onDestroy = {});
+
+	// Renames node and updates the name index
+	void set_name(Node& node, std::string_view name);
+
+	// Names every node of range in one critical section; names[i] goes to range.id(i)
+	void set_names(const NodeRange& range, std::span<const std::string> names);
+
+	// Lowest nodeId with this name, or nullptr. O(1) apart from hashing name once.
+	Node* find_by_name(std::string_view name) const;
+
+	// Call after writing translation, rotation or scale so the world matrices of the
+	// node and its subtree are recomputed on the next transform update
+	void mark_transform_dirty(const Node& node) {
+		std::lock_guard lock(mut);
+		dirtyTransforms.push_back(node.nodeId);
+	}
+
+	// Moves the pending dirty nodeIds into out, leaving the graph's list empty
+	void take_dirty_transforms(std::vector<uint32_t>& out) {
+		out.clear();
+		std::lock_guard lock(mut);
+		out.swap(dirtyTransforms);
+	}
+
+	// Runs read with the graph locked, so loader threads cannot create, link or destroy
+	// nodes while it walks children or iterates nodes. read must not call back into
+	// SceneGraph methods that lock.
+	template<typename Read>
+	decltype(auto) read_structure(Read&& read) const {
+		std::lock_guard lock(mut);
+		return read();
+	}
+
+	// Incremented on every change to node count or parent-child links
+	uint64_t structure_version() const {
+		return structureVersion.load(std::memory_order_acquire);
+	}
+
 private:
-	std::mutex mut;
+	mutable std::mutex mut;
+	std::atomic<uint64_t> structureVersion{ 0 };
+	std::vector<uint32_t> dirtyTransforms;
+	// Named nodes only, each list sorted by nodeId
+	std::unordered_map<NameSymbol, std::vector<uint32_t>> nodesByName;
+
+	// Callers hold mut
+	void unindex_name(const Node& node);
+	void index_name(Node& node, NameSymbol symbol);
 };
 
 Node& get_node_by_id(SceneGraph& sceneGraph, const size_t nodeId);
@@ -90,25 +221,66 @@ struct SceneState {
 	SceneGraph graph;
 	size_t activeCameraNodeIdx;
 	int activeNodeIdx{ 0 };
-	uint32_t selectedWorldFace{ 0 };
+	uint32_t selectedWorldFace{ 0 };           // planet tile last clicked
+	std::optional<uint32_t> hoveredWorldFace;  // planet tile under the cursor
+	PlanetTileIndex worldTiles;  // faceId lookup in the model space of worldTilesNode
+	NodeHandle worldTilesNode;
 
 	double cursor_x;
 	double cursor_y;
 	std::vector<glm::mat4> modelMatrices;
-	std::vector<AABB> aabbs;
+	std::vector<AABB> aabbs;  // local (model space) bounds by nodeId, empty for nodes without geometry
+	std::vector<Sphere> boundingSpheres;  // local bounding spheres by nodeId, radius 0 without geometry
+	std::vector<std::shared_ptr<const TriangleBvh>> pickMeshes;  // model space triangles by nodeId, for picking
+	std::optional<uint32_t> hoveredNodeId;  // selectable node under the cursor
+	TransformHierarchy transforms;
+
+	// World bounds by nodeId, of each node and of its whole subtree, kept current by update_world_bounds
+	CullingBounds cullingBounds;
+	SubtreeBounds subtreeBounds;
+
+	// Frustum and occlusion culling output, rebuilt every frame by cull_scene
+	std::vector<uint32_t> visibleNodeIds;
+	CullStats cullStats;
+	OcclusionBuffer occlusion;
+
+	// Levels of detail by nodeId, empty for nodes with a single DrawData
+	std::vector<LodGroup> lods;
+	// By nodeId, nodes without a LOD group dropped by the contribution cutoff last frame
+	std::vector<uint8_t> belowCutoff;
+	LodSettings lodSettings;
+	LodStats lodStats;
 
 	std::mt19937 randomizer;
 	std::chrono::steady_clock::time_point previousPredictionTime;
-	bool initialized{ false };
+	std::atomic<bool> initialized{ false };  // loading finished, the graph may be read without locking
 
 	~SceneState() {
 		modelMatrices.clear();
 		aabbs.clear();
+		boundingSpheres.clear();
+		pickMeshes.clear();
 	}
 };
 
 Camera* get_active_camera(const SceneState& sceneState);
-Node* find_node_by_name(const SceneGraph& graph, const std::string& name);
+
+// Moves the BVH proxies of nodes whose model matrix changed in ranges, creating proxies for
+// nodes that gained local bounds and removing those of nodes that lost them, and refits the
+// subtree bounds of those nodes and their ancestors
+void update_world_bounds(SceneState& sceneState, std::span<const MatrixRange> ranges);
+
+// Fills visibleNodeIds, in preorder, with the nodes whose world bounds intersect the view
+// frustum and, when the scene has occluder nodes in view, are not hidden behind them.
+// Subtrees whose merged bounds are outside the frustum are rejected as a whole.
+// Otherwise nodes without bounds and occluders themselves are always kept.
+void cull_scene(SceneState& sceneState, const glm::mat4& viewProjection);
+
+// Run after cull_scene. Points the draw_data_idx of every visible node with a LOD group at
+// the level matching its projected bounding sphere, and drops visible nodes below the
+// contribution cutoff of lodSettings.
+void select_lods(SceneState& sceneState, const glm::mat4& view, const glm::mat4& projection);
+Node* find_node_by_name(const SceneGraph& graph, std::string_view name);
 
 } // end namespace
 #endif
@@ -0,0 +1,118 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#define GLM_FORCE_RADIANS
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+#include "scene/PreorderIndex.hpp"
+
+class ThreadPool;
+
+namespace ENG
+{
+
+class SceneGraph;
+
+// Hierarchies smaller than this are always updated on the calling thread
+constexpr size_t PARALLEL_TRANSFORM_THRESHOLD = 4096;
+// Target number of slots per parallel task
+constexpr size_t PARALLEL_TRANSFORM_GRAIN = 1024;
+
+struct TRS {
+	glm::vec3 translation{ 0.f };
+	glm::quat rotation{ 1.f, 0.f, 0.f, 0.f };
+	glm::vec3 scale{ 1.f };
+};
+
+// Contiguous run of model matrices, indexed by nodeId
+struct MatrixRange {
+	uint32_t first{ 0 };
+	uint32_t count{ 0 };
+};
+
+// Sorts ranges and merges any that overlap or touch
+void merge_matrix_ranges(std::vector<MatrixRange>& ranges);
+
+// Local transform matrix, composed as T * R * S
+glm::mat4 compose_trs(const TRS& trs);
+
+class TransformHierarchy {
+	/*
+	 * Flat, parent-sorted view of the scene graph used for world matrix propagation.
+	 *
+	 * Slots come from a PreorderIndex, so every parent occupies a lower slot than its
+	 * children. World matrices are then produced with a single forward pass over
+	 * contiguous arrays instead of walking Node* children vectors.
+	 *
+	 * The slot layout is rebuilt only when the graph's structure version changes.
+	 * Each slot also records the end of its subtree, so a dirty node can be propagated
+	 * by recomputing the contiguous slot range [slot, subtreeEnd) and nothing else.
+	 *
+	 * With a thread pool attached, large ranges are split into independent tasks. Nodes whose
+	 * subtree exceeds the grain form a "spine" that is computed serially first; everything
+	 * below the spine is grouped into contiguous runs of sibling subtrees, each of which
+	 * only depends on spine nodes and can be computed on any worker. Every slot is produced
+	 * by the same arithmetic regardless of thread count, so the result is deterministic.
+	 */
+public:
+	static constexpr uint32_t NO_PARENT = PreorderIndex::NO_SLOT;
+
+	// Rebuilds the slot layout if the graph structure changed since the last build.
+	// Safe to call outside update(), e.g. to iterate preorder(); the next update() still
+	// does the full pass for the new layout.
+	bool sync_structure(const SceneGraph& graph);
+	void rebuild(const SceneGraph& graph);
+
+	// Copies local TRS from the graph nodes into the slot-ordered local array
+	void gather_local_transforms(const SceneGraph& graph);
+
+	// Computes world matrices for all slots and scatters them into modelMatrices by nodeId
+	void update_world_matrices(std::vector<glm::mat4>& modelMatrices);
+
+	// Incremental update: consumes the graph's dirty transforms and recomputes only the
+	// affected subtrees. Falls back to a full update when the structure changed.
+	// Appends the modelMatrices ranges that were written to changedRanges.
+	void update(SceneGraph& graph, std::vector<glm::mat4>& modelMatrices, std::vector<MatrixRange>& changedRanges);
+
+	// Enables the parallel path; pass nullptr to update on the calling thread only
+	void set_thread_pool(ThreadPool* threadPool) { pool = threadPool; }
+	void set_parallel_policy(size_t threshold, size_t grain);
+
+	// Slot layout, valid as of the last sync_structure
+	const PreorderIndex& preorder() const { return order; }
+
+	size_t size() const { return order.size(); }
+	const std::vector<uint32_t>& node_ids() const { return order.node_ids(); }
+	const std::vector<uint32_t>& parent_slots() const { return order.parent_slots(); }
+	const std::vector<uint32_t>& subtree_ends() const { return order.subtree_ends(); }
+	const std::vector<TRS>& local_transforms() const { return locals; }
+	const std::vector<glm::mat4>& world_matrices() const { return worldMatrices; }
+
+private:
+	PreorderIndex order;
+	std::vector<TRS> locals;
+	std::vector<glm::mat4> localMatrices;
+	std::vector<glm::mat4> worldMatrices;
+	bool fullUpdatePending{ false };  // layout changed since the last update()
+
+	// Parallel partition, rebuilt with the slot layout
+	ThreadPool* pool{ nullptr };
+	size_t parallelThreshold{ PARALLEL_TRANSFORM_THRESHOLD };
+	size_t parallelGrain{ PARALLEL_TRANSFORM_GRAIN };
+	std::vector<uint32_t> spineSlots;          // ascending
+	std::vector<MatrixRange> parallelTasks;    // slot ranges, ascending by first
+
+	// Scratch buffers reused across incremental updates
+	std::vector<uint32_t> dirtyScratch;
+	std::vector<uint32_t> changedScratch;
+
+	void gather_local_transforms(const SceneGraph& graph, uint32_t beginSlot, uint32_t endSlot);
+	void update_world_matrices(std::vector<glm::mat4>& modelMatrices, uint32_t beginSlot, uint32_t endSlot);
+	void update_subtree(std::vector<glm::mat4>& modelMatrices, uint32_t slot);
+	void build_parallel_partition();
+	void resize_to_layout();
+};
+
+} // end namespace
@@ -0,0 +1,18 @@
+#pragma once
+#include <cstddef>
+
+#include "scene/Transform.hpp"
+#include "scene/CpuFeatures.hpp"
+
+namespace ENG
+{
+
+// Converts count TRS triples into column-major T * R * S matrices.
+// Dispatches to the widest SIMD path the CPU supports; out must not alias trs.
+void compose_trs_batch(const TRS* trs, glm::mat4* out, size_t count);
+
+// Same as above with an explicit code path, used by tests and benchmarks.
+// Requesting a level the CPU does not support is undefined behaviour.
+void compose_trs_batch(const TRS* trs, glm::mat4* out, size_t count, SimdLevel level);
+
+} // end namespace
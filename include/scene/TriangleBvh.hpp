@@ -0,0 +1,113 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "scene/Bounds.hpp"
+
+namespace ENG
+{
+
+// Leaves are split until they hold at most this many triangles
+constexpr uint32_t TRIANGLE_BVH_MAX_LEAF_SIZE = 4;
+
+struct TriangleHit {
+	uint32_t triangleId{ 0 };  // index of the triangle in the source index buffer / 3
+	float t{ 0.f };            // ray parameter of the hit
+	float u{ 0.f };            // barycentric weight of the second vertex
+	float v{ 0.f };            // barycentric weight of the third vertex
+};
+
+class TriangleBvh {
+	/*
+	 * Static bounding volume hierarchy over the triangles of one mesh, in model space, for
+	 * picking and other ray queries against CPU-side geometry.
+	 *
+	 * Built once (binned surface area heuristic) from the same vertex and index data that is
+	 * uploaded to the GPU, usually on a loader thread. Triangles are copied into leaf order
+	 * as a vertex and two edges, so ray tests read them sequentially and the source buffers
+	 * need not be kept.
+	 *
+	 * Immutable after construction; queries may run from any number of threads.
+	 */
+public:
+	TriangleBvh() = default;
+
+	// positions: vertexCount points read as three floats every stride bytes.
+	// indices: a triangle list; when empty, every three consecutive vertices form a triangle.
+	// Throws std::runtime_error for indices outside the vertex range.
+	TriangleBvh(const float* positions, size_t vertexCount, size_t stride, std::span<const uint32_t> indices);
+
+	// Closest hit with t in [0, ray.maxT], both faces. Returns false on a miss.
+	bool intersect(const Ray& ray, TriangleHit& hit) const;
+
+	struct Triangle {
+		glm::vec3 v0;
+		glm::vec3 edge1;
+		glm::vec3 edge2;
+	};
+
+	// Calls fn(first, count) for the triangle range of every leaf whose box passes test(box),
+	// for callers with their own ray representation, such as packets. Triangles are read
+	// with triangle(i) and mapped back to the source with triangle_id(i).
+	template<typename Test, typename Fn>
+	void for_each_leaf(const Test& test, Fn&& fn) const
+	{
+		if (nodes.empty()) return;
+
+		// SAH trees over real meshes stay far shallower than the inline stack
+		std::array<uint32_t, 64> stack;
+		std::vector<uint32_t> overflow;
+		size_t depth = 0;
+		const auto push = [&](uint32_t id) {
+			if (depth < stack.size()) stack[depth] = id;
+			else overflow.push_back(id);
+			++depth;
+		};
+
+		push(0);
+		while (depth > 0)
+		{
+			--depth;
+			uint32_t id;
+			if (depth < stack.size()) id = stack[depth];
+			else { id = overflow.back(); overflow.pop_back(); }
+
+			const auto& node = nodes[id];
+			if (!test(node.box)) continue;
+
+			if (node.count > 0)
+			{
+				fn(node.first, node.count);
+			}
+			else
+			{
+				push(node.first + 1);
+				push(node.first);
+			}
+		}
+	}
+
+	const Triangle& triangle(uint32_t i) const { return triangles[i]; }
+	uint32_t triangle_id(uint32_t i) const { return triangleIds[i]; }
+
+	size_t triangle_count() const { return triangleIds.size(); }
+	size_t node_count() const { return nodes.size(); }
+	AABB bounds() const { return nodes.empty() ? AABB{} : nodes.front().box; }
+
+private:
+	struct BuildNode {
+		AABB box;
+		uint32_t first{ 0 };  // first triangle for leaves, left child for inner nodes
+		uint32_t count{ 0 };  // 0 for inner nodes; the right child is first + 1
+	};
+
+	std::vector<BuildNode> nodes;
+	std::vector<Triangle> triangles;  // in leaf order
+	std::vector<uint32_t> triangleIds;  // source triangle of each entry in triangles
+
+	void subdivide(uint32_t rootId, std::vector<AABB>& boxes, std::vector<glm::vec3>& centroids);
+};
+
+} // end namespace
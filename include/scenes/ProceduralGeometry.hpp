@@ -24,7 +24,8 @@ pmp::SurfaceMesh create_tetrahedron();
 pmp::SurfaceMesh create_hexahedron();
 pmp::SurfaceMesh create_icosahedron();
 pmp::SurfaceMesh create_dodecahedron();
+// Binds mesh to pmpNode, which the caller has already created and attached
 void load_pmp_mesh(
-	ENG::Node& parent, const pmp::SurfaceMesh& mesh, const std::string& mesh_name, const std::string& node_name, const glm::vec4& color,
-	VkAdapter& adapter, SceneState& sceneState, ConcurrentQueue<GraphicsEvent>& graphicsEventQueue);
+	ENG::Node& pmpNode, const pmp::SurfaceMesh& mesh, const std::string& mesh_name, const glm::vec4& color,
+	VkAdapter& adapter, SceneState& sceneState, MpscQueue<GraphicsEvent>& graphicsEventQueue);
 void triangulate_as_triangle_fan_preserving_face_ids(pmp::SurfaceMesh& mesh, const std::vector<glm::vec4>& faceColors, VkAdapter& adapter, SceneState& sceneState);
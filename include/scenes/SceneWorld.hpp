@@ -1,11 +1,12 @@
 #pragma once
 #include "scenes/ProceduralGeometry.hpp"
-#include "application/ConcurrentQueue.hpp"
+#include "application/MpscQueue.hpp"
 #include "renderer/vk/Renderer.hpp"
 #include "renderer/vk_adapter/VkAdapter.hpp"
 
 void create_world_polyhedra(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState);
 void addBoundingBoxChild(ENG::Node* node, VkRenderer& app, const std::string &bbName, SceneState& sceneState);
-void create_tetrahedron_no_pmp(SceneState& sceneState, ConcurrentQueue<BindHostMeshDataEvent>& meshBindQueue);
+void create_tetrahedron_no_pmp(SceneState& sceneState, MpscQueue<GraphicsEvent>& graphicsEventQueue, const std::string& nodeName);
 void init_for_vulkan(VkAdapter& adapter, SceneState& sceneState);
 void initializeWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState);
+void unloadWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState);
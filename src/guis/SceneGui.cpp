@@ -7,7 +7,6 @@
 #include "scene/Scene.hpp"
 #include "logger/Logging.hpp"
 #include "guis/SceneGui.hpp"
-#include "scene/DFT.hpp"
 
 
 void SceneGui::MySaveFunction()
@@ -15,26 +14,29 @@ void SceneGui::MySaveFunction()
 	ENG_LOG_DEBUG("Save function call" << std::endl);
 }
 
-void SceneGui::DrawNodeTree(ENG::Node* node) 
+void SceneGui::DrawNodeTree(ENG::SceneState& sceneState, ENG::Node* node) 
 {
-	if (ImGui::TreeNode(node->name.c_str())) {
+	auto& graph = sceneState.graph;
+	if (ImGui::TreeNode(node->name().c_str())) {
 		ImGui::Text("Properties");
 
 		if (ImGui::Checkbox("Visible", &node->visible)) {
 			ENG_LOG_DEBUG("Visible checked" << std::endl);
 
-			// Set visibility of all children
-			for (auto* child : DFTraversal(node))
+			// Set visibility of all children; a subtree is one contiguous slice of the preorder
+			sceneState.transforms.sync_structure(graph);
+			for (const auto childId : sceneState.transforms.preorder().subtree(node->nodeId))
 			{
-				child->visible = node->visible;
+				graph.nodes[childId].visible = node->visible;
 			}
 		}
 
-		ImGui::SliderFloat4("Rotation", &(node->rotation.x), 0.f, 3.1f);
-		ImGui::SliderFloat3("Location", &(node->translation.x), 0.f, 3.1f);
+		bool transformChanged = ImGui::SliderFloat4("Rotation", &(node->rotation.x), 0.f, 3.1f);
+		transformChanged |= ImGui::SliderFloat3("Location", &(node->translation.x), 0.f, 3.1f);
+		if (transformChanged) graph.mark_transform_dirty(*node);
 
 		for (const auto& child : node->children) {
-			DrawNodeTree(child); // Recursively draw children
+			DrawNodeTree(sceneState, child); // Recursively draw children
 		}
 		ImGui::TreePop();
 	}
@@ -61,6 +63,19 @@ void SceneGui::drawGui(ENG::SceneState& sceneState)
 		ImGui::Begin("DebugTools");
 		ImGui::Text("Camera settings");
 		if (ImGui::Button("Save")) MySaveFunction();
+		// Loaders create and link nodes until the scene is initialized, the graph is read after that
+		if (!sceneState.initialized)
+		{
+			ImGui::Text("Loading scene...");
+			ImGui::End();
+			return;
+		}
+		if (!sceneState.graph.nodes.is_alive(static_cast<uint32_t>(sceneState.activeCameraNodeIdx)))
+		{
+			ImGui::Text("No scene loaded");
+			ImGui::End();
+			return;
+		}
 		auto& cameraNode = sceneState.graph.nodes.at(sceneState.activeCameraNodeIdx);
 		auto* camera = dynamic_cast<ENG::Camera*>(cameraNode.camera);
 
@@ -72,19 +87,35 @@ void SceneGui::drawGui(ENG::SceneState& sceneState)
 		ImGui::SliderFloat("Fovy", &(camera->fovy), 0.0f, 1.0f);
 		ImGui::SliderFloat("zfar", &(camera->zfar), 0.0f, 100.0f);
 		ImGui::SliderFloat("znear", &(camera->znear), 0.0f, 10.0f);
-		ImGui::InputFloat3("Camera position", &cameraNode.translation.x);
-		ImGui::InputFloat3("Camera rotation", &cameraNode.rotation.x);
+		bool cameraMoved = ImGui::InputFloat3("Camera position", &cameraNode.translation.x);
+		cameraMoved |= ImGui::InputFloat3("Camera rotation", &cameraNode.rotation.x);
+		if (cameraMoved) sceneState.graph.mark_transform_dirty(cameraNode);
 		
+		const auto& cullStats = sceneState.cullStats;
+		ImGui::Text("Frustum culling: %u visible, %u culled, %u occluded, %u boxes tested", cullStats.visible, cullStats.culled, cullStats.occluded, cullStats.tested);
+		const auto& lodStats = sceneState.lodStats;
+		ImGui::Text("LOD: %u nodes, %u switched, %u below the size cutoff", lodStats.selected, lodStats.switched, lodStats.culled);
+		if (sceneState.hoveredWorldFace.has_value())
+		{
+			ImGui::Text("Planet tile: %u hovered, %u selected", *sceneState.hoveredWorldFace, sceneState.selectedWorldFace);
+		}
+		else
+		{
+			ImGui::Text("Planet tile: %u selected", sceneState.selectedWorldFace);
+		}
+
 		ImGui::Text("IDX: Name");
 		for (auto& node : sceneState.graph.nodes) {
-			ImGui::Text("%d: %s", node.nodeId, node.name.c_str());
+			ImGui::Text("%d: %s", node.nodeId, node.name().c_str());
 		}
-		DrawNodeTree(sceneState.graph.root);
+		if (sceneState.graph.root) DrawNodeTree(sceneState, sceneState.graph.root);
 		ImGui::InputInt("Active: ", &sceneState.activeNodeIdx);
-		if (sceneState.activeNodeIdx < sceneState.graph.nodes.size())
+		if (sceneState.graph.nodes.is_alive(static_cast<uint32_t>(sceneState.activeNodeIdx)))
 		{
-			ImGui::SliderFloat4("Active Node Rotation", &(sceneState.graph.nodes.at(sceneState.activeNodeIdx).rotation.x), 0.f, 3.1f);
-			ImGui::SliderFloat3("Active Node Location", &(sceneState.graph.nodes.at(sceneState.activeNodeIdx).translation.x), 0.f, 3.1f);
+			auto& activeNode = sceneState.graph.nodes.at(sceneState.activeNodeIdx);
+			bool activeNodeMoved = ImGui::SliderFloat4("Active Node Rotation", &(activeNode.rotation.x), 0.f, 3.1f);
+			activeNodeMoved |= ImGui::SliderFloat3("Active Node Location", &(activeNode.translation.x), 0.f, 3.1f);
+			if (activeNodeMoved) sceneState.graph.mark_transform_dirty(activeNode);
 		}
 		ImGui::End();
 	}
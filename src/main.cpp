@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <array>
 #include <thread>
 #include <functional>
 
@@ -19,17 +20,19 @@
 
 #include "nlohmann/json.hpp"
 #include "glm/gtc/type_ptr.hpp"
+#include "imgui.h"
 
 #include "renderer/vk/Renderer.hpp"
 #include "renderer/vk_adapter/VkAdapter.hpp"
 #include "logger/Logging.hpp"
 #include "sockets/SocketSessionServer.h"
 #include "scenes/SceneWorld.hpp"
+#include "scene/Picking.hpp"
 #include "hid/Input.hpp"
 #include "application/Application.hpp"
+#include "application/ThreadPool.hpp"
 #include "guis/SceneGui.hpp"
 #include "gui/Gui.hpp"
-#include "scene/DFT.hpp"
 #include "events/Event.hpp"
 
 #include "lua.hpp"
@@ -223,78 +226,22 @@ UniformBufferObject createUniformBufferObject(const SceneState& sceneState)
 }
 
 
-AABB findExtremaVertices(std::vector<VertexPosNorCol>& verts) {
-	const auto& minXIt = std::min_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.x < lhs.pos.x);
-	});
-	const auto& minYIt = std::min_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.y < lhs.pos.y);
-	});
-	const auto& minZIt = std::min_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.z < lhs.pos.z);
-	});
-	const auto& maxXIt = std::max_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.x < lhs.pos.x);
-	});
-	const auto& maxYIt = std::max_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.y < lhs.pos.y);
-	});
-	const auto& maxZIt = std::max_element(verts.begin(), verts.end(), [](const VertexPosNorCol& rhs, const VertexPosNorCol& lhs) {
-		return (rhs.pos.z < lhs.pos.z);
-	});
-
-	const auto& maxX = maxXIt->pos.x;
-	const auto& maxY = maxYIt->pos.y;
-	const auto& maxZ = maxZIt->pos.z;
-	const auto& minX = minXIt->pos.x;
-	const auto& minY = minYIt->pos.y;
-	const auto& minZ = minZIt->pos.z;
-
-	const AABB& aabb{
-		{minX, minY, minZ, 1},
-		{maxX, maxY, maxZ, 1}
-	};
-
-	return aabb;
-}
-
-void updateModelMatrix(glm::mat4& modelMatrix, const ENG::Node& node)
+void updateModelMatrices(SceneState& sceneState, std::vector<ENG::MatrixRange>& changedRanges)
 {
-	// Compute local transform from TRS data
-	modelMatrix = glm::translate(glm::mat4(1.f), node.translation)
-		* glm::mat4_cast(node.rotation)
-		* glm::scale(glm::mat4(1.f), node.scale);
-}
-
-void updateModelMatrices(SceneState& sceneState)
-{
-	// Compute local transforms first from TRS data
-	for (const auto& node : sceneState.graph.nodes)
-	{
-		assert(node.nodeId < sceneState.modelMatrices.size());
-		updateModelMatrix(sceneState.modelMatrices.at(node.nodeId), node);
-	}
-
-	// Update to global transforms by depth-first traversal of the graph
-	for (auto* node : DFTraversal(sceneState.graph.root))
-	{
-		if (node == sceneState.graph.root)
-		{
-			continue;  // Do not need to do any update on root node
-		}
-
-		// Global transform is computed as the transform of local transform by parents global transform
-		// Depth-first traversal guarantees parent global transform is computed before child is visited
-		assert(node != nullptr && node->nodeId < sceneState.modelMatrices.size());
-		assert(node->parent != nullptr && node->parent->nodeId < sceneState.modelMatrices.size());
-		sceneState.modelMatrices.at(node->nodeId) = sceneState.modelMatrices.at(node->parent->nodeId) * sceneState.modelMatrices.at(node->nodeId);
-		ENG_LOG_TRACE("TRAVERSING NAME: " << node->name << std::endl);
-	}
+	// Global transform is the parents global transform applied to the local TRS.
+	// Only subtrees of nodes marked with mark_transform_dirty are recomputed, unless nodes
+	// were added or re-parented, in which case the flat preorder layout is rebuilt.
+	const auto firstNewRange = changedRanges.size();
+	sceneState.transforms.update(sceneState.graph, sceneState.modelMatrices, changedRanges);
+	ENG_LOG_TRACE("Model matrix ranges changed: " << changedRanges.size() << std::endl);
+
+	// Refit the BVH only for the matrices written this frame
+	update_world_bounds(sceneState, std::span<const ENG::MatrixRange>(changedRanges).subspan(firstNewRange));
 }
 
 void handleNodeRotationPreserveYAsUpAction(const ClientHidEvent& hidEvent, SceneState& sceneState)
 {
-	if (sceneState.activeNodeIdx >= sceneState.graph.nodes.size())
+	if (!sceneState.graph.nodes.is_alive(static_cast<uint32_t>(sceneState.activeNodeIdx)))
 	{
 		ENG_LOG_ERROR("Active node idx is invalid!" << std::endl);
 		return;
@@ -302,6 +249,7 @@ void handleNodeRotationPreserveYAsUpAction(const ClientHidEvent& hidEvent, Scene
 	auto& activeNode = sceneState.graph.nodes.at(sceneState.activeNodeIdx);
 
 	node_rotation_follows_input_preserve_y_as_up(activeNode, hidEvent.look_dx, hidEvent.look_dy);
+	sceneState.graph.mark_transform_dirty(activeNode);
 }
 
 void handleHidEvent(const ClientHidEvent& hidEvent, SceneState& sceneState)
@@ -315,74 +263,76 @@ void handleHidEvent(const ClientHidEvent& hidEvent, SceneState& sceneState)
 	}
 }
 
-void castRayForMouseHoverOnNode(const ENG::Node& node, const SceneState& sceneState, const glm::vec3& rayOrigin, const glm::vec3& rayDir)
+// Inputs of the last hover pick. Picking walks the scene BVH and the triangles of the hit
+// mesh, so frames where neither the cursor nor the camera moved keep its result.
+struct HoverPickInputs {
+	glm::vec2 cursorNdc{ 0.f };
+	glm::mat4 viewProjection{ 0.f };
+};
+
+void updateMouseHover(const WindowUserData& windowUserData, SceneState& sceneState, const UniformBufferObject& ubo,
+	std::optional<HoverPickInputs>& lastPick)
 {
-	static std::vector<bool> nodeHoverMap(sceneState.graph.nodes.size(), false);
-	if (node.nodeId >= nodeHoverMap.size())
+	if (windowUserData.windowWidthScreenCoords <= 0 || windowUserData.windowHeightScreenCoords <= 0)
 	{
-		ENG_LOG_DEBUG("nodeHoverMap too small" << std::endl);
 		return;
 	}
 
-	const auto& boundingSphereCenter = glm::vec3(sceneState.modelMatrices.at(node.nodeId)[3]); // location
-	const auto& boundingSphereRadius = 1.f;  // from generation algorithm
-
-	const auto& rayOriginToSphereCenter = boundingSphereCenter - rayOrigin;
-	const auto& dotProduct = glm::dot(rayOriginToSphereCenter, rayDir);
+	// Normalized device coordinates, -1,-1 top-left to 1,1 bottom-right, since the projection's y axis is flipped for Vulkan
+	const glm::vec2 cursorNdc{
+		(2.f * windowUserData.cursorXScreenCoords) / windowUserData.windowWidthScreenCoords - 1.f,
+		(2.f * windowUserData.cursorYScreenCoords) / windowUserData.windowHeightScreenCoords - 1.f
+	};
 
-	if (dotProduct < 0)
+	const auto viewProjection = ubo.proj * ubo.view;
+	if (lastPick.has_value() && lastPick->cursorNdc == cursorNdc && lastPick->viewProjection == viewProjection)
 	{
-		ENG_LOG_DEBUG(node.name << " is behind the camera!" << std::endl);
 		return;
 	}
+	lastPick = HoverPickInputs{ cursorNdc, viewProjection };
 
-	// standard distance formula for shortest distance from point to line
-	const auto& crossProduct = glm::cross(rayOriginToSphereCenter, rayDir);
-	const auto& distance = glm::length(crossProduct) / glm::length(rayDir);
+	const auto ray = cursor_ray(ubo.view, ubo.proj, cursorNdc);
 
-	if (distance < 1.f && !nodeHoverMap.at(node.nodeId))
+	// The planet resolves its tile directly, without testing the tile meshes
+	sceneState.hoveredWorldFace.reset();
+	if (const auto* planet = sceneState.graph.try_get(sceneState.worldTilesNode))
 	{
-		nodeHoverMap.at(node.nodeId) = true;
-		ENG_LOG_DEBUG("Cursor is on " << node.name << std::endl);
+		const auto toModel = glm::inverse(sceneState.modelMatrices.at(planet->nodeId));
+		Ray modelRay = ray;
+		modelRay.origin = glm::vec3(toModel * glm::vec4(ray.origin, 1.f));
+		modelRay.direction = glm::vec3(toModel * glm::vec4(ray.direction, 0.f));
+		sceneState.hoveredWorldFace = sceneState.worldTiles.pick(modelRay);
 	}
-	else if (distance > 1.f && nodeHoverMap.at(node.nodeId))
+
+	const auto hit = pick(sceneState, ray);
+	const auto hoveredNodeId = hit.has_value() ? std::optional<uint32_t>(hit->nodeId) : std::nullopt;
+	if (hoveredNodeId == sceneState.hoveredNodeId)
 	{
-		nodeHoverMap.at(node.nodeId) = false;
-		ENG_LOG_DEBUG("Cursor is not on " << node.name << std::endl);
+		return;
+	}
+
+	sceneState.hoveredNodeId = hoveredNodeId;
+	if (hit.has_value())
+	{
+		ENG_LOG_DEBUG("Cursor is on " << sceneState.graph.nodes[hit->nodeId].name() << " triangle " << hit->triangleId
+			<< " at distance " << hit->distance << std::endl);
 	}
 }
 
-void castRayForMouseHover(const WindowUserData& windowUserData, const SceneState& sceneState, const UniformBufferObject& ubo)
+// A left click outside the GUI selects the planet tile under the cursor
+void updateSelection(WindowUserData& windowUserData, SceneState& sceneState)
 {
-	static bool cursorIsHoveringOnSphere = false;
-	const auto& m = ubo.model; // 4x4 matrix representing rotation, translation, scale
-	const auto& v = ubo.view;  // 4x4 matrix representing camera rotation, translation
-	const auto& p = ubo.proj;  // 4x4 matrix representing the camera lens projection
-
-	// "normalized device coordinates (NDC)" the coordinates centered around 0,0 on the screen ranging from -1,1 to 1,-1 top-left to bottom-right
-	const auto& mouseXNDC = (2.f * windowUserData.cursorXScreenCoords) / windowUserData.windowWidthScreenCoords - 1.0f;
-	const auto& mouseYNDC = 1.f - (2.f * windowUserData.cursorYScreenCoords) / (windowUserData.windowHeightScreenCoords);
-
-	// a vector of 4x4 model matrices representing the rotation, translation, and scale of each model in the scene, indexed by nodeId
-	const auto& modelMatrices = sceneState.modelMatrices;
-
-	// calculate ray origin and direction for ray function r(t) = origin + t * direction
-	glm::mat4 invVP = glm::inverse(p * v);
-	glm::vec4 screenPos = glm::vec4(mouseXNDC, mouseYNDC, -1.0f, 1.0f);  // near plane
-	glm::vec4 worldPos = invVP * screenPos;  // "un-project" mouse position
-	worldPos /= worldPos.w;
-
-	glm::vec3 rayOrigin = glm::vec3(glm::inverse(v)[3]); // Camera position
-	glm::vec3 rayDir = glm::normalize(glm::vec3(worldPos) - rayOrigin);
-
-	// iterate over visible nodes and check for hover
-	for (const auto& node : sceneState.graph.nodes)
+	if (!windowUserData.selectRequested)
 	{
-		if (node.selectable)
-		{
-			castRayForMouseHoverOnNode(node, sceneState, rayOrigin, rayDir);
-		}
+		return;
 	}
+	windowUserData.selectRequested = false;
+	if (ImGui::GetIO().WantCaptureMouse || !sceneState.hoveredWorldFace.has_value())
+	{
+		return;
+	}
+	sceneState.selectedWorldFace = *sceneState.hoveredWorldFace;
+	ENG_LOG_DEBUG("Selected planet tile " << sceneState.selectedWorldFace << std::endl);
 }
 
 void handleHIDEvents(std::deque<ClientHidEvent>& eventQueue, SceneState& sceneState) {
@@ -396,7 +346,26 @@ void handleHIDEvents(std::deque<ClientHidEvent>& eventQueue, SceneState& sceneSt
 
 void mesh_bind_event_handler(VkRenderer& renderer, SceneState& sceneState, VkAdapter& adapter, BindHostMeshDataEvent&& bindEvent) {
 	auto& hostMesh = bindEvent.meshData;
+	if (!sceneState.graph.nodes.is_alive(bindEvent.nodeId))
+	{
+		ENG_LOG_DEBUG("Dropping mesh for destroyed node " << bindEvent.nodeId << std::endl);
+		return;
+	}
 	auto& node = get_node_by_id(sceneState.graph, bindEvent.nodeId);
+	const auto nodeHandle = sceneState.graph.handle_of(node);
+
+	// A node draws either one plain DrawData or the levels of its LodGroup. Mixing them would
+	// leave draw data that select_lods never selects and destroyNodeSubtree never releases.
+	const bool hasLodGroup = bindEvent.nodeId < sceneState.lods.size() && !sceneState.lods[bindEvent.nodeId].empty();
+	const bool mixesLods = bindEvent.lodMinScreenSize.has_value()
+		? node.draw_data_idx.has_value() && !hasLodGroup
+		: hasLodGroup;
+	if (mixesLods)
+	{
+		ENG_LOG_ERROR("Dropping mesh for " << node.name() << ": a node is bound either with or without levels of detail, not both" << std::endl);
+		return;
+	}
+	const bool addsLodLevel = bindEvent.lodMinScreenSize.has_value() && hasLodGroup;
 
 	if (hostMesh.texturePath.has_value())
 	{
@@ -416,23 +385,64 @@ void mesh_bind_event_handler(VkRenderer& renderer, SceneState& sceneState, VkAda
 				std::move(hostMesh.vertexBuffer),
 				std::move(hostMesh.indexBuffer)
 			),
+			hostMesh.localBounds
 		}
 	);
 
-	//initializeBoundingBox(sceneState, node);
+	if (bindEvent.lodMinScreenSize.has_value())
+	{
+		if (bindEvent.nodeId >= sceneState.lods.size())
+		{
+			sceneState.lods.resize(bindEvent.nodeId + 1);
+		}
+		sceneState.lods[bindEvent.nodeId].add_level(drawIdx, bindEvent.lodMinScreenSize.value());
+	}
 
-	node.shaderId = bindEvent.meshData.shaderId;
-	node.draw_data_idx = drawIdx;
-	ENG_LOG_TRACE("Node: " << node.name << " DrawDataIndex: " << drawIdx << std::endl);
+	if (addsLodLevel)
+	{
+		// select_lods points draw_data_idx at this level when it is the right one
+		ENG_LOG_TRACE("Node: " << node.name() << " LOD DrawDataIndex: " << drawIdx << std::endl);
+	}
+	else
+	{
+		// Bounds were computed on the loader thread; refresh the node's world bounds through
+		// the transform update so culling and picking see them next frame
+		if (bindEvent.nodeId >= sceneState.aabbs.size())
+		{
+			sceneState.aabbs.resize(bindEvent.nodeId + 1);
+		}
+		if (bindEvent.nodeId >= sceneState.boundingSpheres.size())
+		{
+			sceneState.boundingSpheres.resize(bindEvent.nodeId + 1);
+		}
+		sceneState.aabbs[bindEvent.nodeId] = hostMesh.localBounds.box;
+		sceneState.boundingSpheres[bindEvent.nodeId] = hostMesh.localBounds.sphere;
+		if (bindEvent.nodeId >= sceneState.pickMeshes.size())
+		{
+			sceneState.pickMeshes.resize(bindEvent.nodeId + 1);
+		}
+		sceneState.pickMeshes[bindEvent.nodeId] = std::move(hostMesh.pickMesh);
+		sceneState.graph.mark_transform_dirty(node);
+
+		node.shaderId = bindEvent.meshData.shaderId;
+		node.draw_data_idx = drawIdx;
+		ENG_LOG_TRACE("Node: " << node.name() << " DrawDataIndex: " << drawIdx << std::endl);
+	}
 
 	adapter.graphicsEventQueue.push(
 		CommandCompletionEvent {
-			[&adapter, &node, drawIdx] {
+			[&adapter, &sceneState, nodeHandle, drawIdx] {
+				auto* nodePtr = sceneState.graph.try_get(nodeHandle);
+				if (nodePtr == nullptr)
+				{
+					return;  // node was destroyed and its draw data released before upload finished
+				}
+				auto& node = *nodePtr;
 				adapter.set_property(drawIdx, DrawDataProperties::INDEX_BUFFERS_INITIALIZED);
 				adapter.set_property(drawIdx, DrawDataProperties::VERTEX_BUFFERS_INITIALIZED);
 				adapter.createDescriptorSets(drawIdx, node);
 				adapter.set_property(drawIdx, DrawDataProperties::DESCRIPTOR_SETS_INITIALIZED);
-				ENG_LOG_TRACE("Created draw data for " << node.name << std::endl);
+				ENG_LOG_TRACE("Created draw data for " << node.name() << std::endl);
 			}
 		}
 	);
@@ -440,20 +450,25 @@ void mesh_bind_event_handler(VkRenderer& renderer, SceneState& sceneState, VkAda
 
 void handleGraphicsEvents(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState)
 {
-	while (!adapter.graphicsEventQueue.empty()) {
-		GraphicsEvent graphicsEvent{ adapter.graphicsEventQueue.pop() };
-		
-		if (std::holds_alternative<BindHostMeshDataEvent>(graphicsEvent))
-		{
-			mesh_bind_event_handler(renderer, sceneState, adapter, std::move(std::get<BindHostMeshDataEvent>(graphicsEvent)));
-		}
-		else if (std::holds_alternative<CommandRecorderEvent>(graphicsEvent))
-		{
-			adapter.command_recorder_event_handler(std::move(std::get<CommandRecorderEvent>(graphicsEvent)));
-		}
-		else if (std::holds_alternative<CommandCompletionEvent>(graphicsEvent))
-		{
-			std::get<CommandCompletionEvent>(graphicsEvent).commandCompletionHandler();
+	// Takes the events in batches, one atomic exchange per batch. Handlers may queue further
+	// events, e.g. mesh binds queue their completion, which the next batch picks up.
+	std::array<GraphicsEvent, 32> graphicsEvents{};
+	while (const size_t count = adapter.graphicsEventQueue.drain_into(graphicsEvents)) {
+		for (size_t i = 0; i < count; i++) {
+			GraphicsEvent& graphicsEvent = graphicsEvents[i];
+
+			if (std::holds_alternative<BindHostMeshDataEvent>(graphicsEvent))
+			{
+				mesh_bind_event_handler(renderer, sceneState, adapter, std::move(std::get<BindHostMeshDataEvent>(graphicsEvent)));
+			}
+			else if (std::holds_alternative<CommandRecorderEvent>(graphicsEvent))
+			{
+				adapter.command_recorder_event_handler(std::move(std::get<CommandRecorderEvent>(graphicsEvent)));
+			}
+			else if (std::holds_alternative<CommandCompletionEvent>(graphicsEvent))
+			{
+				adapter.command_completion_event_handler(std::move(std::get<CommandCompletionEvent>(graphicsEvent)));
+			}
 		}
 	}
 
@@ -467,6 +482,9 @@ void gameLoop(VkAdapter& adapter, VkRenderer& renderer, Gui& gui, WindowUserData
 		handleHIDEvents(windowUserData.eventQueue, sceneState);
 
 		handleGraphicsEvents(renderer, adapter, sceneState);
+		// All uploads recorded above go in one submission ahead of the frame
+		adapter.submitUploads();
+		adapter.collectRetiredDrawData();
 
 		gui.drawGui();
 		renderer.drawFrame();
@@ -501,7 +519,9 @@ int main() {
 		};
 
 		Gui gui;
+		ThreadPool framePool;
 		SceneState sceneState;
+		sceneState.transforms.set_thread_pool(&framePool);
 		SceneGui sceneGui;
 
 		gui.registerDrawCall([&sceneGui, &sceneState]() {sceneGui.drawGui(sceneState);});
@@ -536,19 +556,29 @@ int main() {
 		renderer.registerUniformBufferProducer([&sceneState]() -> UniformBufferObject {
 			return createUniformBufferObject(sceneState);
 			});
-		renderer.registerModelMatrixBufferUpdateFunction([&sceneState]() -> std::vector<glm::mat4>&{
-			updateModelMatrices(sceneState);
+		renderer.registerModelMatrixBufferUpdateFunction([&sceneState](std::vector<ENG::MatrixRange>& changedRanges) -> const std::vector<glm::mat4>&{
+			updateModelMatrices(sceneState, changedRanges);
 			return sceneState.modelMatrices;
 			});
-		/*
-		renderer.registerUniformBufferConsumer([&sceneState, &windowUserData](const UniformBufferObject& ubo) {
-			castRayForMouseHover(windowUserData, sceneState, ubo);
+		renderer.registerUniformBufferConsumer([&sceneState](const UniformBufferObject& ubo) {
+			cull_scene(sceneState, ubo.proj * ubo.view);
+			select_lods(sceneState, ubo.view, ubo.proj);
+			});
+		renderer.registerUniformBufferConsumer([&sceneState, &windowUserData, lastHoverPick = std::optional<HoverPickInputs>{}](const UniformBufferObject& ubo) mutable {
+			updateMouseHover(windowUserData, sceneState, ubo, lastHoverPick);
+			updateSelection(windowUserData, sceneState);
 			});
-		*/
 
 
 		app.mainThreadFunction = [&renderAdapter, &renderer, &gui, &windowUserData, &sceneState]() {
 			gameLoop(renderAdapter, renderer, gui, windowUserData, sceneState); 
+
+			// The device is idle; release the scene's draw data before the adapter goes away.
+			// A scene still loading is left to the SceneState destructor.
+			if (sceneState.initialized)
+			{
+				unloadWorldScene(renderer, renderAdapter, sceneState);
+			}
 		};
 
 		app.start();
@@ -86,7 +86,11 @@ void Command::copyBuffer(const VkQueue &graphicsQueue, VkBuffer srcBuffer, VkBuf
 
 void Command::copyBufferToImage(const VkQueue &graphicsQueue, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(device);
+	recordCopyBufferToImage(commandBuffer, buffer, image, width, height);
+	endSingleTimeCommands(device, graphicsQueue, commandBuffer);
+}
 
+void Command::recordCopyBufferToImage(VkCommandBuffer commandBuffer, VkBuffer buffer, VkImage image, uint32_t width, uint32_t height) {
 	VkBufferImageCopy region{};
 	region.bufferOffset = 0;
 	region.bufferRowLength = 0;
@@ -112,13 +116,15 @@ void Command::copyBufferToImage(const VkQueue &graphicsQueue, VkBuffer buffer, V
 		1,
 		&region
 	);
-
-	endSingleTimeCommands(device, graphicsQueue, commandBuffer);
 }
 
 void Command::transitionImageLayout(const VkQueue &graphicsQueue, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
 	VkCommandBuffer commandBuffer = beginSingleTimeCommands(device);
+	recordTransitionImageLayout(commandBuffer, image, format, oldLayout, newLayout);
+	endSingleTimeCommands(device, graphicsQueue, commandBuffer);
+}
 
+void Command::recordTransitionImageLayout(VkCommandBuffer commandBuffer, VkImage image, VkFormat format, VkImageLayout oldLayout, VkImageLayout newLayout) {
 	VkImageMemoryBarrier barrier{};
 	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
 	barrier.oldLayout = oldLayout;
@@ -159,7 +165,5 @@ void Command::transitionImageLayout(const VkQueue &graphicsQueue, VkImage image,
 		0, nullptr,
 		1, &barrier
 	);
-
-	endSingleTimeCommands(device, graphicsQueue, commandBuffer);
 }
 } // end namespace
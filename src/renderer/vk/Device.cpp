@@ -6,19 +6,19 @@
 using namespace ENG;
 
 void Device::createLogicalDevice(const VkSurfaceKHR &surface, const VkPhysicalDevice &physicalDevice, const std::vector<const char*> &validationLayers,
-					 VkQueue &graphicsQueue, VkQueue &presentQueue, VkDevice &device)
+					 VkQueue &graphicsQueue, VkQueue &presentQueue, VkQueue &transferQueue, VkDevice &device)
 {
 	QueueFamilyIndices indices = PhysicalDevice::findQueueFamilies(physicalDevice, surface);
 
 	std::vector<VkDeviceQueueCreateInfo> queueCreateInfos;
-	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value() };
+	std::set<uint32_t> uniqueQueueFamilies = { indices.graphicsFamily.value(), indices.presentFamily.value(), indices.uploadFamily() };
 
 	float queuePriority = 1.0f;
 	for (uint32_t queueFamily : uniqueQueueFamilies) {
 		VkDeviceQueueCreateInfo queueCreateInfo{};
 		queueCreateInfo.pQueuePriorities = &queuePriority;
 		queueCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
-		queueCreateInfo.queueFamilyIndex = indices.graphicsFamily.value();
+		queueCreateInfo.queueFamilyIndex = queueFamily;
 		queueCreateInfo.queueCount = 1;
 		queueCreateInfos.push_back(queueCreateInfo);
 	}
@@ -31,8 +31,14 @@ void Device::createLogicalDevice(const VkSurfaceKHR &surface, const VkPhysicalDe
 	deviceFeatures.geometryShader = VK_TRUE;
 #endif
 
+	// Upload batches signal timeline semaphores
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	vulkan12Features.timelineSemaphore = VK_TRUE;
+
 	VkDeviceCreateInfo createInfo{};
 	createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	createInfo.pNext = &vulkan12Features;
 	createInfo.pQueueCreateInfos = queueCreateInfos.data();
 	createInfo.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size());
 	createInfo.pEnabledFeatures = &deviceFeatures;
@@ -52,4 +58,5 @@ void Device::createLogicalDevice(const VkSurfaceKHR &surface, const VkPhysicalDe
 
 	vkGetDeviceQueue(device, indices.graphicsFamily.value(), 0, &graphicsQueue);
 	vkGetDeviceQueue(device, indices.presentFamily.value(), 0, &presentQueue);
+	vkGetDeviceQueue(device, indices.uploadFamily(), 0, &transferQueue);
 }
@@ -4,6 +4,7 @@
 #include "vulkan/vulkan_core.h"
 #include "renderer/vk/PhysicalDevice.hpp"
 #include "logger/Logging.hpp"
+#include "EngineConfig.hpp"
 
 namespace ENG
 {
@@ -12,6 +13,10 @@ bool QueueFamilyIndices::isComplete() {
 	return graphicsFamily.has_value() && presentFamily.has_value();
 }
 
+uint32_t QueueFamilyIndices::uploadFamily() {
+	return transferFamily.value_or(graphicsFamily.value());
+}
+
 bool PhysicalDevice::checkDeviceExtensionSupport(VkPhysicalDevice device) {
 	uint32_t extensionCount;
 	vkEnumerateDeviceExtensionProperties(device, nullptr, &extensionCount, 
@@ -50,21 +55,26 @@ QueueFamilyIndices PhysicalDevice::findQueueFamilies(VkPhysicalDevice device, co
 	vkGetPhysicalDeviceQueueFamilyProperties(device, &queueFamilyCount,
 			queueFamilies.data());
 	// report queue family that supports GRAPHICS_BIT queue
-	int i = 0;
+	uint32_t i = 0;
 	for (const auto& queueFamily : queueFamilies) {
-		if (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
+		if (!indices.graphicsFamily.has_value() && (queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
 			indices.graphicsFamily = i;
 		}
 
 		VkBool32 presentSupport = false;
 		vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface, 
 				&presentSupport);
-		if (presentSupport) {
+		if (!indices.presentFamily.has_value() && presentSupport) {
 			indices.presentFamily = i;
 		}
 
-		if (indices.isComplete()) {
-			break;
+		// Prefer a transfer only family (DMA engine) over an async compute one
+		const bool transferOnly = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)
+			&& !(queueFamily.queueFlags & (VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT));
+		const bool nonGraphicsTransfer = (queueFamily.queueFlags & VK_QUEUE_TRANSFER_BIT)
+			&& !(queueFamily.queueFlags & VK_QUEUE_GRAPHICS_BIT);
+		if (ENG_USE_TRANSFER_QUEUE && (transferOnly || (nonGraphicsTransfer && !indices.transferFamily.has_value()))) {
+			indices.transferFamily = i;
 		}
 		i++;
 	}
@@ -117,10 +127,19 @@ bool PhysicalDevice::isDeviceSuitable(VkPhysicalDevice device, const VkSurfaceKH
 	VkPhysicalDeviceFeatures supportedFeatures;
 	vkGetPhysicalDeviceFeatures(device, &supportedFeatures);
 
+	// Uploads are tracked with timeline semaphores, core since Vulkan 1.2
+	VkPhysicalDeviceVulkan12Features vulkan12Features{};
+	vulkan12Features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	VkPhysicalDeviceFeatures2 features2{};
+	features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features2.pNext = &vulkan12Features;
+	vkGetPhysicalDeviceFeatures2(device, &features2);
+
 	return indices.isComplete()
 		&& extensionsSupported
 		&& swapChainAdequate
 		&& supportedFeatures.samplerAnisotropy 
+		&& vulkan12Features.timelineSemaphore
 	#ifdef _WIN32
 		&& supportedFeatures.geometryShader
 	#endif
@@ -127,6 +127,7 @@ void VkRenderer::cleanupVulkan()
 		vkDestroySemaphore(device, s, nullptr);
 	}
 
+	uploads.reset();
 	commands.reset();
 	pipelineFactory.reset();
 
@@ -202,11 +203,13 @@ void VkRenderer::initVulkan()
 	instanceFactory->setupDebugMessenger();
 	createSurface();
 	ENG::PhysicalDevice::pickPhysicalDevice(instanceFactory->instance, physicalDevice, surface);
-	ENG::Device::createLogicalDevice(surface, physicalDevice, validationLayers, graphicsQueue, presentQueue, device);
+	ENG::Device::createLogicalDevice(surface, physicalDevice, validationLayers, graphicsQueue, presentQueue, transferQueue, device);
 	swapchain = std::make_unique<Swapchain>(physicalDevice, surface, device, *window);
 	pipelineFactory = std::make_unique<ENG::PipelineFactory>(device, swapchain->swapChainImageFormat, findDepthFormat(physicalDevice));
 	renderPass = pipelineFactory->getRenderPass();
 	commands = std::make_unique<Command>(physicalDevice, device, surface); // creates command pool
+	QueueFamilyIndices queueFamilies = ENG::PhysicalDevice::findQueueFamilies(physicalDevice, surface);
+	uploads = std::make_unique<UploadBatcher>(device, queueFamilies.uploadFamily(), transferQueue, queueFamilies.graphicsFamily.value(), graphicsQueue);
 	createDepthResources(device, physicalDevice, swapchain->swapChainExtent, swapchain->depthImage, swapchain->depthImageMemory, swapchain->depthImageView);
 	swapchain->createFramebuffers(renderPass, device);
 
@@ -214,6 +217,7 @@ void VkRenderer::initVulkan()
 	{
 		createTexture(fpath);
 	}
+	uploads->submit();
 
 	createUniformBuffers();
 	createDescriptorPool();
@@ -317,7 +321,7 @@ void VkRenderer::notifyUboConsumers(const UniformBufferObject& ubo)
 	}
 }
 
-void VkRenderer::registerModelMatrixBufferUpdateFunction(std::function<std::vector<glm::mat4>& ()> updateFun)
+void VkRenderer::registerModelMatrixBufferUpdateFunction(std::function<const std::vector<glm::mat4>& (std::vector<ENG::MatrixRange>&)> updateFun)
 {
 	modelMatrixBufferUpdateFunction = updateFun;
 }
@@ -341,18 +345,22 @@ void VkRenderer::drawFrame()
 
 	vkResetFences(device, 1, &inFlightFences[currentFrame]);
 
-	vkResetCommandBuffer(commands->commandBuffers[currentFrame], 0);
-	recordCommandBuffer(commands->commandBuffers[currentFrame], imageIndex);
-
+	// Scene data for this frame is produced before recording, so consumers such as the
+	// culling stage see this frame's camera and matrices when the draws are recorded
 	if (sceneReadyToRender) {
 		assert(uniformBufferProducer);
 		assert(modelMatrixBufferUpdateFunction);
 		const auto& ubo = uniformBufferProducer();
-		notifyUboConsumers(ubo);
 		copyUniformBufferToGpu(currentFrame, ubo);
-		copyModelMatrixBufferToGpu(modelMatrixBufferUpdateFunction());
+		changedModelMatrixRanges.clear();
+		const auto& modelMatrices = modelMatrixBufferUpdateFunction(changedModelMatrixRanges);
+		copyModelMatrixBufferToGpu(modelMatrices, changedModelMatrixRanges);
+		notifyUboConsumers(ubo);
 	}
 
+	vkResetCommandBuffer(commands->commandBuffers[currentFrame], 0);
+	recordCommandBuffer(commands->commandBuffers[currentFrame], imageIndex);
+
 	VkSubmitInfo submitInfo{};
 	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
 
@@ -373,6 +381,7 @@ void VkRenderer::drawFrame()
 	if (vkQueueSubmit(graphicsQueue, 1, submitInfoPtr, inFlightFence) != VK_SUCCESS) {
 		throw std::runtime_error("failed to submit draw command buffer!");
 	}
+	++submittedFrameCount;
 
 	VkPresentInfoKHR presentInfo{};
 	presentInfo.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR;
@@ -474,6 +483,7 @@ void VkRenderer::createModelMatrices(const size_t size_bytes)
 	VkDeviceSize bufferSize = size_bytes;
 	modelMatrixBuffersMapped.resize(MAX_FRAMES_IN_FLIGHT);
 	modelMatrixBuffers.reserve(MAX_FRAMES_IN_FLIGHT);
+	pendingModelMatrixRanges.resize(MAX_FRAMES_IN_FLIGHT);
     
     VkPhysicalDeviceProperties properties;
     vkGetPhysicalDeviceProperties(physicalDevice, &properties);
@@ -488,10 +498,27 @@ void VkRenderer::createModelMatrices(const size_t size_bytes)
 	}
 }
 
-void VkRenderer::copyModelMatrixBufferToGpu(const std::vector<glm::mat4>& modelMatrices)
+void VkRenderer::copyModelMatrixBufferToGpu(const std::vector<glm::mat4>& modelMatrices, const std::vector<ENG::MatrixRange>& changedRanges)
 {
-	const auto& bufferSize = modelMatrices.size() * sizeof(glm::mat4);
-	memcpy(modelMatrixBuffersMapped[currentFrame], modelMatrices.data(), bufferSize);
+	// Every frame in flight has its own buffer, so a change must reach each of them
+	// before it is considered uploaded
+	for (auto& pending : pendingModelMatrixRanges)
+	{
+		pending.insert(pending.end(), changedRanges.begin(), changedRanges.end());
+	}
+
+	auto& pending = pendingModelMatrixRanges[currentFrame];
+	ENG::merge_matrix_ranges(pending);
+
+	const auto matrixCount = std::min(modelMatrices.size(), modelMatrixBuffers[currentFrame].total_size_bytes / sizeof(glm::mat4));
+	auto* mapped = static_cast<glm::mat4*>(modelMatrixBuffersMapped[currentFrame]);
+	for (const auto& range : pending)
+	{
+		if (range.first >= matrixCount) continue;
+		const auto count = std::min<size_t>(range.count, matrixCount - range.first);
+		memcpy(mapped + range.first, modelMatrices.data() + range.first, count * sizeof(glm::mat4));
+	}
+	pending.clear();
 }
 
 
@@ -513,6 +540,8 @@ void VkRenderer::createDescriptorPool()
 
 	VkDescriptorPoolCreateInfo poolInfo{};
 	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	// Sets are freed individually when draw data is released
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
 	poolInfo.poolSizeCount = static_cast<uint32_t>(poolSizes.size());
 	poolInfo.pPoolSizes = poolSizes.data();
 	poolInfo.maxSets = static_cast<uint32_t>(MAX_FRAMES_IN_FLIGHT) * 1000;
@@ -690,6 +719,12 @@ void VkRenderer::createDescriptorSets(std::vector<VkDescriptorSet>& descriptorSe
 	writeDescriptorSets(descriptorSetsP, shaderId, texturePath);
 }
 
+void VkRenderer::freeDescriptorSets(const std::vector<VkDescriptorSet>& descriptorSetsP)
+{
+	if (descriptorSetsP.empty()) return;
+	vkFreeDescriptorSets(device, descriptorPool, static_cast<uint32_t>(descriptorSetsP.size()), descriptorSetsP.data());
+}
+
 void VkRenderer::createDescriptorSets(ENG::Node& node) 
 {
 	if (!node.shaderId.has_value())
@@ -736,13 +771,14 @@ void VkRenderer::createTextureImage(const std::filesystem::path& fpath)
 		throw std::runtime_error("failed to load texture image!");
 	}
 
-	const ENG::Buffer stagingBuffer(device, physicalDevice, 4, imageSize, 
+	// Shared with the upload batch's completion callback, which keeps it alive until the copy has executed
+	const auto stagingBuffer = std::make_shared<ENG::Buffer>(device, physicalDevice, 4, imageSize, 
 			  VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
 
 	void* data;
-	vkMapMemory(device, stagingBuffer.bufferMemory, 0, imageSize, 0, &data);
+	vkMapMemory(device, stagingBuffer->bufferMemory, 0, imageSize, 0, &data);
 	memcpy(data, pixels, static_cast<size_t>(imageSize));
-	vkUnmapMemory(device, stagingBuffer.bufferMemory);
+	vkUnmapMemory(device, stagingBuffer->bufferMemory);
 
 	stbi_image_free(pixels);
 
@@ -775,9 +811,13 @@ void VkRenderer::createTextureImage(const std::filesystem::path& fpath)
 		textureImage, 
 		textureImageMem);
 
-	commands->transitionImageLayout(graphicsQueue, textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-	commands->copyBufferToImage(graphicsQueue, stagingBuffer.buffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
-	commands->transitionImageLayout(graphicsQueue, textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+	// Recorded into the open upload batch, which hands the image to the graphics queue for fragment shader reads
+	VkCommandBuffer cmd = uploads->command_buffer();
+	commands->recordTransitionImageLayout(cmd, textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
+	commands->recordCopyBufferToImage(cmd, stagingBuffer->buffer, textureImage, static_cast<uint32_t>(texWidth), static_cast<uint32_t>(texHeight));
+	uploads->release_image(textureImage, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, VK_ACCESS_SHADER_READ_BIT);
+	uploads->on_complete([stagingBuffer] {});
 }
 
 void VkRenderer::createTextureImageView(const std::filesystem::path& fpath) 
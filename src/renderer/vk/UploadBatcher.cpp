@@ -0,0 +1,362 @@
+#include<algorithm>
+#include<stdexcept>
+#include "renderer/vk/UploadBatcher.hpp"
+#include "logger/Logging.hpp"
+
+namespace {
+
+VkCommandPool create_pool(VkDevice device, uint32_t queueFamily)
+{
+	VkCommandPoolCreateInfo poolInfo{};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+	poolInfo.queueFamilyIndex = queueFamily;
+
+	VkCommandPool pool{ VK_NULL_HANDLE };
+	if (vkCreateCommandPool(device, &poolInfo, nullptr, &pool) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload command pool!");
+	}
+	return pool;
+}
+
+VkSemaphore create_timeline(VkDevice device)
+{
+	VkSemaphoreTypeCreateInfo typeInfo{};
+	typeInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO;
+	typeInfo.semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE;
+	typeInfo.initialValue = 0;
+
+	VkSemaphoreCreateInfo semaphoreInfo{};
+	semaphoreInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO;
+	semaphoreInfo.pNext = &typeInfo;
+
+	VkSemaphore semaphore{ VK_NULL_HANDLE };
+	if (vkCreateSemaphore(device, &semaphoreInfo, nullptr, &semaphore) != VK_SUCCESS) {
+		throw std::runtime_error("failed to create upload timeline semaphore!");
+	}
+	return semaphore;
+}
+
+void wait_timeline(VkDevice device, VkSemaphore semaphore, uint64_t value)
+{
+	VkSemaphoreWaitInfo waitInfo{};
+	waitInfo.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO;
+	waitInfo.semaphoreCount = 1;
+	waitInfo.pSemaphores = &semaphore;
+	waitInfo.pValues = &value;
+	vkWaitSemaphores(device, &waitInfo, UINT64_MAX);
+}
+
+uint64_t timeline_value(VkDevice device, VkSemaphore semaphore)
+{
+	uint64_t value = 0;
+	vkGetSemaphoreCounterValue(device, semaphore, &value);
+	return value;
+}
+
+VkCommandBuffer begin_command_buffer(VkDevice device, VkCommandPool pool)
+{
+	VkCommandBufferAllocateInfo allocInfo{};
+	allocInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocInfo.commandPool = pool;
+	allocInfo.commandBufferCount = 1;
+
+	VkCommandBuffer commandBuffer{ VK_NULL_HANDLE };
+	if (vkAllocateCommandBuffers(device, &allocInfo, &commandBuffer) != VK_SUCCESS) {
+		throw std::runtime_error("failed to allocate upload command buffer!");
+	}
+
+	VkCommandBufferBeginInfo beginInfo{};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	return commandBuffer;
+}
+
+} // end namespace
+
+namespace ENG
+{
+
+UploadBatcher::UploadBatcher(VkDevice device, uint32_t uploadFamily, VkQueue uploadQueue, uint32_t graphicsFamily, VkQueue graphicsQueue)
+	: device(device), uploadFamily(uploadFamily), graphicsFamily(graphicsFamily), uploadQueue(uploadQueue), graphicsQueue(graphicsQueue)
+{
+	uploadPool = create_pool(device, uploadFamily);
+	uploadTimeline = create_timeline(device);
+	if (dedicated_queue())
+	{
+		acquirePool = create_pool(device, graphicsFamily);
+		acquireTimeline = create_timeline(device);
+	}
+	ENG_LOG_DEBUG("Uploads use queue family " << uploadFamily << (dedicated_queue() ? " (dedicated transfer)" : " (graphics)") << std::endl);
+}
+
+UploadBatcher::~UploadBatcher()
+{
+	// Callbacks of batches still in flight are dropped, the device is going away.
+	// Destroying the pools frees every command buffer allocated from them.
+	if (lastSubmittedSerial > 0)
+	{
+		wait_timeline(device, uploadTimeline, lastSubmittedSerial);
+	}
+	if (!pendingAcquires.empty())
+	{
+		wait_timeline(device, acquireTimeline, pendingAcquires.back().serial);
+	}
+	vkDestroyCommandPool(device, uploadPool, nullptr);
+	vkDestroySemaphore(device, uploadTimeline, nullptr);
+	if (dedicated_queue())
+	{
+		vkDestroyCommandPool(device, acquirePool, nullptr);
+		vkDestroySemaphore(device, acquireTimeline, nullptr);
+	}
+}
+
+VkCommandBuffer UploadBatcher::command_buffer()
+{
+	if (openCommandBuffer == VK_NULL_HANDLE)
+	{
+		openCommandBuffer = begin_command_buffer(device, uploadPool);
+	}
+	return openCommandBuffer;
+}
+
+void UploadBatcher::release_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize size,
+	VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+	command_buffer();
+
+	VkBufferMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = dstAccess;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.buffer = buffer;
+	barrier.offset = offset;
+	barrier.size = size;
+
+	if (!dedicated_queue())
+	{
+		bufferReleases.push_back(barrier);
+		releaseStages |= dstStage;
+		return;
+	}
+
+	// Ownership transfer: the release ignores dst access, the acquire ignores src access
+	barrier.srcQueueFamilyIndex = uploadFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	auto release = barrier;
+	release.dstAccessMask = 0;
+	bufferReleases.push_back(release);
+	releaseStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+	auto acquire = barrier;
+	acquire.srcAccessMask = 0;
+	openBatch.bufferAcquires.push_back(acquire);
+	openBatch.acquireStages |= dstStage;
+}
+
+void UploadBatcher::release_image(VkImage image, VkImageLayout oldLayout, VkImageLayout newLayout,
+	VkPipelineStageFlags dstStage, VkAccessFlags dstAccess)
+{
+	command_buffer();
+
+	VkImageMemoryBarrier barrier{};
+	barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = dstAccess;
+	barrier.oldLayout = oldLayout;
+	barrier.newLayout = newLayout;
+	barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+	barrier.image = image;
+	barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	barrier.subresourceRange.baseMipLevel = 0;
+	barrier.subresourceRange.levelCount = 1;
+	barrier.subresourceRange.baseArrayLayer = 0;
+	barrier.subresourceRange.layerCount = 1;
+
+	if (!dedicated_queue())
+	{
+		imageReleases.push_back(barrier);
+		releaseStages |= dstStage;
+		return;
+	}
+
+	// The layout transition happens once, between the release and the acquire
+	barrier.srcQueueFamilyIndex = uploadFamily;
+	barrier.dstQueueFamilyIndex = graphicsFamily;
+	auto release = barrier;
+	release.dstAccessMask = 0;
+	imageReleases.push_back(release);
+	releaseStages |= VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT;
+
+	auto acquire = barrier;
+	acquire.srcAccessMask = 0;
+	openBatch.imageAcquires.push_back(acquire);
+	openBatch.acquireStages |= dstStage;
+}
+
+void UploadBatcher::on_complete(std::function<void(void)> callback)
+{
+	// An empty batch still has to pass through the queue behind earlier ones
+	command_buffer();
+	openBatch.callbacks.push_back(std::move(callback));
+}
+
+uint64_t UploadBatcher::completed_serial() const
+{
+	// Acquires are submitted in serial order, so the oldest pending one bounds completion
+	if (!pendingAcquires.empty())
+	{
+		return pendingAcquires.front().serial - 1;
+	}
+	return lastRetiredSerial;
+}
+
+uint64_t UploadBatcher::submit()
+{
+	if (openCommandBuffer == VK_NULL_HANDLE)
+	{
+		return lastSubmittedSerial;
+	}
+
+	if (!bufferReleases.empty() || !imageReleases.empty())
+	{
+		vkCmdPipelineBarrier(openCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, releaseStages, 0,
+			0, nullptr,
+			static_cast<uint32_t>(bufferReleases.size()), bufferReleases.data(),
+			static_cast<uint32_t>(imageReleases.size()), imageReleases.data());
+	}
+	vkEndCommandBuffer(openCommandBuffer);
+
+	const uint64_t serial = lastSubmittedSerial + 1;
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &serial;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &openCommandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &uploadTimeline;
+	if (vkQueueSubmit(uploadQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit upload command buffer!");
+	}
+
+	ENG_LOG_TRACE("Submitted upload batch " << serial << " with " << openBatch.callbacks.size() << " callbacks" << std::endl);
+	openBatch.serial = serial;
+	openBatch.commandBuffer = openCommandBuffer;
+	inFlight.push_back(std::move(openBatch));
+
+	openBatch = Batch{};
+	openCommandBuffer = VK_NULL_HANDLE;
+	releaseStages = 0;
+	bufferReleases.clear();
+	imageReleases.clear();
+	lastSubmittedSerial = serial;
+	return serial;
+}
+
+void UploadBatcher::poll()
+{
+	const auto uploaded = timeline_value(device, uploadTimeline);
+	while (!inFlight.empty() && inFlight.front().serial <= uploaded)
+	{
+		retire_oldest();
+	}
+	if (!pendingAcquires.empty())
+	{
+		free_acquires(timeline_value(device, acquireTimeline));
+	}
+}
+
+void UploadBatcher::wait(uint64_t serial)
+{
+	serial = std::min(serial, lastSubmittedSerial);
+	if (!inFlight.empty() && inFlight.front().serial <= serial)
+	{
+		wait_timeline(device, uploadTimeline, serial);
+	}
+	poll();
+
+	uint64_t acquire = 0;
+	for (const auto& pending : pendingAcquires)
+	{
+		if (pending.serial > serial) break;
+		acquire = pending.serial;
+	}
+	if (acquire > 0)
+	{
+		wait_timeline(device, acquireTimeline, acquire);
+		free_acquires(acquire);
+	}
+}
+
+void UploadBatcher::retire_oldest()
+{
+	// Popped first so callbacks may record and submit new uploads
+	auto batch = std::move(inFlight.front());
+	inFlight.pop_front();
+	vkFreeCommandBuffers(device, uploadPool, 1, &batch.commandBuffer);
+	lastRetiredSerial = batch.serial;
+
+	if (!batch.bufferAcquires.empty() || !batch.imageAcquires.empty())
+	{
+		submit_acquire(batch);
+	}
+	for (auto& callback : batch.callbacks)
+	{
+		callback();
+	}
+}
+
+void UploadBatcher::submit_acquire(Batch& batch)
+{
+	VkCommandBuffer commandBuffer = begin_command_buffer(device, acquirePool);
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, batch.acquireStages, 0,
+		0, nullptr,
+		static_cast<uint32_t>(batch.bufferAcquires.size()), batch.bufferAcquires.data(),
+		static_cast<uint32_t>(batch.imageAcquires.size()), batch.imageAcquires.data());
+	vkEndCommandBuffer(commandBuffer);
+
+	// The release has already executed; the wait orders it before the acquire on the device
+	// without holding up the graphics queue
+	const VkPipelineStageFlags waitStage = VK_PIPELINE_STAGE_ALL_COMMANDS_BIT;
+	VkTimelineSemaphoreSubmitInfo timelineInfo{};
+	timelineInfo.sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO;
+	timelineInfo.waitSemaphoreValueCount = 1;
+	timelineInfo.pWaitSemaphoreValues = &batch.serial;
+	timelineInfo.signalSemaphoreValueCount = 1;
+	timelineInfo.pSignalSemaphoreValues = &batch.serial;
+
+	VkSubmitInfo submitInfo{};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.pNext = &timelineInfo;
+	submitInfo.waitSemaphoreCount = 1;
+	submitInfo.pWaitSemaphores = &uploadTimeline;
+	submitInfo.pWaitDstStageMask = &waitStage;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	submitInfo.signalSemaphoreCount = 1;
+	submitInfo.pSignalSemaphores = &acquireTimeline;
+	if (vkQueueSubmit(graphicsQueue, 1, &submitInfo, VK_NULL_HANDLE) != VK_SUCCESS) {
+		throw std::runtime_error("failed to submit upload acquire command buffer!");
+	}
+	pendingAcquires.push_back(PendingAcquire{ batch.serial, commandBuffer });
+}
+
+void UploadBatcher::free_acquires(uint64_t acquiredSerial)
+{
+	while (!pendingAcquires.empty() && pendingAcquires.front().serial <= acquiredSerial)
+	{
+		vkFreeCommandBuffers(device, acquirePool, 1, &pendingAcquires.front().commandBuffer);
+		pendingAcquires.pop_front();
+	}
+}
+}
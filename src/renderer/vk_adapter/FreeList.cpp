@@ -0,0 +1,90 @@
+#include <cassert>
+
+#include "renderer/vk_adapter/FreeList.hpp"
+
+FreeList::FreeList(uint32_t capacity)
+	: listCapacity(capacity), freeCount(0)
+{
+	if (capacity > 0)
+	{
+		insert_free(0, capacity);
+	}
+}
+
+std::optional<uint32_t> FreeList::allocate(uint32_t count, uint32_t alignment)
+{
+	if (count == 0 || alignment == 0) return std::nullopt;
+
+	// Smallest range first; with an alignment a range may be too small once padded, the
+	// next larger one is tried then
+	for (auto bestFit = freeBySize.lower_bound(count); bestFit != freeBySize.end(); ++bestFit)
+	{
+		const uint64_t rangeOffset = bestFit->second;
+		const uint64_t rangeEnd = rangeOffset + bestFit->first;
+		const uint64_t offset = (rangeOffset + alignment - 1) / alignment * alignment;
+		if (offset + count > rangeEnd) continue;
+
+		erase_free(freeByOffset.find(bestFit->second));
+		if (offset > rangeOffset)
+		{
+			insert_free(static_cast<uint32_t>(rangeOffset), static_cast<uint32_t>(offset - rangeOffset));
+		}
+		if (offset + count < rangeEnd)
+		{
+			insert_free(static_cast<uint32_t>(offset + count), static_cast<uint32_t>(rangeEnd - offset - count));
+		}
+		return static_cast<uint32_t>(offset);
+	}
+	return std::nullopt;
+}
+
+void FreeList::free(uint32_t offset, uint32_t count)
+{
+	if (count == 0) return;
+	assert(offset + count <= listCapacity);
+
+	// Merge with the free ranges directly after and before
+	auto next = freeByOffset.lower_bound(offset);
+	assert(next == freeByOffset.end() || next->first >= offset + count);
+	if (next != freeByOffset.end() && next->first == offset + count)
+	{
+		count += next->second;
+		erase_free(next);
+	}
+
+	auto prev = freeByOffset.lower_bound(offset);
+	if (prev != freeByOffset.begin())
+	{
+		--prev;
+		assert(prev->first + prev->second <= offset);
+		if (prev->first + prev->second == offset)
+		{
+			offset = prev->first;
+			count += prev->second;
+			erase_free(prev);
+		}
+	}
+	insert_free(offset, count);
+}
+
+void FreeList::insert_free(uint32_t offset, uint32_t count)
+{
+	freeByOffset.emplace(offset, count);
+	freeBySize.emplace(count, offset);
+	freeCount += count;
+}
+
+void FreeList::erase_free(std::map<uint32_t, uint32_t>::iterator range)
+{
+	auto [first, last] = freeBySize.equal_range(range->second);
+	for (auto it = first; it != last; ++it)
+	{
+		if (it->second == range->first)
+		{
+			freeBySize.erase(it);
+			break;
+		}
+	}
+	freeCount -= range->second;
+	freeByOffset.erase(range);
+}
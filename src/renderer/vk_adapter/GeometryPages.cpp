@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cassert>
+
+#include "renderer/vk_adapter/GeometryPages.hpp"
+
+GeometryPages::GeometryPages(uint64_t pageSize)
+	: pageSize(pageSize)
+{
+}
+
+GeometryAllocation GeometryPages::allocate(uint32_t format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount)
+{
+	if (format >= formats.size())
+	{
+		formats.resize(format + 1);
+	}
+	auto& pool = formats[format];
+	if (pool.vertexStride == 0)
+	{
+		pool.vertexStride = vertexStride;
+	}
+	assert(pool.vertexStride == vertexStride);
+
+	GeometryAllocation allocation{};
+	allocation.format = format;
+	allocation.vertexCount = vertexCount;
+	allocation.indexCount = indexCount;
+
+	for (uint32_t i = 0; i < pool.pages.size(); i++)
+	{
+		if (allocate_in_page(pool.pages[i], vertexCount, indexCount, allocation))
+		{
+			allocation.page = i;
+			return allocation;
+		}
+	}
+
+	const auto vertices = std::max(static_cast<uint32_t>(pageSize / vertexStride), vertexCount);
+	const auto indices = std::max(static_cast<uint32_t>(pageSize / sizeof(uint32_t)), indexCount);
+	pool.pages.push_back(Page{ FreeList(vertices), FreeList(indices) });
+	allocation.page = static_cast<uint32_t>(pool.pages.size() - 1);
+	const bool fits = allocate_in_page(pool.pages.back(), vertexCount, indexCount, allocation);
+	assert(fits);
+	(void)fits;
+	return allocation;
+}
+
+void GeometryPages::free(const GeometryAllocation& allocation)
+{
+	if (allocation.vertexCount == 0 && allocation.indexCount == 0) return;
+
+	assert(allocation.format < formats.size() && allocation.page < formats[allocation.format].pages.size());
+	auto& page = formats[allocation.format].pages[allocation.page];
+	page.vertices.free(allocation.firstVertex, allocation.vertexCount);
+	page.indices.free(allocation.firstIndex, allocation.indexCount);
+}
+
+size_t GeometryPages::page_count(uint32_t format) const
+{
+	return format < formats.size() ? formats[format].pages.size() : 0;
+}
+
+bool GeometryPages::allocate_in_page(Page& page, uint32_t vertexCount, uint32_t indexCount, GeometryAllocation& allocation)
+{
+	const auto firstVertex = page.vertices.allocate(vertexCount);
+	if (vertexCount > 0 && !firstVertex.has_value()) return false;
+
+	const auto firstIndex = page.indices.allocate(indexCount);
+	if (indexCount > 0 && !firstIndex.has_value())
+	{
+		page.vertices.free(firstVertex.value_or(0), vertexCount);
+		return false;
+	}
+
+	allocation.firstVertex = firstVertex.value_or(0);
+	allocation.firstIndex = firstIndex.value_or(0);
+	return true;
+}
@@ -0,0 +1,130 @@
+#include <cassert>
+#include <stdexcept>
+
+#include "renderer/vk_adapter/GeometryPool.hpp"
+#include "logger/Logging.hpp"
+
+namespace {
+
+VkBuffer create_buffer(VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, VmaAllocation& allocation)
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = size;
+	bufferInfo.usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_GPU_ONLY;
+
+	VkBuffer buffer{ VK_NULL_HANDLE };
+	if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, nullptr) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create geometry pool buffer!");
+	}
+	return buffer;
+}
+
+} // end namespace
+
+GeometryPool::GeometryPool(VmaAllocator allocator, VkDeviceSize pageSize)
+	: allocator(allocator), pages(pageSize)
+{
+}
+
+GeometryPool::~GeometryPool()
+{
+	for (auto& formatBuffers : buffers)
+	{
+		for (auto& page : formatBuffers)
+		{
+			vmaDestroyBuffer(allocator, page.vertexBuffer, page.vertexAllocation);
+			vmaDestroyBuffer(allocator, page.indexBuffer, page.indexAllocation);
+		}
+	}
+}
+
+GeometryAllocation GeometryPool::allocate(uint32_t format, uint32_t vertexStride, uint32_t vertexCount, uint32_t indexCount)
+{
+	const auto allocation = pages.allocate(format, vertexStride, vertexCount, indexCount);
+	try
+	{
+		create_page_buffers(allocation);
+	}
+	catch (...)
+	{
+		// The page stays without the missing buffers, the next allocation retries them
+		pages.free(allocation);
+		throw;
+	}
+	return allocation;
+}
+
+void GeometryPool::free(const GeometryAllocation& allocation)
+{
+	pages.free(allocation);
+}
+
+VkBuffer GeometryPool::vertex_buffer(const GeometryAllocation& allocation) const
+{
+	return buffers[allocation.format][allocation.page].vertexBuffer;
+}
+
+VkBuffer GeometryPool::index_buffer(const GeometryAllocation& allocation) const
+{
+	const auto indexBuffer = buffers[allocation.format][allocation.page].indexBuffer;
+	assert(indexBuffer != VK_NULL_HANDLE && "allocation has no indices");
+	return indexBuffer;
+}
+
+VkDeviceSize GeometryPool::vertex_byte_offset(const GeometryAllocation& allocation) const
+{
+	return static_cast<VkDeviceSize>(allocation.firstVertex) * pages.vertex_stride(allocation.format);
+}
+
+VkDeviceSize GeometryPool::index_byte_offset(const GeometryAllocation& allocation) const
+{
+	return static_cast<VkDeviceSize>(allocation.firstIndex) * sizeof(uint32_t);
+}
+
+size_t GeometryPool::page_count() const
+{
+	size_t count = 0;
+	for (const auto& formatBuffers : buffers)
+	{
+		count += formatBuffers.size();
+	}
+	return count;
+}
+
+void GeometryPool::create_page_buffers(const GeometryAllocation& allocation)
+{
+	const auto format = allocation.format;
+	if (format >= buffers.size())
+	{
+		buffers.resize(format + 1);
+	}
+	auto& formatBuffers = buffers[format];
+	const auto vertexStride = pages.vertex_stride(format);
+	while (formatBuffers.size() < pages.page_count(format))
+	{
+		const auto page = static_cast<uint32_t>(formatBuffers.size());
+		const auto vertices = pages.vertex_capacity(format, page);
+
+		PageBuffers created{};
+		created.vertexBuffer = create_buffer(allocator, static_cast<VkDeviceSize>(vertices) * vertexStride,
+			VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, created.vertexAllocation);
+		formatBuffers.push_back(created);
+		ENG_LOG_DEBUG("Geometry page created for " << vertices << " vertices of " << vertexStride << " bytes" << std::endl);
+	}
+
+	// Meshes drawn without indices never touch the index buffer, so it waits for the first
+	// allocation that has indices
+	auto& page = formatBuffers[allocation.page];
+	if (allocation.indexCount > 0 && page.indexBuffer == VK_NULL_HANDLE)
+	{
+		const auto indices = pages.index_capacity(format, allocation.page);
+		page.indexBuffer = create_buffer(allocator, static_cast<VkDeviceSize>(indices) * sizeof(uint32_t),
+			VK_BUFFER_USAGE_INDEX_BUFFER_BIT, page.indexAllocation);
+		ENG_LOG_DEBUG("Geometry page index buffer created for " << indices << " indices" << std::endl);
+	}
+}
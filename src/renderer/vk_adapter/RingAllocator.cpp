@@ -0,0 +1,72 @@
+#include "renderer/vk_adapter/RingAllocator.hpp"
+
+namespace {
+
+uint64_t align_up(uint64_t value, uint64_t alignment)
+{
+	return (value + alignment - 1) / alignment * alignment;
+}
+
+} // end namespace
+
+std::optional<uint64_t> RingAllocator::allocate(uint64_t size, uint64_t alignment)
+{
+	if (size == 0 || size > ringCapacity) return std::nullopt;
+
+	const auto offset = find_space(size, alignment);
+	if (!offset.has_value()) return std::nullopt;
+
+	head = *offset + size;
+	inUse = true;
+	openBatch = true;
+	return offset;
+}
+
+std::optional<uint64_t> RingAllocator::find_space(uint64_t size, uint64_t alignment) const
+{
+	if (!inUse) return 0;
+
+	if (head > tail)
+	{
+		const auto at = align_up(head, alignment);
+		if (at + size <= ringCapacity) return at;
+		// Wrap, leaving the end of the ring unused until the tail passes it
+		if (size <= tail) return 0;
+		return std::nullopt;
+	}
+	if (head < tail)
+	{
+		const auto at = align_up(head, alignment);
+		if (at + size <= tail) return at;
+	}
+	// head == tail while in use: full
+	return std::nullopt;
+}
+
+void RingAllocator::close_batch(uint64_t serial)
+{
+	if (!openBatch) return;
+
+	batches.push_back(Batch{ serial, head });
+	openBatch = false;
+}
+
+void RingAllocator::reclaim(uint64_t completedSerial)
+{
+	while (!batches.empty() && batches.front().serial <= completedSerial)
+	{
+		tail = batches.front().end;
+		batches.pop_front();
+	}
+	if (batches.empty() && !openBatch)
+	{
+		inUse = false;
+		head = tail = 0;
+	}
+}
+
+std::optional<uint64_t> RingAllocator::oldest_serial() const
+{
+	if (batches.empty()) return std::nullopt;
+	return batches.front().serial;
+}
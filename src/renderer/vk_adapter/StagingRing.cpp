@@ -0,0 +1,42 @@
+#include <stdexcept>
+
+#include "renderer/vk_adapter/StagingRing.hpp"
+#include "logger/Logging.hpp"
+
+StagingRing::StagingRing(VmaAllocator allocator, VkDeviceSize capacity)
+	: allocator(allocator), ring(capacity)
+{
+	VkBufferCreateInfo bufferInfo{};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = capacity;
+	bufferInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+
+	VmaAllocationCreateInfo allocInfo{};
+	allocInfo.usage = VMA_MEMORY_USAGE_AUTO;
+	allocInfo.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+
+	VmaAllocationInfo allocationInfo{};
+	if (vmaCreateBuffer(allocator, &bufferInfo, &allocInfo, &buffer, &allocation, &allocationInfo) != VK_SUCCESS)
+	{
+		throw std::runtime_error("failed to create staging ring buffer!");
+	}
+	mapped = static_cast<std::byte*>(allocationInfo.pMappedData);
+	ENG_LOG_DEBUG("Staging ring of " << capacity << " bytes created" << std::endl);
+}
+
+StagingRing::~StagingRing()
+{
+	vmaDestroyBuffer(allocator, buffer, allocation);
+}
+
+std::optional<StagingRegion> StagingRing::allocate(VkDeviceSize size, VkDeviceSize alignment)
+{
+	const auto offset = ring.allocate(size, alignment);
+	if (!offset.has_value()) return std::nullopt;
+	return StagingRegion{ buffer, *offset, size, mapped + *offset };
+}
+
+void StagingRing::flush(const StagingRegion& region)
+{
+	vmaFlushAllocation(allocator, allocation, region.offset, region.size);
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cstring>
+
 #include "scene/Scene.hpp"
 #include "renderer/vk/Renderer.hpp"
 #include "renderer/vk_adapter/VkAdapter.hpp"
@@ -14,28 +17,121 @@ void initForVulkan(
 
 }
 
+// Buffers bound by the previous draw, so draws from the same geometry page skip rebinding
+struct BoundGeometry
+{
+	VkBuffer vertexBuffer{ VK_NULL_HANDLE };
+	VkBuffer indexBuffer{ VK_NULL_HANDLE };
+};
+
 void recordDrawDataCommand(
 	VkCommandBuffer& commandBuffer,
-	DrawData drawData,
-	const bool indexedDraw
+	const GeometryPool& geometry,
+	BoundGeometry& bound,
+	DrawData drawData
 )
 {
 	if (!drawData.bufferAllocationInfo.has_value()) {
 		ENG_LOG_ERROR("Attempted to record draw data command for drawdata without buffer allocation info" << std::endl);
+		return;
 	}
 	auto& allocationInfo = drawData.bufferAllocationInfo.value();
-    
-	if (indexedDraw)
+	if (allocationInfo.vertexCount == 0)
 	{
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, allocationInfo.vertexBuffers, allocationInfo.vertexBufferOffsets);
-		vkCmdBindIndexBuffer(commandBuffer, allocationInfo.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDrawIndexed(commandBuffer, allocationInfo.indexCount, 1, 0, 0, 0);
+		return;
+	}
+
+	const auto vertexBuffer = geometry.vertex_buffer(allocationInfo);
+	if (vertexBuffer != bound.vertexBuffer)
+	{
+		const VkDeviceSize offset = 0;
+		vkCmdBindVertexBuffers(commandBuffer, 0, 1, &vertexBuffer, &offset);
+		bound.vertexBuffer = vertexBuffer;
+	}
+
+	if (ENG::draws_indexed(allocationInfo.indexCount))
+	{
+		const auto indexBuffer = geometry.index_buffer(allocationInfo);
+		if (indexBuffer != bound.indexBuffer)
+		{
+			vkCmdBindIndexBuffer(commandBuffer, indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+			bound.indexBuffer = indexBuffer;
+		}
+		vkCmdDrawIndexed(commandBuffer, allocationInfo.indexCount, 1, allocationInfo.firstIndex,
+			static_cast<int32_t>(allocationInfo.firstVertex), 0);
 	}
 	else {
-		vkCmdBindVertexBuffers(commandBuffer, 0, 1, allocationInfo.vertexBuffers, allocationInfo.vertexBufferOffsets);
-		vkCmdBindIndexBuffer(commandBuffer, allocationInfo.indexBuffer, 0, VK_INDEX_TYPE_UINT32);
-		vkCmdDraw(commandBuffer, allocationInfo.vertexCount, 1, 0, 0);
+		vkCmdDraw(commandBuffer, allocationInfo.vertexCount, 1, allocationInfo.firstVertex, 0);
+	}
+}
+
+void VkAdapter::stageUpload(const void* data, VkDeviceSize size, VkBuffer dstBuffer, VkDeviceSize dstOffset)
+{
+	const auto* bytes = static_cast<const std::byte*>(data);
+	VkDeviceSize written = 0;
+	while (written < size)
+	{
+		const auto chunkSize = std::min(size - written, stagingRing->max_chunk());
+		auto region = stagingRing->allocate(chunkSize);
+		if (!region.has_value() && stagingRing->has_open_batch())
+		{
+			ENG_LOG_DEBUG("Staging ring full, submitting " << stagedCopies.size() << " staged copies early" << std::endl);
+			submitUploads();
+			region = stagingRing->allocate(chunkSize);
+		}
+		while (!region.has_value() && stagingRing->oldest_serial().has_value())
+		{
+			renderer.uploads->wait(stagingRing->oldest_serial().value());
+			stagingRing->reclaim(renderer.uploads->completed_serial());
+			region = stagingRing->allocate(chunkSize);
+		}
+		if (!region.has_value())
+		{
+			throw std::runtime_error("failed to allocate from the staging ring!");
+		}
+
+		memcpy(region->data, bytes + written, chunkSize);
+		stagingRing->flush(*region);
+		stagedCopies.push_back(StagedCopy{ region->buffer, dstBuffer, VkBufferCopy{ region->offset, dstOffset + written, chunkSize } });
+		written += chunkSize;
+	}
+}
+
+void VkAdapter::submitUploads()
+{
+	auto& uploads = *renderer.uploads;
+	if (!stagedCopies.empty())
+	{
+		VkCommandBuffer cmdBuffer = uploads.command_buffer();
+		for (const auto& copy : stagedCopies)
+		{
+			vkCmdCopyBuffer(cmdBuffer, copy.srcBuffer, copy.dstBuffer, 1, &copy.region);
+		}
+
+		// Frames read the ranges as vertex and index data. Only the written ranges are
+		// released, frames may be reading the rest of the pool's buffers. Chunks of one
+		// upload are adjacent and merged.
+		for (size_t i = 0; i < stagedCopies.size();)
+		{
+			const auto dstBuffer = stagedCopies[i].dstBuffer;
+			const auto offset = stagedCopies[i].region.dstOffset;
+			auto end = offset + stagedCopies[i].region.size;
+			for (++i; i < stagedCopies.size() && stagedCopies[i].dstBuffer == dstBuffer && stagedCopies[i].region.dstOffset == end; ++i)
+			{
+				end += stagedCopies[i].region.size;
+			}
+			uploads.release_buffer(dstBuffer, offset, end - offset, VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+				VK_ACCESS_VERTEX_ATTRIBUTE_READ_BIT | VK_ACCESS_INDEX_READ_BIT);
+		}
+
+		stagingRing->close_batch(uploads.open_serial());
+		ENG_LOG_TRACE("Recorded " << stagedCopies.size() << " staged copies" << std::endl);
+		stagedCopies.clear();
 	}
+
+	uploads.submit();
+	uploads.poll();
+	stagingRing->reclaim(uploads.completed_serial());
 }
 
 struct PushConstants {
@@ -44,17 +140,23 @@ struct PushConstants {
 
 void VkAdapter::recordCommandsForSceneGraph2(VkRenderer& renderer, VkCommandBuffer& commandBuffer, SceneState& sceneState)
 {
-	for (const auto& node : sceneState.graph.nodes)
+	BoundGeometry bound;
+
+	// Only nodes that survived frustum culling this frame
+	for (const auto nodeId : sceneState.visibleNodeIds)
 	{
+		if (!sceneState.graph.nodes.is_alive(nodeId)) continue;
+		const auto& node = sceneState.graph.nodes[nodeId];
+
 		if (!node.visible)
 		{
-			ENG_LOG_TRACE("Skipping draw for " << node.name << " due to visibility set to false" << std::endl);
+			ENG_LOG_TRACE("Skipping draw for " << node.name() << " due to visibility set to false" << std::endl);
 			continue;
 		}
 
 		if (!node.draw_data_idx.has_value())
 		{
-			ENG_LOG_TRACE("Skipping draw for " << node.name << " due to no DrawData" << std::endl);
+			ENG_LOG_TRACE("Skipping draw for " << node.name() << " due to no DrawData" << std::endl);
 			continue;
 		}
 
@@ -63,13 +165,13 @@ void VkAdapter::recordCommandsForSceneGraph2(VkRenderer& renderer, VkCommandBuff
 		if (!has_property(drawDataIdx, DrawDataProperties::VERTEX_BUFFERS_INITIALIZED) || 
 			!has_property(drawDataIdx, DrawDataProperties::INDEX_BUFFERS_INITIALIZED))
 		{
-			ENG_LOG_DEBUG("Skipping draw for " << node.name << " which has unbound draw data" << std::endl);
+			ENG_LOG_DEBUG("Skipping draw for " << node.name() << " which has unbound draw data" << std::endl);
 			continue;
 		}
 
 		if (!has_property(drawDataIdx, DrawDataProperties::DESCRIPTOR_SETS_INITIALIZED))
 		{
-			ENG_LOG_DEBUG("Skipping draw call for " << node.name << " uninitialized descriptor sets" << std::endl);
+			ENG_LOG_DEBUG("Skipping draw call for " << node.name() << " uninitialized descriptor sets" << std::endl);
 			continue;
 		}
 
@@ -77,25 +179,25 @@ void VkAdapter::recordCommandsForSceneGraph2(VkRenderer& renderer, VkCommandBuff
 
 		if (!drawDataCpy.descriptorSets.has_value())
 		{
-			ENG_LOG_DEBUG("Skipping draw call for " << node.name << " without descriptor sets" << std::endl);
+			ENG_LOG_DEBUG("Skipping draw call for " << node.name() << " without descriptor sets" << std::endl);
 			continue;
 		}
 
 		const auto& descriptorSets = drawDataCpy.descriptorSets.value();
 		if (descriptorSets.size() != MAX_FRAMES_IN_FLIGHT)
 		{
-			ENG_LOG_DEBUG("Skipping draw call for " << node.name << " missing descriptor sets" << std::endl);
+			ENG_LOG_DEBUG("Skipping draw call for " << node.name() << " missing descriptor sets" << std::endl);
 			continue;
 		}
 
 		if (!node.shaderId.has_value())
 		{
-			ENG_LOG_TRACE("Skipping draw for " << node.name << " due to no shaderId" << std::endl);
+			ENG_LOG_TRACE("Skipping draw for " << node.name() << " due to no shaderId" << std::endl);
 			continue;
 		}
 		const auto& shaderId = node.shaderId.value();
 
-		ENG_LOG_TRACE("Drawing " << node.name << std::endl);
+		ENG_LOG_TRACE("Drawing " << node.name() << std::endl);
 		vkCmdBindPipeline(
 				commandBuffer, 
 				VK_PIPELINE_BIND_POINT_GRAPHICS, 
@@ -120,7 +222,52 @@ void VkAdapter::recordCommandsForSceneGraph2(VkRenderer& renderer, VkCommandBuff
 				sizeof(pushConstants),
 				&pushConstants);
 
-		const auto indexedDraw = shaderId != "PosNorCol" && shaderId != "Goldberg";
-		recordDrawDataCommand(commandBuffer, drawDataCpy, indexedDraw);
+		recordDrawDataCommand(commandBuffer, *geometry, bound, drawDataCpy);
 	}
 }
+
+void VkAdapter::destroyNodeSubtree(SceneState& sceneState, ENG::Node& node)
+{
+	sceneState.graph.destroy_subtree(node, [this, &sceneState](ENG::Node& destroyed) {
+		// A node with levels of detail owns the draw data of every level, the current one included
+		if (destroyed.nodeId < sceneState.lods.size() && !sceneState.lods.at(destroyed.nodeId).empty())
+		{
+			for (const auto& level : sceneState.lods.at(destroyed.nodeId).levels())
+			{
+				releaseDrawData(level.drawDataIdx);
+			}
+			sceneState.lods.at(destroyed.nodeId) = ENG::LodGroup{};
+		}
+		else if (destroyed.draw_data_idx.has_value())
+		{
+			releaseDrawData(destroyed.draw_data_idx.value());
+		}
+
+		// Slot is reused by the next node created with this nodeId
+		if (destroyed.nodeId < sceneState.modelMatrices.size())
+		{
+			sceneState.modelMatrices.at(destroyed.nodeId) = glm::mat4(1.f);
+		}
+		if (destroyed.nodeId < sceneState.aabbs.size())
+		{
+			sceneState.aabbs.at(destroyed.nodeId) = ENG::AABB{};
+		}
+		if (destroyed.nodeId < sceneState.boundingSpheres.size())
+		{
+			sceneState.boundingSpheres.at(destroyed.nodeId) = ENG::Sphere{};
+		}
+		if (destroyed.nodeId < sceneState.pickMeshes.size())
+		{
+			sceneState.pickMeshes.at(destroyed.nodeId).reset();
+		}
+		if (destroyed.nodeId < sceneState.belowCutoff.size())
+		{
+			sceneState.belowCutoff.at(destroyed.nodeId) = 0;
+		}
+		if (sceneState.hoveredNodeId == destroyed.nodeId)
+		{
+			sceneState.hoveredNodeId.reset();
+		}
+		ENG_LOG_TRACE("Destroyed node " << destroyed.name() << " with id " << destroyed.nodeId << std::endl);
+	});
+}
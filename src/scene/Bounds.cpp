@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <cmath>
+
+#include "scene/Bounds.hpp"
+
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace ENG
+{
+
+namespace {
+
+const float* point_at(const float* positions, size_t i, size_t stride)
+{
+	return reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + i * stride);
+}
+
+void extend_scalar(const float* positions, size_t begin, size_t end, size_t stride, glm::vec3& lo, glm::vec3& hi)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		const float* p = point_at(positions, i, stride);
+		lo = glm::min(lo, glm::vec3(p[0], p[1], p[2]));
+		hi = glm::max(hi, glm::vec3(p[0], p[1], p[2]));
+	}
+}
+
+#if ENG_SIMD_X86
+
+// Each point is loaded as four floats, the fourth being whatever follows it in the vertex.
+// Only points followed by another point are loaded that way, so no read passes the buffer.
+
+ENG_TARGET_SSE41
+void extend_sse41(const float* positions, size_t count, size_t stride, glm::vec3& lo, glm::vec3& hi)
+{
+	__m128 lo0 = _mm_set_ps(0.f, lo.z, lo.y, lo.x);
+	__m128 hi0 = _mm_set_ps(0.f, hi.z, hi.y, hi.x);
+	__m128 lo1 = lo0;
+	__m128 hi1 = hi0;
+	size_t i = 0;
+	for (; i + 2 < count; i += 2)
+	{
+		const __m128 a = _mm_loadu_ps(point_at(positions, i, stride));
+		const __m128 b = _mm_loadu_ps(point_at(positions, i + 1, stride));
+		lo0 = _mm_min_ps(lo0, a);
+		hi0 = _mm_max_ps(hi0, a);
+		lo1 = _mm_min_ps(lo1, b);
+		hi1 = _mm_max_ps(hi1, b);
+	}
+
+	alignas(16) float l[4];
+	alignas(16) float h[4];
+	_mm_store_ps(l, _mm_min_ps(lo0, lo1));
+	_mm_store_ps(h, _mm_max_ps(hi0, hi1));
+	lo = glm::vec3(l[0], l[1], l[2]);
+	hi = glm::vec3(h[0], h[1], h[2]);
+	extend_scalar(positions, i, count, stride, lo, hi);
+}
+
+ENG_TARGET_AVX2
+void extend_avx2(const float* positions, size_t count, size_t stride, glm::vec3& lo, glm::vec3& hi)
+{
+	// Two points per register, four per iteration
+	const __m128 lo4 = _mm_set_ps(0.f, lo.z, lo.y, lo.x);
+	const __m128 hi4 = _mm_set_ps(0.f, hi.z, hi.y, hi.x);
+	__m256 lo0 = _mm256_set_m128(lo4, lo4);
+	__m256 hi0 = _mm256_set_m128(hi4, hi4);
+	__m256 lo1 = lo0;
+	__m256 hi1 = hi0;
+	size_t i = 0;
+	for (; i + 4 < count; i += 4)
+	{
+		const __m256 a = _mm256_loadu2_m128(point_at(positions, i + 1, stride), point_at(positions, i, stride));
+		const __m256 b = _mm256_loadu2_m128(point_at(positions, i + 3, stride), point_at(positions, i + 2, stride));
+		lo0 = _mm256_min_ps(lo0, a);
+		hi0 = _mm256_max_ps(hi0, a);
+		lo1 = _mm256_min_ps(lo1, b);
+		hi1 = _mm256_max_ps(hi1, b);
+	}
+
+	const __m256 lo8 = _mm256_min_ps(lo0, lo1);
+	const __m256 hi8 = _mm256_max_ps(hi0, hi1);
+	alignas(16) float l[4];
+	alignas(16) float h[4];
+	_mm_store_ps(l, _mm_min_ps(_mm256_castps256_ps128(lo8), _mm256_extractf128_ps(lo8, 1)));
+	_mm_store_ps(h, _mm_max_ps(_mm256_castps256_ps128(hi8), _mm256_extractf128_ps(hi8, 1)));
+	lo = glm::vec3(l[0], l[1], l[2]);
+	hi = glm::vec3(h[0], h[1], h[2]);
+	extend_scalar(positions, i, count, stride, lo, hi);
+}
+
+#endif
+
+using ExtendFn = void (*)(const float*, size_t, size_t, glm::vec3&, glm::vec3&);
+
+void extend_all_scalar(const float* positions, size_t count, size_t stride, glm::vec3& lo, glm::vec3& hi)
+{
+	extend_scalar(positions, 0, count, stride, lo, hi);
+}
+
+ExtendFn select_extend(SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level)
+	{
+	case SimdLevel::AVX2: return &extend_avx2;
+	case SimdLevel::SSE41: return &extend_sse41;
+	default: break;
+	}
+#endif
+	return &extend_all_scalar;
+}
+
+MeshBounds run_point_bounds(ExtendFn extend, const float* positions, size_t count, size_t stride)
+{
+	MeshBounds bounds;
+	if (count == 0) return bounds;
+
+	glm::vec3 lo{ std::numeric_limits<float>::max() };
+	glm::vec3 hi{ -std::numeric_limits<float>::max() };
+	extend(positions, count, stride, lo, hi);
+
+	bounds.box = make_aabb(lo, hi);
+	bounds.sphere.center = center(bounds.box);
+	bounds.sphere.radius = glm::length(extents(bounds.box));
+	return bounds;
+}
+
+} // end namespace
+
+AABB transform_aabb(const glm::mat4& transform, const AABB& local)
+{
+	if (is_empty(local)) return local;
+
+	// Transform the center, and project the extents onto each world axis through the
+	// absolute rotation-scale part (Arvo)
+	const auto c = center(local);
+	const auto e = extents(local);
+	const glm::vec3 worldCenter = glm::vec3(transform * glm::vec4(c, 1.f));
+	glm::vec3 worldExtents{ 0.f };
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		worldExtents[axis] = std::fabs(transform[0][axis]) * e.x
+			+ std::fabs(transform[1][axis]) * e.y
+			+ std::fabs(transform[2][axis]) * e.z;
+	}
+	return make_aabb(worldCenter - worldExtents, worldCenter + worldExtents);
+}
+
+bool overlaps(const AABB& box, const Sphere& sphere)
+{
+	const auto closest = glm::clamp(sphere.center, glm::vec3(box.min), glm::vec3(box.max));
+	const auto d = sphere.center - closest;
+	return glm::dot(d, d) <= sphere.radius * sphere.radius;
+}
+
+bool intersect_ray(const Ray& ray, const AABB& box, float& tEntry)
+{
+	float tMin = 0.f;
+	float tMax = ray.maxT;
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		const float origin = ray.origin[axis];
+		const float direction = ray.direction[axis];
+		if (std::fabs(direction) < 1e-12f)
+		{
+			// Parallel to the slab: hit only if the origin is between its planes
+			if (origin < box.min[axis] || origin > box.max[axis]) return false;
+			continue;
+		}
+
+		const float inv = 1.f / direction;
+		float t0 = (box.min[axis] - origin) * inv;
+		float t1 = (box.max[axis] - origin) * inv;
+		if (t0 > t1) std::swap(t0, t1);
+		tMin = std::max(tMin, t0);
+		tMax = std::min(tMax, t1);
+		if (tMin > tMax) return false;
+	}
+	tEntry = tMin;
+	return true;
+}
+
+Frustum frustum_from_matrix(const glm::mat4& m)
+{
+	// Rows of the column-major matrix (Gribb and Hartmann)
+	const auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+	const auto r0 = row(0);
+	const auto r1 = row(1);
+	const auto r2 = row(2);
+	const auto r3 = row(3);
+
+	Frustum frustum;
+	frustum.planes[0] = r3 + r0;  // left
+	frustum.planes[1] = r3 - r0;  // right
+	frustum.planes[2] = r3 + r1;  // bottom
+	frustum.planes[3] = r3 - r1;  // top
+#ifdef GLM_FORCE_DEPTH_ZERO_TO_ONE
+	frustum.planes[4] = r2;       // near
+#else
+	frustum.planes[4] = r3 + r2;  // near
+#endif
+	frustum.planes[5] = r3 - r2;  // far
+
+	for (auto& plane : frustum.planes)
+	{
+		plane /= glm::length(glm::vec3(plane));
+	}
+	return frustum;
+}
+
+Containment classify(const Frustum& frustum, const AABB& box)
+{
+	const auto c = center(box);
+	const auto e = extents(box);
+	auto result = Containment::Inside;
+	for (const auto& plane : frustum.planes)
+	{
+		const glm::vec3 normal(plane);
+		// Signed distance of the center, against the box's projected radius on the normal
+		const float distance = glm::dot(normal, c) + plane.w;
+		const float radius = glm::dot(glm::abs(normal), e);
+		if (distance < -radius) return Containment::Outside;
+		if (distance < radius) result = Containment::Intersects;
+	}
+	return result;
+}
+
+MeshBounds compute_point_bounds(const float* positions, size_t count, size_t stride)
+{
+	static const ExtendFn extend = select_extend(best_simd_level());
+	return run_point_bounds(extend, positions, count, stride);
+}
+
+MeshBounds compute_point_bounds(const float* positions, size_t count, size_t stride, SimdLevel level)
+{
+	return run_point_bounds(select_extend(level), positions, count, stride);
+}
+
+} // end namespace
@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <cassert>
+
+#include "scene/Bvh.hpp"
+
+namespace ENG
+{
+
+int32_t DynamicAabbTree::allocate_node()
+{
+	if (freeList == NULL_NODE)
+	{
+		nodes.emplace_back();
+		nodes.back().height = 0;
+		return static_cast<int32_t>(nodes.size() - 1);
+	}
+
+	const auto id = freeList;
+	freeList = nodes[id].parent;
+	nodes[id] = TreeNode{};
+	nodes[id].height = 0;
+	return id;
+}
+
+void DynamicAabbTree::free_node(int32_t id)
+{
+	nodes[id].parent = freeList;
+	nodes[id].height = -1;
+	freeList = id;
+}
+
+int32_t DynamicAabbTree::create_proxy(const AABB& box, uint32_t userData)
+{
+	const auto id = allocate_node();
+	nodes[id].box = expand(box, margin);
+	nodes[id].userData = userData;
+	insert_leaf(id);
+	++proxyCount;
+	return id;
+}
+
+void DynamicAabbTree::destroy_proxy(int32_t proxyId)
+{
+	assert(proxyId >= 0 && static_cast<size_t>(proxyId) < nodes.size());
+	assert(nodes[proxyId].is_leaf() && nodes[proxyId].height == 0);
+	remove_leaf(proxyId);
+	free_node(proxyId);
+	--proxyCount;
+}
+
+bool DynamicAabbTree::move_proxy(int32_t proxyId, const AABB& box)
+{
+	assert(proxyId >= 0 && static_cast<size_t>(proxyId) < nodes.size());
+	assert(nodes[proxyId].is_leaf());
+
+	const auto fat = expand(box, margin);
+	// Also refit when the proxy shrank well inside its fat box, so stale large boxes
+	// do not linger after a big object moves away or scales down
+	const auto huge = expand(box, 4.f * margin);
+	const auto& current = nodes[proxyId].box;
+	if (contains(current, box) && contains(huge, current))
+	{
+		return false;
+	}
+
+	remove_leaf(proxyId);
+	nodes[proxyId].box = fat;
+	insert_leaf(proxyId);
+	return true;
+}
+
+void DynamicAabbTree::clear()
+{
+	nodes.clear();
+	root = NULL_NODE;
+	freeList = NULL_NODE;
+	proxyCount = 0;
+}
+
+void DynamicAabbTree::insert_leaf(int32_t leaf)
+{
+	if (root == NULL_NODE)
+	{
+		root = leaf;
+		nodes[root].parent = NULL_NODE;
+		return;
+	}
+
+	// Descend towards the cheapest sibling: the cost of a new parent at a node is the area
+	// of the merged box, plus the growth every ancestor pays for enclosing the leaf
+	const auto leafBox = nodes[leaf].box;
+	auto index = root;
+	while (!nodes[index].is_leaf())
+	{
+		const auto child1 = nodes[index].child1;
+		const auto child2 = nodes[index].child2;
+
+		const float area = surface_area(nodes[index].box);
+		const float combinedArea = surface_area(merge(nodes[index].box, leafBox));
+		const float cost = 2.f * combinedArea;
+		const float inheritanceCost = 2.f * (combinedArea - area);
+
+		const auto childCost = [&](int32_t child) {
+			const auto merged = merge(leafBox, nodes[child].box);
+			if (nodes[child].is_leaf()) return surface_area(merged) + inheritanceCost;
+			return surface_area(merged) - surface_area(nodes[child].box) + inheritanceCost;
+		};
+		const float cost1 = childCost(child1);
+		const float cost2 = childCost(child2);
+
+		if (cost < cost1 && cost < cost2) break;
+		index = (cost1 < cost2) ? child1 : child2;
+	}
+
+	const auto sibling = index;
+	const auto oldParent = nodes[sibling].parent;
+	const auto newParent = allocate_node();
+	nodes[newParent].parent = oldParent;
+	nodes[newParent].box = merge(leafBox, nodes[sibling].box);
+	nodes[newParent].height = nodes[sibling].height + 1;
+	nodes[newParent].child1 = sibling;
+	nodes[newParent].child2 = leaf;
+	nodes[sibling].parent = newParent;
+	nodes[leaf].parent = newParent;
+
+	if (oldParent == NULL_NODE)
+	{
+		root = newParent;
+	}
+	else if (nodes[oldParent].child1 == sibling)
+	{
+		nodes[oldParent].child1 = newParent;
+	}
+	else
+	{
+		nodes[oldParent].child2 = newParent;
+	}
+
+	refit_ancestors(nodes[leaf].parent);
+}
+
+void DynamicAabbTree::remove_leaf(int32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = NULL_NODE;
+		return;
+	}
+
+	const auto parent = nodes[leaf].parent;
+	const auto grandParent = nodes[parent].parent;
+	const auto sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+	// The sibling takes the parent's place
+	if (grandParent == NULL_NODE)
+	{
+		root = sibling;
+		nodes[sibling].parent = NULL_NODE;
+	}
+	else
+	{
+		if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+		else nodes[grandParent].child2 = sibling;
+		nodes[sibling].parent = grandParent;
+		refit_ancestors(grandParent);
+	}
+	free_node(parent);
+	nodes[leaf].parent = NULL_NODE;
+}
+
+void DynamicAabbTree::refit_ancestors(int32_t id)
+{
+	while (id != NULL_NODE)
+	{
+		id = balance(id);
+
+		auto& node = nodes[id];
+		const auto& child1 = nodes[node.child1];
+		const auto& child2 = nodes[node.child2];
+		node.height = 1 + std::max(child1.height, child2.height);
+		node.box = merge(child1.box, child2.box);
+
+		id = node.parent;
+	}
+}
+
+int32_t DynamicAabbTree::balance(int32_t iA)
+{
+	auto& A = nodes[iA];
+	if (A.is_leaf() || A.height < 2) return iA;
+
+	const auto iB = A.child1;
+	const auto iC = A.child2;
+	const auto balanceFactor = nodes[iC].height - nodes[iB].height;
+
+	// Promotes the taller child of A (iUp) over A. iUp's taller child stays under iUp,
+	// A adopts the shorter one in iUp's place.
+	const auto rotateUp = [this, iA](int32_t iUp, int32_t iOther) {
+		auto& A = nodes[iA];
+		auto& up = nodes[iUp];
+		const auto iF = up.child1;
+		const auto iG = up.child2;
+
+		up.child1 = iA;
+		up.parent = A.parent;
+		A.parent = iUp;
+
+		if (up.parent == NULL_NODE) root = iUp;
+		else if (nodes[up.parent].child1 == iA) nodes[up.parent].child1 = iUp;
+		else nodes[up.parent].child2 = iUp;
+
+		const bool fTaller = nodes[iF].height > nodes[iG].height;
+		const auto iKeep = fTaller ? iF : iG;
+		const auto iMove = fTaller ? iG : iF;
+		up.child2 = iKeep;
+		if (A.child1 == iUp) A.child1 = iMove;
+		else A.child2 = iMove;
+		nodes[iMove].parent = iA;
+
+		A.box = merge(nodes[iOther].box, nodes[iMove].box);
+		A.height = 1 + std::max(nodes[iOther].height, nodes[iMove].height);
+		up.box = merge(A.box, nodes[iKeep].box);
+		up.height = 1 + std::max(A.height, nodes[iKeep].height);
+		return iUp;
+	};
+
+	if (balanceFactor > 1) return rotateUp(iC, iB);
+	if (balanceFactor < -1) return rotateUp(iB, iC);
+	return iA;
+}
+
+float DynamicAabbTree::area_ratio() const
+{
+	if (root == NULL_NODE) return 0.f;
+
+	const float rootArea = surface_area(nodes[root].box);
+	float totalArea = 0.f;
+	for (const auto& node : nodes)
+	{
+		if (node.height > 0) totalArea += surface_area(node.box);
+	}
+	return rootArea > 0.f ? totalArea / rootArea : 0.f;
+}
+
+bool DynamicAabbTree::validate() const
+{
+	if (root == NULL_NODE) return proxyCount == 0;
+
+	bool ok = nodes[root].parent == NULL_NODE;
+	validate_subtree(root, ok);
+	return ok;
+}
+
+int32_t DynamicAabbTree::validate_subtree(int32_t id, bool& ok) const
+{
+	const auto& node = nodes[id];
+	if (node.is_leaf())
+	{
+		ok &= node.height == 0 && node.child2 == NULL_NODE;
+		return 1;
+	}
+
+	const auto& child1 = nodes[node.child1];
+	const auto& child2 = nodes[node.child2];
+	ok &= child1.parent == id && child2.parent == id;
+	ok &= node.height == 1 + std::max(child1.height, child2.height);
+	ok &= contains(node.box, child1.box) && contains(node.box, child2.box);
+	return 1 + validate_subtree(node.child1, ok) + validate_subtree(node.child2, ok);
+}
+
+} // end namespace
@@ -0,0 +1,70 @@
+#include "scene/CpuFeatures.hpp"
+
+#if ENG_SIMD_X86 && defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+
+namespace ENG
+{
+
+namespace {
+
+CpuFeatures detect_cpu_features()
+{
+	CpuFeatures features{};
+#if ENG_SIMD_X86 && defined(_MSC_VER)
+	int info[4]{};
+	__cpuid(info, 0);
+	const int maxLeaf = info[0];
+
+	__cpuid(info, 1);
+	features.sse41 = (info[2] & (1 << 19)) != 0;
+	features.fma = (info[2] & (1 << 12)) != 0;
+	const bool osxsave = (info[2] & (1 << 27)) != 0;
+	const bool avx = (info[2] & (1 << 28)) != 0;
+
+	// AVX state must be enabled by the OS as well as supported by the CPU
+	const bool osAvx = osxsave && ((_xgetbv(0) & 0x6) == 0x6);
+	if (maxLeaf >= 7 && avx && osAvx)
+	{
+		__cpuidex(info, 7, 0);
+		features.avx2 = (info[1] & (1 << 5)) != 0;
+	}
+	features.fma = features.fma && osAvx;
+#elif ENG_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+	__builtin_cpu_init();
+	features.sse41 = __builtin_cpu_supports("sse4.1");
+	features.avx2 = __builtin_cpu_supports("avx2");
+	features.fma = __builtin_cpu_supports("fma");
+#endif
+	return features;
+}
+
+} // end namespace
+
+const CpuFeatures& cpu_features()
+{
+	static const CpuFeatures features = detect_cpu_features();
+	return features;
+}
+
+SimdLevel best_simd_level()
+{
+	const auto& features = cpu_features();
+	if (features.avx2 && features.fma) return SimdLevel::AVX2;
+	if (features.sse41) return SimdLevel::SSE41;
+	return SimdLevel::Scalar;
+}
+
+const char* to_string(SimdLevel level)
+{
+	switch (level)
+	{
+	case SimdLevel::AVX2: return "AVX2";
+	case SimdLevel::SSE41: return "SSE4.1";
+	default: return "Scalar";
+	}
+}
+
+} // end namespace
@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+
+#include "scene/Culling.hpp"
+
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace ENG
+{
+
+namespace {
+
+// Large enough to dominate any plane distance, small enough that the sum of three stays finite
+constexpr float UNBOUNDED_EXTENT = 1e30f;
+
+// Plane coefficients broadcast once per cull: normal, |normal| and offset
+struct PlaneSet {
+	float nx[6], ny[6], nz[6];
+	float ax[6], ay[6], az[6];
+	float w[6];
+};
+
+PlaneSet make_plane_set(const Frustum& frustum)
+{
+	PlaneSet set{};
+	for (int p = 0; p < 6; ++p)
+	{
+		const auto& plane = frustum.planes[p];
+		set.nx[p] = plane.x;
+		set.ny[p] = plane.y;
+		set.nz[p] = plane.z;
+		set.ax[p] = std::fabs(plane.x);
+		set.ay[p] = std::fabs(plane.y);
+		set.az[p] = std::fabs(plane.z);
+		set.w[p] = plane.w;
+	}
+	return set;
+}
+
+// A box is outside when, for some plane, center distance plus projected radius is negative
+bool intersects_scalar(const PlaneSet& planes, const CullingBounds& b, size_t i)
+{
+	for (int p = 0; p < 6; ++p)
+	{
+		const float d = planes.nx[p] * b.centerX[i] + planes.ny[p] * b.centerY[i] + planes.nz[p] * b.centerZ[i] + planes.w[p];
+		const float r = planes.ax[p] * b.extentX[i] + planes.ay[p] * b.extentY[i] + planes.az[p] * b.extentZ[i];
+		if (d + r < 0.f) return false;
+	}
+	return true;
+}
+
+void cull_scalar(const PlaneSet& planes, const CullingBounds& b, size_t begin, size_t end, std::vector<uint32_t>& visible)
+{
+	for (size_t i = begin; i < end; ++i)
+	{
+		if (intersects_scalar(planes, b, i)) visible.push_back(static_cast<uint32_t>(i));
+	}
+}
+
+#if ENG_SIMD_X86
+
+ENG_TARGET_SSE41
+void cull_sse41(const PlaneSet& planes, const CullingBounds& b, size_t begin, size_t end, std::vector<uint32_t>& visible)
+{
+	const __m128 zero = _mm_setzero_ps();
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		const __m128 cx = _mm_loadu_ps(b.centerX.data() + i);
+		const __m128 cy = _mm_loadu_ps(b.centerY.data() + i);
+		const __m128 cz = _mm_loadu_ps(b.centerZ.data() + i);
+		const __m128 ex = _mm_loadu_ps(b.extentX.data() + i);
+		const __m128 ey = _mm_loadu_ps(b.extentY.data() + i);
+		const __m128 ez = _mm_loadu_ps(b.extentZ.data() + i);
+
+		__m128 outside = _mm_setzero_ps();
+		for (int p = 0; p < 6; ++p)
+		{
+			__m128 d = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes.nx[p]), cx), _mm_set1_ps(planes.w[p]));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ny[p]), cy));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.nz[p]), cz));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ax[p]), ex));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.ay[p]), ey));
+			d = _mm_add_ps(d, _mm_mul_ps(_mm_set1_ps(planes.az[p]), ez));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(d, zero));
+		}
+
+		// Compact: one bit per visible lane
+		auto mask = static_cast<unsigned>(~_mm_movemask_ps(outside)) & 0xFu;
+		while (mask)
+		{
+			visible.push_back(static_cast<uint32_t>(i + std::countr_zero(mask)));
+			mask &= mask - 1;
+		}
+	}
+	cull_scalar(planes, b, i, end, visible);
+}
+
+ENG_TARGET_AVX2
+void cull_avx2(const PlaneSet& planes, const CullingBounds& b, size_t begin, size_t end, std::vector<uint32_t>& visible)
+{
+	const __m256 zero = _mm256_setzero_ps();
+	size_t i = begin;
+	for (; i + 8 <= end; i += 8)
+	{
+		const __m256 cx = _mm256_loadu_ps(b.centerX.data() + i);
+		const __m256 cy = _mm256_loadu_ps(b.centerY.data() + i);
+		const __m256 cz = _mm256_loadu_ps(b.centerZ.data() + i);
+		const __m256 ex = _mm256_loadu_ps(b.extentX.data() + i);
+		const __m256 ey = _mm256_loadu_ps(b.extentY.data() + i);
+		const __m256 ez = _mm256_loadu_ps(b.extentZ.data() + i);
+
+		__m256 outside = _mm256_setzero_ps();
+		for (int p = 0; p < 6; ++p)
+		{
+			__m256 d = _mm256_fmadd_ps(_mm256_set1_ps(planes.nx[p]), cx, _mm256_set1_ps(planes.w[p]));
+			d = _mm256_fmadd_ps(_mm256_set1_ps(planes.ny[p]), cy, d);
+			d = _mm256_fmadd_ps(_mm256_set1_ps(planes.nz[p]), cz, d);
+			d = _mm256_fmadd_ps(_mm256_set1_ps(planes.ax[p]), ex, d);
+			d = _mm256_fmadd_ps(_mm256_set1_ps(planes.ay[p]), ey, d);
+			d = _mm256_fmadd_ps(_mm256_set1_ps(planes.az[p]), ez, d);
+			outside = _mm256_or_ps(outside, _mm256_cmp_ps(d, zero, _CMP_LT_OQ));
+		}
+
+		auto mask = static_cast<unsigned>(~_mm256_movemask_ps(outside)) & 0xFFu;
+		while (mask)
+		{
+			visible.push_back(static_cast<uint32_t>(i + std::countr_zero(mask)));
+			mask &= mask - 1;
+		}
+	}
+	cull_scalar(planes, b, i, end, visible);
+}
+
+#endif
+
+// Appends the nodeIds in [begin, end) whose boxes intersect, in ascending order
+using CullFn = void (*)(const PlaneSet&, const CullingBounds&, size_t begin, size_t end, std::vector<uint32_t>&);
+
+CullFn select_cull(SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level)
+	{
+	case SimdLevel::AVX2: return &cull_avx2;
+	case SimdLevel::SSE41: return &cull_sse41;
+	default: break;
+	}
+#endif
+	return &cull_scalar;
+}
+
+CullFn best_cull()
+{
+	static const CullFn cull = select_cull(best_simd_level());
+	return cull;
+}
+
+CullStats run_cull(CullFn cull, const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible)
+{
+	visible.clear();
+	visible.reserve(bounds.size());
+	cull(make_plane_set(frustum), bounds, 0, bounds.size(), visible);
+
+	CullStats stats;
+	stats.tested = static_cast<uint32_t>(bounds.size());
+	stats.visible = static_cast<uint32_t>(visible.size());
+	stats.culled = stats.tested - stats.visible;
+	return stats;
+}
+
+} // end namespace
+
+void CullingBounds::resize(size_t count)
+{
+	centerX.resize(count, 0.f);
+	centerY.resize(count, 0.f);
+	centerZ.resize(count, 0.f);
+	extentX.resize(count, UNBOUNDED_EXTENT);
+	extentY.resize(count, UNBOUNDED_EXTENT);
+	extentZ.resize(count, UNBOUNDED_EXTENT);
+}
+
+void CullingBounds::set(uint32_t nodeId, const AABB& worldBounds)
+{
+	const auto c = center(worldBounds);
+	const auto e = extents(worldBounds);
+	centerX[nodeId] = c.x;
+	centerY[nodeId] = c.y;
+	centerZ[nodeId] = c.z;
+	extentX[nodeId] = e.x;
+	extentY[nodeId] = e.y;
+	extentZ[nodeId] = e.z;
+}
+
+void CullingBounds::set_unbounded(uint32_t nodeId)
+{
+	centerX[nodeId] = centerY[nodeId] = centerZ[nodeId] = 0.f;
+	extentX[nodeId] = extentY[nodeId] = extentZ[nodeId] = UNBOUNDED_EXTENT;
+}
+
+void CullingBounds::set_hidden(uint32_t nodeId)
+{
+	// Negative radius fails every plane
+	centerX[nodeId] = centerY[nodeId] = centerZ[nodeId] = 0.f;
+	extentX[nodeId] = extentY[nodeId] = extentZ[nodeId] = -UNBOUNDED_EXTENT;
+}
+
+bool CullingBounds::bounded(uint32_t nodeId) const
+{
+	return nodeId < size() && extentX[nodeId] >= 0.f && extentX[nodeId] < UNBOUNDED_EXTENT;
+}
+
+AABB CullingBounds::box(uint32_t nodeId) const
+{
+	const glm::vec3 c{ centerX[nodeId], centerY[nodeId], centerZ[nodeId] };
+	const glm::vec3 e{ extentX[nodeId], extentY[nodeId], extentZ[nodeId] };
+	return make_aabb(c - e, c + e);
+}
+
+void SubtreeBounds::update(const PreorderIndex& order, const CullingBounds& own, std::span<const MatrixRange> ranges)
+{
+	const auto& nodeIds = order.node_ids();
+	const auto& parentSlots = order.parent_slots();
+	const auto& subtreeEnds = order.subtree_ends();
+	const auto nodeCount = std::max(own.size(), order.slot_of_node().size());
+	if (boxes.size() < nodeCount) boxes.resize(nodeCount);
+	queued.resize(order.size(), 0);
+
+	// Every changed node and its ancestors, stopping at the first ancestor already queued
+	dirtySlots.clear();
+	for (const auto& range : ranges)
+	{
+		for (auto nodeId = range.first; nodeId < range.first + range.count; ++nodeId)
+		{
+			auto slot = order.slot_of(nodeId);
+			if (slot == PreorderIndex::NO_SLOT)
+			{
+				if (nodeId < boxes.size()) boxes[nodeId] = AABB{};
+				continue;
+			}
+			while (slot != PreorderIndex::NO_SLOT && !queued[slot])
+			{
+				queued[slot] = 1;
+				dirtySlots.push_back(slot);
+				slot = parentSlots[slot];
+			}
+		}
+	}
+
+	// Descending slots visit every child before its parent
+	std::sort(dirtySlots.begin(), dirtySlots.end(), std::greater<>());
+	for (const auto slot : dirtySlots)
+	{
+		const auto nodeId = nodeIds[slot];
+		AABB box = own.bounded(nodeId) ? own.box(nodeId) : AABB{};
+		for (auto child = slot + 1; child < subtreeEnds[slot]; child = subtreeEnds[child])
+		{
+			box = merge(box, boxes[nodeIds[child]]);
+		}
+		boxes[nodeId] = box;
+		queued[slot] = 0;
+	}
+}
+
+CullStats cull_frustum(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible)
+{
+	return run_cull(best_cull(), frustum, bounds, visible);
+}
+
+CullStats cull_frustum(const Frustum& frustum, const CullingBounds& bounds, std::vector<uint32_t>& visible, SimdLevel level)
+{
+	return run_cull(select_cull(level), frustum, bounds, visible);
+}
+
+CullStats cull_hierarchy(const Frustum& frustum, const PreorderIndex& order, const SubtreeBounds& subtrees,
+	const CullingBounds& bounds, std::vector<uint32_t>& visible)
+{
+	const auto cull = best_cull();
+	const auto planes = make_plane_set(frustum);
+	const auto& nodeIds = order.node_ids();
+	const auto& subtreeEnds = order.subtree_ends();
+	const auto slotCount = static_cast<uint32_t>(order.size());
+	visible.clear();
+	visible.reserve(slotCount);
+
+	CullStats stats;
+
+	// Nodes of straddling subtrees are collected into runs of consecutive nodeIds, which
+	// the kernel tests straight from bounds. A run is flushed before anything else is
+	// appended, so the kernel's ascending order is also preorder.
+	uint32_t runBegin = 0;
+	uint32_t runEnd = 0;
+	const auto flush = [&]() {
+		if (runBegin == runEnd) return;
+		const auto before = visible.size();
+		cull(planes, bounds, runBegin, runEnd, visible);
+		const auto passed = static_cast<uint32_t>(visible.size() - before);
+		stats.tested += runEnd - runBegin;
+		stats.culled += runEnd - runBegin - passed;
+		runBegin = runEnd = 0;
+	};
+
+	for (uint32_t slot = 0; slot < slotCount;)
+	{
+		const auto nodeId = nodeIds[slot];
+		const auto end = subtreeEnds[slot];
+		const bool hasDescendants = end > slot + 1;
+		if (hasDescendants && nodeId < subtrees.size() && !is_empty(subtrees[nodeId]))
+		{
+			++stats.tested;
+			const auto containment = classify(frustum, subtrees[nodeId]);
+			if (containment == Containment::Outside)
+			{
+				stats.culled += end - slot;
+				slot = end;
+				continue;
+			}
+			if (containment == Containment::Inside)
+			{
+				// Everything bounded is inside; only released nodeIds are left out
+				flush();
+				for (; slot < end; ++slot)
+				{
+					const auto id = nodeIds[slot];
+					if (id < bounds.size() && bounds.extentX[id] >= 0.f) visible.push_back(id);
+					else ++stats.culled;
+				}
+				continue;
+			}
+		}
+
+		// Nodes created since the last world bounds update are not reported yet
+		if (nodeId < bounds.size())
+		{
+			if (nodeId != runEnd || runBegin == runEnd)
+			{
+				flush();
+				runBegin = nodeId;
+			}
+			runEnd = nodeId + 1;
+		}
+		++slot;
+	}
+	flush();
+	stats.visible = static_cast<uint32_t>(visible.size());
+	return stats;
+}
+
+} // end namespace
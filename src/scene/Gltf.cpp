@@ -205,12 +205,12 @@ void load_gltf_mesh_attributes(
 
 		adapter.graphicsEventQueue.push(
 			BindHostMeshDataEvent{
-				HostMeshData{
+				prepare_host_mesh_data(HostMeshData{
 					std::move(vertices),
 					std::move(indices),
 					"PosColTex",
 					get_room_tex()
-				},
+				}),
 				nodeId
 			}
 		);
@@ -225,12 +225,12 @@ void load_gltf_mesh_attributes(
 
 		adapter.graphicsEventQueue.push(
 			BindHostMeshDataEvent{
-				HostMeshData{
+				prepare_host_mesh_data(HostMeshData{
 					std::move(vertices),
 					std::move(indices),
 					"PosNorTex",
 					get_room_tex()
-				},
+				}),
 				nodeId
 			}
 		);
@@ -248,7 +248,7 @@ void load_gltf_node(
 	{
 		auto* new_cam = &sceneState.graph.cameras.emplace_back(model.cameras.at(node.camera));
 		eng_node.camera = new_cam;
-		ENG_LOG_TRACE("Set camera on node with name: " << eng_node.name << std::endl);
+		ENG_LOG_TRACE("Set camera on node with name: " << eng_node.name() << std::endl);
 		ENG_LOG_TRACE("Camera address: " << eng_node.camera << std::endl);
 		ENG_LOG_TRACE("Cameras vec address: " << &sceneState.graph.cameras << std::endl);
 	}
@@ -273,17 +273,27 @@ bool load_gltf(
 		return false;
 	}
 
-	// Since we are attaching this gltf scene to ours, the node index is offset by
-	// the number of nodes loaded before this function is called
-	const auto& nodeOffset = sceneState.graph.nodes.size();
+	// Resolve the gltf hierarchy up front, so all nodes are created and linked in one batch.
+	// Nodes without a gltf parent go under the attachment point.
+	std::vector<uint32_t> batchParents(model.nodes.size(), SceneGraph::BATCH_ROOT);
+	std::vector<std::string> names;
+	names.reserve(model.nodes.size());
+	for (size_t nodeIdx = 0; nodeIdx < model.nodes.size(); ++nodeIdx) {
+		for (const auto& childIdx : model.nodes[nodeIdx].children)
+		{
+			assert(static_cast<size_t>(childIdx) < batchParents.size());
+			batchParents.at(childIdx) = static_cast<uint32_t>(nodeIdx);
+		}
+		names.push_back(model.nodes[nodeIdx].name);
+	}
+
+	const auto range = sceneState.graph.create_nodes(batchParents, &attachmentPoint);
+	sceneState.graph.set_names(range, names);
 
 	ENG_LOG_DEBUG("Nodes found:" << std::endl);
-	for (const auto& node : model.nodes) {
-		auto& newNode = sceneState.graph.create_node();
-		// Default to adding node as child of root
-		attachmentPoint.children.push_back(&newNode);
-		newNode.name = node.name;
-		newNode.parent = &attachmentPoint;	
+	for (size_t nodeIdx = 0; nodeIdx < model.nodes.size(); ++nodeIdx) {
+		const auto& node = model.nodes[nodeIdx];
+		auto& newNode = sceneState.graph.nodes[range.id(nodeIdx)];
 
 		ENG_LOG_DEBUG("\t" << node.name << "\t" << newNode.nodeId << std::endl);
 		if (node.name == "main_camera") {
@@ -294,33 +304,6 @@ bool load_gltf(
 		load_gltf_node(adapter, node, sceneState, newNode, model);
 	}
 
-	// Iterate again now that all nodes are loaded, and update parent-child relationships
-	size_t nodeCounter = 0;
-	for (const auto& node : model.nodes) {
-		if (node.children.size() > 0)
-		{
-			assert(nodeCounter + nodeOffset < sceneState.graph.nodes.size());
-			auto& engParentNode = sceneState.graph.nodes.at(nodeCounter + nodeOffset);
-			for (const auto& childIdx : node.children)
-			{
-				const auto& engNodeChildIdx = childIdx + nodeOffset;
-				assert(engNodeChildIdx < sceneState.graph.nodes.size());
-				auto& engChild = sceneState.graph.nodes.at(engNodeChildIdx);
-				// Clear child from old parent
-				if (engChild.parent)
-				{
-					std::erase_if(engChild.parent->children, [engNodeChildIdx](const ENG::Node* oldParentChild) {
-							return (oldParentChild->nodeId == engNodeChildIdx);
-						});
-				}
-
-				engParentNode.children.push_back(&engChild);
-				engChild.parent = &engParentNode;
-			}
-		}
-		nodeCounter++;
-	}
-
 	return true;
 }
 
@@ -1,74 +1,149 @@
 /*
 * Implementation of ray-polygon intersection based on Jordan Curve Theorem (JCT)
-* 
+*
 * Ref. Projective Geometric Algebra Illuminated, Section 1.3 Lines and Planes - Lengyel
 */
 
+#include<algorithm>
+#include<bit>
+#include<cassert>
+#include<cmath>
+#include<stdexcept>
+#include<string>
 #include<vector>
 #include<optional>
 #include<glm/glm.hpp>
 #include "scene/JCT.hpp"
 
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/**
+ * Newell's method: the area weighted normal of a planar polygon. Unlike the cross product of the
+ * first two edges it also has the right orientation when the second vertex is a reflex vertex.
+ */
+glm::vec3 polygon_normal(std::span<const glm::vec3> polygon)
+{
+	glm::vec3 normal{ 0.f };
+	for (size_t i = 0; i < polygon.size(); ++i) {
+		normal += glm::cross(polygon[i], polygon[(i + 1) % polygon.size()]);
+	}
+	return normal;
+}
+
+} // end namespace
+
 
 /**
  * Tests if ray intersects with a polygon using the Jordan Curve Theorem (JCT)
  */
 bool ray_polygon_intersection(const glm::vec3 ray_origin, const glm::vec3 ray_direction, const std::vector<glm::vec3>& line_strip)
+{
+	float distance;
+	return ray_polygon_intersection(ray_origin, ray_direction, line_strip, distance);
+}
+
+bool ray_polygon_intersection(const glm::vec3 ray_origin, const glm::vec3 ray_direction, const std::vector<glm::vec3>& line_strip, float& distance)
 {
 	// must have at least 3 points to define a closed polygon
 	assert(line_strip.size() >= 3);
 
-	// calculate plane equation for initial plane intersection test
-	const auto& start = line_strip.at(0);
-	const auto& end1 = line_strip.at(1);
-	const auto& end2 = line_strip.at(2);
-
 	// ccw winding order
-	const auto& normal = glm::normalize(glm::cross((end1 - start), (end2 - start)));
+	const auto& areaNormal = polygon_normal(line_strip);
+	const auto area = glm::length(areaNormal);
+	if (!(area > 0.f)) {
+		return false;  // degenerate polygon
+	}
+	const auto& normal = areaNormal / area;
 
 	// if dot product is positive or zero, ray does not intersect plane of the polygon
 	if (glm::dot(ray_direction, normal) >= 0) {
 		return false;
 	}
 
-	const auto& pointOfIntersection = ray_plane_intersection(ray_origin, ray_direction, start, normal);
+	const auto& pointOfIntersection = ray_plane_intersection(ray_origin, ray_direction, line_strip.front(), normal);
 	if (!pointOfIntersection.has_value()) [[unlikely]] {
 		return false;
 	}
 
-	// Draw a line in an arbitrary direction on the plane from the point of intersection
-	// This is the line for the JCT algorithm to count intersections with line segments of the bounding polygon
-	const auto& arbitraryPointOnPlane = start + 0.67f * (end1 - start);  // a point 2/3 between first two points on polygon
-	const auto& arbitraryLineDirection = glm::normalize(arbitraryPointOnPlane - pointOfIntersection.value());
-
-	// iterate over line segments in bounding polygon with CCW order checking for intersection with
-	// chosen arbitrary line on plane
-	auto intersectionCount{0};
-	for (int i = 0; i < line_strip.size() - 1; ++i) {
-		const auto& segmentStart = line_strip.at(i);
-		const auto& segmentEnd = line_strip.at(i + 1);
-		const auto& segmentDirection = segmentEnd - segmentStart;
-		const auto& segmentLength = glm::length(segmentDirection);
+	// Project onto the coordinate plane the polygon is least foreshortened in. The projection
+	// keeps the crossing count, and counting in 2D avoids any 3D line-line tolerances.
+	const auto absNormal = glm::abs(normal);
+	const int dropped = absNormal.x >= absNormal.y && absNormal.x >= absNormal.z ? 0 : (absNormal.y >= absNormal.z ? 1 : 2);
+	const int uAxis = (dropped + 1) % 3;
+	const int vAxis = (dropped + 2) % 3;
+	const float pu = pointOfIntersection.value()[uAxis];
+	const float pv = pointOfIntersection.value()[vAxis];
 
-		return false; // TODO finish
+	// Cast a line from the point of intersection along +u and count the boundary segments it
+	// crosses; an odd count means the point is inside. Segments are half-open in v, so a line
+	// through a vertex counts it once, and a repeated closing vertex adds nothing.
+	bool inside = false;
+	for (size_t i = 0; i < line_strip.size(); ++i) {
+		const auto& segmentStart = line_strip[i];
+		const auto& segmentEnd = line_strip[(i + 1) % line_strip.size()];
+		const float su = segmentStart[uAxis], sv = segmentStart[vAxis];
+		const float eu = segmentEnd[uAxis], ev = segmentEnd[vAxis];
+		if ((sv > pv) == (ev > pv)) {
+			continue;
+		}
+		const float crossingU = su + (pv - sv) / (ev - sv) * (eu - su);
+		if (crossingU > pu) {
+			inside = !inside;
+		}
+	}
+	if (!inside) {
+		return false;
 	}
 
-	return false;
+	distance = glm::dot(pointOfIntersection.value() - ray_origin, ray_direction) / glm::dot(ray_direction, ray_direction);
+	return true;
 }
 
+/**
+ * Ray-segment intersection for a ray and segment in the same plane
+ *
+ * Solves for the closest points of the two lines, then accepts them if they lie on the ray and
+ * the segment and coincide up to float rounding.
+ */
 std::optional<glm::vec3> ray_line_intersection(const glm::vec3& ray_origin, const glm::vec3& ray_direction, const glm::vec3& segment_start, const glm::vec3& segment_end) {
 	const auto& segmentVector = segment_end - segment_start;
-	const auto& segmentLength = glm::length(segmentVector);
-	const auto& segmentUnitVector = glm::normalize(segmentVector);
+	const auto& offset = ray_origin - segment_start;
 
-	// TODO finish
-	return {};
+	const float a = glm::dot(ray_direction, ray_direction);
+	const float b = glm::dot(ray_direction, segmentVector);
+	const float c = glm::dot(segmentVector, segmentVector);
+	const float d = glm::dot(ray_direction, offset);
+	const float e = glm::dot(segmentVector, offset);
+
+	// parallel or degenerate lines have no single crossing
+	const float denom = a * c - b * b;
+	if (!(denom > 1E-12f * a * c)) {
+		return {};
+	}
+
+	const float rayParameter = (b * e - c * d) / denom;
+	const float segmentParameter = (a * e - b * d) / denom;
+	if (rayParameter < 0.f || segmentParameter < 0.f || segmentParameter > 1.f) {
+		return {};
+	}
+
+	const auto& onRay = ray_origin + rayParameter * ray_direction;
+	const auto& onSegment = segment_start + segmentParameter * segmentVector;
+	const float scale = std::max({ glm::length(offset), std::sqrt(c), rayParameter * std::sqrt(a), 1.f });
+	if (glm::length(onRay - onSegment) > 1E-5f * scale) {
+		return {};  // skew lines, the ray passes above or below the segment
+	}
+	return { onSegment };
 }
 
 
 /**
 * Ray-plane intersection algorithm
-* 
+*
 * If ray intersects plane, then returns the point of intersection, otherwise returns empty
 */
 std::optional<glm::vec3> ray_plane_intersection(const glm::vec3& ray_origin, const glm::vec3& ray_direction, const glm::vec3& plane_p0, const glm::vec3& plane_normal) {
@@ -88,3 +163,186 @@ std::optional<glm::vec3> ray_plane_intersection(const glm::vec3& ray_origin, con
 
 	return {};
 }
+
+
+namespace {
+
+using Block = PolygonBatch::Block;
+
+// Closest hit so far across all blocks
+struct BatchHit {
+	float t;
+	uint32_t polygon;
+};
+
+using BatchFn = void (*)(const Block*, size_t, const glm::vec3&, const glm::vec3&, BatchHit&);
+
+void keep_closest(const float* t, uint32_t mask, uint32_t firstPolygon, BatchHit& best)
+{
+	while (mask != 0) {
+		const int lane = std::countr_zero(mask);
+		mask &= mask - 1;
+		if (t[lane] <= best.t) {
+			best = { t[lane], firstPolygon + lane };
+		}
+	}
+}
+
+void intersect_scalar(const Block* blocks, size_t blockCount, const glm::vec3& o, const glm::vec3& dir, BatchHit& best)
+{
+	for (size_t b = 0; b < blockCount; ++b) {
+		const auto& block = blocks[b];
+		for (uint32_t lane = 0; lane < 8; ++lane) {
+			const float denom = block.nx[lane] * dir.x + block.ny[lane] * dir.y + block.nz[lane] * dir.z;
+			const float t = (block.d[lane] - (block.nx[lane] * o.x + block.ny[lane] * o.y + block.nz[lane] * o.z)) / denom;
+			if (!(t >= 0.f && t <= best.t)) continue;  // also rejects the NaN of padding and edge-on rays
+
+			const auto p = o + t * dir;
+			bool inside = true;
+			for (uint32_t k = 0; k < POLYGON_BATCH_MAX_VERTICES && inside; ++k) {
+				inside = block.ex[k][lane] * p.x + block.ey[k][lane] * p.y + block.ez[k][lane] * p.z >= block.c[k][lane];
+			}
+			if (inside) {
+				best = { t, static_cast<uint32_t>(8 * b + lane) };
+			}
+		}
+	}
+}
+
+#if ENG_SIMD_X86
+
+ENG_TARGET_SSE41
+void intersect_sse41(const Block* blocks, size_t blockCount, const glm::vec3& o, const glm::vec3& dir, BatchHit& best)
+{
+	const __m128 ox = _mm_set1_ps(o.x), oy = _mm_set1_ps(o.y), oz = _mm_set1_ps(o.z);
+	const __m128 dx = _mm_set1_ps(dir.x), dy = _mm_set1_ps(dir.y), dz = _mm_set1_ps(dir.z);
+	const __m128 zero = _mm_setzero_ps();
+	alignas(16) float t[4];
+	for (size_t b = 0; b < blockCount; ++b) {
+		const auto& block = blocks[b];
+		for (uint32_t half = 0; half < 8; half += 4) {
+			const __m128 nx = _mm_load_ps(block.nx + half), ny = _mm_load_ps(block.ny + half), nz = _mm_load_ps(block.nz + half);
+			const __m128 denom = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, dx), _mm_mul_ps(ny, dy)), _mm_mul_ps(nz, dz));
+			const __m128 nDotO = _mm_add_ps(_mm_add_ps(_mm_mul_ps(nx, ox), _mm_mul_ps(ny, oy)), _mm_mul_ps(nz, oz));
+			const __m128 tv = _mm_div_ps(_mm_sub_ps(_mm_load_ps(block.d + half), nDotO), denom);
+			__m128 hit = _mm_and_ps(_mm_cmpge_ps(tv, zero), _mm_cmple_ps(tv, _mm_set1_ps(best.t)));
+			if (_mm_movemask_ps(hit) == 0) continue;
+
+			const __m128 px = _mm_add_ps(ox, _mm_mul_ps(tv, dx));
+			const __m128 py = _mm_add_ps(oy, _mm_mul_ps(tv, dy));
+			const __m128 pz = _mm_add_ps(oz, _mm_mul_ps(tv, dz));
+			for (uint32_t k = 0; k < POLYGON_BATCH_MAX_VERTICES; ++k) {
+				const __m128 side = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_load_ps(block.ex[k] + half), px),
+					_mm_mul_ps(_mm_load_ps(block.ey[k] + half), py)), _mm_mul_ps(_mm_load_ps(block.ez[k] + half), pz));
+				hit = _mm_and_ps(hit, _mm_cmpge_ps(side, _mm_load_ps(block.c[k] + half)));
+			}
+			const auto mask = static_cast<uint32_t>(_mm_movemask_ps(hit));
+			if (mask == 0) continue;
+			_mm_store_ps(t, tv);
+			keep_closest(t, mask, static_cast<uint32_t>(8 * b + half), best);
+		}
+	}
+}
+
+ENG_TARGET_AVX2
+void intersect_avx2(const Block* blocks, size_t blockCount, const glm::vec3& o, const glm::vec3& dir, BatchHit& best)
+{
+	const __m256 ox = _mm256_set1_ps(o.x), oy = _mm256_set1_ps(o.y), oz = _mm256_set1_ps(o.z);
+	const __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+	const __m256 zero = _mm256_setzero_ps();
+	alignas(32) float t[8];
+	for (size_t b = 0; b < blockCount; ++b) {
+		const auto& block = blocks[b];
+		const __m256 nx = _mm256_load_ps(block.nx), ny = _mm256_load_ps(block.ny), nz = _mm256_load_ps(block.nz);
+		const __m256 denom = _mm256_fmadd_ps(nx, dx, _mm256_fmadd_ps(ny, dy, _mm256_mul_ps(nz, dz)));
+		const __m256 nDotO = _mm256_fmadd_ps(nx, ox, _mm256_fmadd_ps(ny, oy, _mm256_mul_ps(nz, oz)));
+		const __m256 tv = _mm256_div_ps(_mm256_sub_ps(_mm256_load_ps(block.d), nDotO), denom);
+		__m256 hit = _mm256_and_ps(_mm256_cmp_ps(tv, zero, _CMP_GE_OQ), _mm256_cmp_ps(tv, _mm256_set1_ps(best.t), _CMP_LE_OQ));
+		if (_mm256_movemask_ps(hit) == 0) continue;
+
+		const __m256 px = _mm256_fmadd_ps(tv, dx, ox);
+		const __m256 py = _mm256_fmadd_ps(tv, dy, oy);
+		const __m256 pz = _mm256_fmadd_ps(tv, dz, oz);
+		for (uint32_t k = 0; k < POLYGON_BATCH_MAX_VERTICES; ++k) {
+			const __m256 side = _mm256_fmadd_ps(_mm256_load_ps(block.ex[k]), px,
+				_mm256_fmadd_ps(_mm256_load_ps(block.ey[k]), py, _mm256_mul_ps(_mm256_load_ps(block.ez[k]), pz)));
+			hit = _mm256_and_ps(hit, _mm256_cmp_ps(side, _mm256_load_ps(block.c[k]), _CMP_GE_OQ));
+		}
+		const auto mask = static_cast<uint32_t>(_mm256_movemask_ps(hit));
+		if (mask == 0) continue;
+		_mm256_store_ps(t, tv);
+		keep_closest(t, mask, static_cast<uint32_t>(8 * b), best);
+	}
+}
+
+#endif
+
+BatchFn select_intersect(ENG::SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level) {
+	case ENG::SimdLevel::AVX2: return &intersect_avx2;
+	case ENG::SimdLevel::SSE41: return &intersect_sse41;
+	default: break;
+	}
+#endif
+	return &intersect_scalar;
+}
+
+std::optional<PolygonHit> run_intersect(BatchFn fn, const std::vector<Block>& blocks, const glm::vec3& origin, const glm::vec3& direction, float maxT)
+{
+	BatchHit best{ maxT, UINT32_MAX };
+	fn(blocks.data(), blocks.size(), origin, direction, best);
+	if (best.polygon == UINT32_MAX) return std::nullopt;
+	return PolygonHit{ best.polygon, best.t };
+}
+
+} // end namespace
+
+PolygonBatch::PolygonBatch(std::span<const uint32_t> offsets, std::span<const glm::vec3> vertices)
+{
+	if (offsets.size() < 2) return;
+	if (offsets.back() > vertices.size()) {
+		throw std::runtime_error("PolygonBatch: polygon offsets run past the vertex count");
+	}
+
+	polygonCount = offsets.size() - 1;
+	// Padding polygons keep a zero plane, whose intersection is NaN and never hits
+	blocks.resize((polygonCount + 7) / 8, Block{});
+	for (size_t polygon = 0; polygon < polygonCount; ++polygon) {
+		if (offsets[polygon + 1] < offsets[polygon] + 3 || offsets[polygon + 1] - offsets[polygon] > POLYGON_BATCH_MAX_VERTICES) {
+			throw std::runtime_error("PolygonBatch: polygon " + std::to_string(polygon) + " must have 3 to "
+				+ std::to_string(POLYGON_BATCH_MAX_VERTICES) + " vertices");
+		}
+		const auto corners = vertices.subspan(offsets[polygon], offsets[polygon + 1] - offsets[polygon]);
+		const auto normal = glm::normalize(polygon_normal(corners));
+
+		auto& block = blocks[polygon / 8];
+		const auto lane = polygon % 8;
+		block.nx[lane] = normal.x;
+		block.ny[lane] = normal.y;
+		block.nz[lane] = normal.z;
+		block.d[lane] = glm::dot(normal, corners[0]);
+		for (size_t k = 0; k < POLYGON_BATCH_MAX_VERTICES; ++k) {
+			// Missing corners repeat the last one: a zero edge plane, 0 >= 0 always passes
+			const auto& a = corners[std::min(k, corners.size() - 1)];
+			const auto& b = k + 1 < corners.size() ? corners[k + 1] : (k + 1 == corners.size() ? corners[0] : a);
+			const auto inward = glm::cross(normal, b - a);
+			block.ex[k][lane] = inward.x;
+			block.ey[k][lane] = inward.y;
+			block.ez[k][lane] = inward.z;
+			block.c[k][lane] = glm::dot(inward, a);
+		}
+	}
+}
+
+std::optional<PolygonHit> PolygonBatch::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT) const
+{
+	static const auto fn = select_intersect(ENG::best_simd_level());
+	return run_intersect(fn, blocks, origin, direction, maxT);
+}
+
+std::optional<PolygonHit> PolygonBatch::intersect(const glm::vec3& origin, const glm::vec3& direction, float maxT, ENG::SimdLevel level) const
+{
+	return run_intersect(select_intersect(level), blocks, origin, direction, maxT);
+}
@@ -0,0 +1,69 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "scene/Lod.hpp"
+
+namespace ENG
+{
+
+void LodGroup::add_level(size_t drawDataIdx, float minScreenSize)
+{
+	const auto at = std::find_if(lodLevels.begin(), lodLevels.end(),
+		[minScreenSize](const LodLevel& level) { return level.minScreenSize < minScreenSize; });
+	lodLevels.insert(at, { drawDataIdx, minScreenSize });
+}
+
+bool below_cutoff(float screenSize, bool wasCulled, const LodSettings& settings)
+{
+	const float band = wasCulled ? 1.f + settings.hysteresis : 1.f - settings.hysteresis;
+	return screenSize < settings.minScreenSize * band;
+}
+
+uint32_t LodGroup::select(float screenSize, const LodSettings& settings)
+{
+	if (lodLevels.empty()) return LOD_CULLED;
+
+	const float below = 1.f - settings.hysteresis;
+	const float above = 1.f + settings.hysteresis;
+	const auto coarsest = static_cast<uint32_t>(lodLevels.size() - 1);
+
+	const bool wasCulled = currentLevel == LOD_CULLED;
+	if (below_cutoff(screenSize, wasCulled, settings))
+	{
+		currentLevel = LOD_CULLED;
+		return LOD_CULLED;
+	}
+	if (wasCulled)
+	{
+		currentLevel = coarsest;
+	}
+
+	// Levels may have been added since the last selection
+	currentLevel = std::min(currentLevel, coarsest);
+	while (currentLevel < coarsest && screenSize < lodLevels[currentLevel].minScreenSize * below) ++currentLevel;
+	while (currentLevel > 0 && screenSize >= lodLevels[currentLevel - 1].minScreenSize * above) --currentLevel;
+	return currentLevel;
+}
+
+Sphere transform_sphere(const glm::mat4& model, const Sphere& sphere)
+{
+	const float scale = std::max({ glm::length(glm::vec3(model[0])), glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2])) });
+	return { glm::vec3(model * glm::vec4(sphere.center, 1.f)), sphere.radius * scale };
+}
+
+float projected_screen_size(const Sphere& worldSphere, const glm::vec3& cameraPosition, const glm::mat4& projection)
+{
+	// proj[1][1] is cot(fovy / 2) for perspective and 2 / height for orthographic projections,
+	// negated when the projection flips y for Vulkan
+	const float scaleY = std::fabs(projection[1][1]);
+	const bool perspective = projection[2][3] != 0.f;
+	if (!perspective) return worldSphere.radius * scaleY;
+
+	const float distance = glm::length(worldSphere.center - cameraPosition);
+	if (distance <= worldSphere.radius) return std::numeric_limits<float>::max();
+	// Half angle of the cone tangent to the sphere, as a fraction of the half field of view
+	return worldSphere.radius / std::sqrt(distance * distance - worldSphere.radius * worldSphere.radius) * scaleY;
+}
+
+} // end namespace
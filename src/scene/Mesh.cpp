@@ -1,10 +1,25 @@
 #include<vector>
+#include<cstddef>
+#include<span>
 #include "vulkan/vulkan_core.h"
 #include "scene/Mesh.hpp"
 #include "logger/Logging.hpp"
 
 namespace ENG
 {
+	HostMeshData prepare_host_mesh_data(HostMeshData&& meshData) {
+		std::visit([&meshData](const auto& vertices) {
+			using Vertex = typename std::decay_t<decltype(vertices)>::value_type;
+			static_assert(offsetof(Vertex, pos) == 0, "positions are read from the start of each vertex");
+			const float* positions = vertices.empty() ? nullptr : &vertices.front().pos.x;
+			meshData.localBounds = compute_point_bounds(positions, vertices.size(), sizeof(Vertex));
+			const auto indices = draws_indexed(meshData.indexBuffer.size())
+				? std::span<const uint32_t>(meshData.indexBuffer) : std::span<const uint32_t>{};
+			meshData.pickMesh = std::make_shared<const TriangleBvh>(positions, vertices.size(), sizeof(Vertex), indices);
+		}, meshData.vertexBuffer);
+		return std::move(meshData);
+	}
+
 	template<>
 	std::vector<VkVertexInputAttributeDescription> Mesh::getAttributeDescriptions<VertexPosColTex>() {
 		std::vector<VkVertexInputAttributeDescription> attributeDescriptions{ 3 };
@@ -0,0 +1,58 @@
+#include <cassert>
+#include <mutex>
+
+#include "scene/NameTable.hpp"
+
+namespace ENG
+{
+
+NameTable::NameTable()
+{
+	strings.emplace_back();
+	symbols.emplace(strings.back(), EMPTY_NAME);
+}
+
+NameSymbol NameTable::intern(std::string_view name)
+{
+	{
+		std::shared_lock lock(mut);
+		if (const auto it = symbols.find(name); it != symbols.end()) return it->second;
+	}
+
+	std::unique_lock lock(mut);
+	// Another thread may have added it between the two locks
+	if (const auto it = symbols.find(name); it != symbols.end()) return it->second;
+
+	const auto symbol = static_cast<NameSymbol>(strings.size());
+	strings.emplace_back(name);
+	symbols.emplace(strings.back(), symbol);
+	return symbol;
+}
+
+std::optional<NameSymbol> NameTable::find(std::string_view name) const
+{
+	std::shared_lock lock(mut);
+	if (const auto it = symbols.find(name); it != symbols.end()) return it->second;
+	return std::nullopt;
+}
+
+const std::string& NameTable::str(NameSymbol symbol) const
+{
+	std::shared_lock lock(mut);
+	assert(symbol < strings.size());
+	return strings[symbol];
+}
+
+size_t NameTable::size() const
+{
+	std::shared_lock lock(mut);
+	return strings.size();
+}
+
+NameTable& node_names()
+{
+	static NameTable table;
+	return table;
+}
+
+} // end namespace
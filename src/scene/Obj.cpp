@@ -39,13 +39,20 @@ void loadModel(
 
 	std::unordered_map<std::filesystem::path, std::vector<VertexPosColTex>> vertices;
 	std::unordered_map<std::filesystem::path, std::vector<uint32_t>> indices;
+
+	// One node per shape, created and named in a single batch
+	std::vector<std::string> nodeNames;
+	nodeNames.reserve(shapes.size());
+	for (size_t shapeIdx = 0; shapeIdx < shapes.size(); ++shapeIdx) {
+		nodeNames.push_back(name + "-" + std::to_string(shapeIdx));
+	}
+	const auto range = sceneState.graph.create_nodes(shapes.size(), &attachmentPoint);
+	sceneState.graph.set_names(range, nodeNames);
+
 	auto idx = 0;
 	for (const auto& shape : shapes) {
 
-		auto& newNode = sceneState.graph.create_node();
-		newNode.name = name + "-" + std::to_string(idx++);
-		newNode.parent = &attachmentPoint;
-		attachmentPoint.children.push_back(&newNode);
+		auto& newNode = sceneState.graph.nodes[range.id(idx++)];
 		
 		// assumes material id is always the same per shape
 		if (shape.mesh.material_ids.empty()) {
@@ -82,12 +89,12 @@ void loadModel(
 
 		adapter.graphicsEventQueue.push(
 			BindHostMeshDataEvent{
-				HostMeshData {
+				prepare_host_mesh_data(HostMeshData {
 					std::move(vertices.at(texPath)),
 					std::move(indices.at(texPath)),
 					"PosColTex",
 					texPath
-				},
+				}),
 				newNode.nodeId
 			}
 		);
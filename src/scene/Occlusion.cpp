@@ -0,0 +1,304 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "scene/Occlusion.hpp"
+
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+// AVX2 without FMA: contracting a * b + c would round differently from the scalar and SSE
+// paths and break bit identical depth images
+#if ENG_SIMD_X86 && (defined(__GNUC__) || defined(__clang__))
+#define ENG_TARGET_AVX2_NO_FMA __attribute__((target("avx2")))
+#else
+#define ENG_TARGET_AVX2_NO_FMA
+#endif
+
+namespace ENG
+{
+
+namespace {
+
+constexpr float FAR_DEPTH = 1.f;
+
+// Smallest clip w accepted in front of the camera; anything nearer crosses the near plane
+constexpr float MIN_CLIP_W = 1e-5f;
+
+// Edge functions and depth plane of a screen space triangle, evaluated as a * x + row term
+struct TriangleSetup {
+	float edgeA[3];
+	float edgeB[3];
+	float edgeC[3];
+	float depthA;
+	float depthB;
+	float depthC;
+};
+
+// Span of one row: pixels [x0, x1) with rowEdge[i] = edgeB[i] * py + edgeC[i] precomputed,
+// so every path evaluates exactly the same operations per pixel
+using SpanFn = void (*)(float*, uint32_t, uint32_t, const TriangleSetup&, const float*, float);
+
+void span_scalar(float* row, uint32_t x0, uint32_t x1, const TriangleSetup& tri, const float* rowEdge, float rowDepth)
+{
+	for (uint32_t x = x0; x < x1; ++x)
+	{
+		const float px = static_cast<float>(x) + 0.5f;
+		const float e0 = tri.edgeA[0] * px + rowEdge[0];
+		const float e1 = tri.edgeA[1] * px + rowEdge[1];
+		const float e2 = tri.edgeA[2] * px + rowEdge[2];
+		const float z = tri.depthA * px + rowDepth;
+		if (e0 >= 0.f && e1 >= 0.f && e2 >= 0.f && z < row[x]) row[x] = z;
+	}
+}
+
+#if ENG_SIMD_X86
+
+ENG_TARGET_SSE41
+void span_sse41(float* row, uint32_t x0, uint32_t x1, const TriangleSetup& tri, const float* rowEdge, float rowDepth)
+{
+	const __m128 a0 = _mm_set1_ps(tri.edgeA[0]), a1 = _mm_set1_ps(tri.edgeA[1]), a2 = _mm_set1_ps(tri.edgeA[2]);
+	const __m128 r0 = _mm_set1_ps(rowEdge[0]), r1 = _mm_set1_ps(rowEdge[1]), r2 = _mm_set1_ps(rowEdge[2]);
+	const __m128 da = _mm_set1_ps(tri.depthA), dr = _mm_set1_ps(rowDepth);
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 laneOffsets = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+
+	// The buffer width is a multiple of 8, so whole vectors never leave the row. Lanes outside
+	// [x0, x1) are masked off so the image matches the scalar path exactly.
+	const __m128 spanMin = _mm_set1_ps(static_cast<float>(x0)), spanMax = _mm_set1_ps(static_cast<float>(x1));
+	for (uint32_t x = x0 & ~3u; x < x1; x += 4)
+	{
+		const __m128 px = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), laneOffsets);
+		const __m128 e0 = _mm_add_ps(_mm_mul_ps(a0, px), r0);
+		const __m128 e1 = _mm_add_ps(_mm_mul_ps(a1, px), r1);
+		const __m128 e2 = _mm_add_ps(_mm_mul_ps(a2, px), r2);
+		const __m128 z = _mm_add_ps(_mm_mul_ps(da, px), dr);
+		const __m128 old = _mm_loadu_ps(row + x);
+		__m128 write = _mm_and_ps(_mm_cmpgt_ps(px, spanMin), _mm_cmplt_ps(px, spanMax));
+		write = _mm_and_ps(write, _mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)));
+		write = _mm_and_ps(write, _mm_cmpge_ps(e2, zero));
+		write = _mm_and_ps(write, _mm_cmplt_ps(z, old));
+		_mm_storeu_ps(row + x, _mm_blendv_ps(old, z, write));
+	}
+}
+
+ENG_TARGET_AVX2_NO_FMA
+void span_avx2(float* row, uint32_t x0, uint32_t x1, const TriangleSetup& tri, const float* rowEdge, float rowDepth)
+{
+	const __m256 a0 = _mm256_set1_ps(tri.edgeA[0]), a1 = _mm256_set1_ps(tri.edgeA[1]), a2 = _mm256_set1_ps(tri.edgeA[2]);
+	const __m256 r0 = _mm256_set1_ps(rowEdge[0]), r1 = _mm256_set1_ps(rowEdge[1]), r2 = _mm256_set1_ps(rowEdge[2]);
+	const __m256 da = _mm256_set1_ps(tri.depthA), dr = _mm256_set1_ps(rowDepth);
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 laneOffsets = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+
+	const __m256 spanMin = _mm256_set1_ps(static_cast<float>(x0)), spanMax = _mm256_set1_ps(static_cast<float>(x1));
+	for (uint32_t x = x0 & ~7u; x < x1; x += 8)
+	{
+		const __m256 px = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), laneOffsets);
+		const __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, px), r0);
+		const __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, px), r1);
+		const __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, px), r2);
+		const __m256 z = _mm256_add_ps(_mm256_mul_ps(da, px), dr);
+		const __m256 old = _mm256_loadu_ps(row + x);
+		__m256 write = _mm256_and_ps(_mm256_cmp_ps(px, spanMin, _CMP_GT_OQ), _mm256_cmp_ps(px, spanMax, _CMP_LT_OQ));
+		write = _mm256_and_ps(write, _mm256_and_ps(_mm256_cmp_ps(e0, zero, _CMP_GE_OQ), _mm256_cmp_ps(e1, zero, _CMP_GE_OQ)));
+		write = _mm256_and_ps(write, _mm256_cmp_ps(e2, zero, _CMP_GE_OQ));
+		write = _mm256_and_ps(write, _mm256_cmp_ps(z, old, _CMP_LT_OQ));
+		_mm256_storeu_ps(row + x, _mm256_blendv_ps(old, z, write));
+	}
+}
+
+#endif
+
+SpanFn select_span(SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level)
+	{
+	case SimdLevel::AVX2: return &span_avx2;
+	case SimdLevel::SSE41: return &span_sse41;
+	default: break;
+	}
+#endif
+	return &span_scalar;
+}
+
+// Screen position and depth of a vertex, or false if it is not in front of the near plane
+bool to_screen(const glm::mat4& clipFromModel, const glm::vec3& p, uint32_t width, uint32_t height, glm::vec3& screen)
+{
+	const auto clip = clipFromModel * glm::vec4(p, 1.f);
+	if (!(clip.w >= MIN_CLIP_W)) return false;
+	const float invW = 1.f / clip.w;
+	screen.x = (clip.x * invW * 0.5f + 0.5f) * static_cast<float>(width);
+	screen.y = (clip.y * invW * 0.5f + 0.5f) * static_cast<float>(height);
+	screen.z = clip.z * invW;
+	return true;
+}
+
+void rasterize_mesh(const SpanFn span, const glm::mat4& clipFromModel, const TriangleBvh& mesh,
+	uint32_t width, uint32_t height, std::vector<float>& depthImage)
+{
+	for (uint32_t i = 0; i < mesh.triangle_count(); ++i)
+	{
+		const auto& source = mesh.triangle(i);
+		glm::vec3 v[3];
+		if (!to_screen(clipFromModel, source.v0, width, height, v[0])
+			|| !to_screen(clipFromModel, source.v0 + source.edge1, width, height, v[1])
+			|| !to_screen(clipFromModel, source.v0 + source.edge2, width, height, v[2]))
+		{
+			continue;  // not clipped; a skipped occluder only hides less
+		}
+
+		float area = (v[1].x - v[0].x) * (v[2].y - v[0].y) - (v[2].x - v[0].x) * (v[1].y - v[0].y);
+		if (!(std::fabs(area) > 1e-12f)) continue;
+		if (area < 0.f)
+		{
+			std::swap(v[1], v[2]);  // both faces occlude
+			area = -area;
+		}
+
+		const float xMin = std::min({ v[0].x, v[1].x, v[2].x });
+		const float xMax = std::max({ v[0].x, v[1].x, v[2].x });
+		const float yMin = std::min({ v[0].y, v[1].y, v[2].y });
+		const float yMax = std::max({ v[0].y, v[1].y, v[2].y });
+		if (xMax < 0.f || yMax < 0.f || xMin >= static_cast<float>(width) || yMin >= static_cast<float>(height)) continue;
+		const auto x0 = static_cast<uint32_t>(std::max(0.f, std::floor(xMin)));
+		const auto x1 = static_cast<uint32_t>(std::min(static_cast<float>(width), std::ceil(xMax) + 1.f));
+		const auto y0 = static_cast<uint32_t>(std::max(0.f, std::floor(yMin)));
+		const auto y1 = static_cast<uint32_t>(std::min(static_cast<float>(height), std::ceil(yMax) + 1.f));
+
+		// Edge i runs from v[i] to v[i + 1]; positive inside for the counter-clockwise order
+		TriangleSetup tri;
+		for (int e = 0; e < 3; ++e)
+		{
+			const auto& a = v[e];
+			const auto& b = v[(e + 1) % 3];
+			tri.edgeA[e] = a.y - b.y;
+			tri.edgeB[e] = b.x - a.x;
+			tri.edgeC[e] = -(tri.edgeA[e] * a.x + tri.edgeB[e] * a.y);
+		}
+		// Barycentric weight of v[1] is edge 2 (v2 -> v0) over the area, of v[2] edge 0
+		const float invArea = 1.f / area;
+		const float dz1 = (v[1].z - v[0].z) * invArea;
+		const float dz2 = (v[2].z - v[0].z) * invArea;
+		tri.depthA = dz1 * tri.edgeA[2] + dz2 * tri.edgeA[0];
+		tri.depthB = dz1 * tri.edgeB[2] + dz2 * tri.edgeB[0];
+		tri.depthC = v[0].z + dz1 * tri.edgeC[2] + dz2 * tri.edgeC[0];
+
+		for (uint32_t y = y0; y < y1; ++y)
+		{
+			const float py = static_cast<float>(y) + 0.5f;
+			const float rowEdge[3] = { tri.edgeB[0] * py + tri.edgeC[0], tri.edgeB[1] * py + tri.edgeC[1], tri.edgeB[2] * py + tri.edgeC[2] };
+			span(depthImage.data() + static_cast<size_t>(y) * width, x0, x1, tri, rowEdge, tri.depthB * py + tri.depthC);
+		}
+	}
+}
+
+} // end namespace
+
+OcclusionBuffer::OcclusionBuffer(uint32_t width, uint32_t height) :
+	bufferWidth(std::max(8u, (width + 7u) & ~7u)),
+	bufferHeight(std::max(1u, height))
+{
+	clear();
+}
+
+void OcclusionBuffer::clear()
+{
+	depthImage.assign(static_cast<size_t>(bufferWidth) * bufferHeight, FAR_DEPTH);
+	levels.clear();
+}
+
+void OcclusionBuffer::rasterize(const glm::mat4& clipFromModel, const TriangleBvh& mesh)
+{
+	static const SpanFn span = select_span(best_simd_level());
+	rasterize_mesh(span, clipFromModel, mesh, bufferWidth, bufferHeight, depthImage);
+}
+
+void OcclusionBuffer::rasterize(const glm::mat4& clipFromModel, const TriangleBvh& mesh, SimdLevel level)
+{
+	rasterize_mesh(select_span(level), clipFromModel, mesh, bufferWidth, bufferHeight, depthImage);
+}
+
+void OcclusionBuffer::build_pyramid()
+{
+	levels.clear();
+	levels.push_back({ bufferWidth, bufferHeight, depthImage, depthImage });
+	while (levels.back().width > 1 || levels.back().height > 1)
+	{
+		const auto& fine = levels.back();
+		Level coarse;
+		coarse.width = (fine.width + 1) / 2;
+		coarse.height = (fine.height + 1) / 2;
+		coarse.minDepth.resize(static_cast<size_t>(coarse.width) * coarse.height);
+		coarse.maxDepth.resize(coarse.minDepth.size());
+		for (uint32_t y = 0; y < coarse.height; ++y)
+		{
+			// Odd sizes repeat the last row or column
+			const uint32_t fy0 = 2 * y;
+			const uint32_t fy1 = std::min(2 * y + 1, fine.height - 1);
+			for (uint32_t x = 0; x < coarse.width; ++x)
+			{
+				const uint32_t fx0 = 2 * x;
+				const uint32_t fx1 = std::min(2 * x + 1, fine.width - 1);
+				const auto at = [&](const std::vector<float>& image, uint32_t fx, uint32_t fy) { return image[fy * fine.width + fx]; };
+				coarse.minDepth[y * coarse.width + x] = std::min({ at(fine.minDepth, fx0, fy0), at(fine.minDepth, fx1, fy0),
+					at(fine.minDepth, fx0, fy1), at(fine.minDepth, fx1, fy1) });
+				coarse.maxDepth[y * coarse.width + x] = std::max({ at(fine.maxDepth, fx0, fy0), at(fine.maxDepth, fx1, fy0),
+					at(fine.maxDepth, fx0, fy1), at(fine.maxDepth, fx1, fy1) });
+			}
+		}
+		levels.push_back(std::move(coarse));
+	}
+}
+
+bool OcclusionBuffer::occluded(const glm::mat4& viewProjection, const AABB& worldBox) const
+{
+	if (levels.empty() || is_empty(worldBox)) return false;
+
+	float xMin = std::numeric_limits<float>::max(), xMax = -xMin;
+	float yMin = xMin, yMax = -xMin;
+	float nearest = xMin;
+	for (int corner = 0; corner < 8; ++corner)
+	{
+		const glm::vec3 p{ corner & 1 ? worldBox.max.x : worldBox.min.x,
+			corner & 2 ? worldBox.max.y : worldBox.min.y,
+			corner & 4 ? worldBox.max.z : worldBox.min.z };
+		glm::vec3 screen;
+		if (!to_screen(viewProjection, p, bufferWidth, bufferHeight, screen)) return false;
+		xMin = std::min(xMin, screen.x);
+		xMax = std::max(xMax, screen.x);
+		yMin = std::min(yMin, screen.y);
+		yMax = std::max(yMax, screen.y);
+		nearest = std::min(nearest, screen.z);
+	}
+	if (xMax < 0.f || yMax < 0.f || xMin >= static_cast<float>(bufferWidth) || yMin >= static_cast<float>(bufferHeight)) return false;
+
+	const auto clampX = [this](float x) { return static_cast<uint32_t>(std::clamp(x, 0.f, static_cast<float>(bufferWidth - 1))); };
+	const auto clampY = [this](float y) { return static_cast<uint32_t>(std::clamp(y, 0.f, static_cast<float>(bufferHeight - 1))); };
+	const auto x0 = clampX(xMin), x1 = clampX(xMax);
+	const auto y0 = clampY(yMin), y1 = clampY(yMax);
+
+	// Coarsest useful level: the rectangle spans at most 2 x 2 texels
+	uint32_t level = 0;
+	while (level + 1 < levels.size() && ((x1 >> level) - (x0 >> level) > 1 || (y1 >> level) - (y0 >> level) > 1)) ++level;
+
+	const auto region = [&](uint32_t l, bool farthest) {
+		float result = farthest ? -std::numeric_limits<float>::max() : std::numeric_limits<float>::max();
+		for (auto y = y0 >> l; y <= y1 >> l; ++y)
+			for (auto x = x0 >> l; x <= x1 >> l; ++x)
+				result = farthest ? std::max(result, max_depth(l, x, y)) : std::min(result, min_depth(l, x, y));
+		return result;
+	};
+
+	// Behind the farthest occluder depth: hidden. In front of the nearest: at least partly visible.
+	if (nearest > region(level, true)) return true;
+	if (level == 0 || nearest <= region(level, false)) return false;
+
+	// Otherwise the coarse texels reach well outside the rectangle; retry with tighter ones
+	const auto fine = level >= 2 ? level - 2 : 0;
+	return nearest > region(fine, true);
+}
+
+} // end namespace
@@ -0,0 +1,48 @@
+#include "scene/Picking.hpp"
+
+namespace ENG
+{
+
+Ray cursor_ray(const glm::mat4& view, const glm::mat4& proj, const glm::vec2& cursorNdc)
+{
+	// Clip depth 1 is the far plane in both depth conventions
+	const auto far = glm::inverse(proj * view) * glm::vec4(cursorNdc.x, cursorNdc.y, 1.f, 1.f);
+	const auto farPoint = glm::vec3(far) / far.w;
+
+	Ray ray;
+	ray.origin = glm::vec3(glm::inverse(view)[3]);
+	const auto toFar = farPoint - ray.origin;
+	ray.maxT = glm::length(toFar);
+	ray.direction = toFar / ray.maxT;
+	return ray;
+}
+
+std::optional<PickHit> pick(const SceneState& sceneState, const Ray& worldRay)
+{
+	const auto& graph = sceneState.graph;
+	std::optional<PickHit> closest;
+
+	graph.bvh.ray_cast(worldRay, [&](uint32_t nodeId, const Ray& ray) -> float {
+		if (!graph.nodes.is_alive(nodeId) || !graph.nodes[nodeId].selectable) return ray.maxT;
+		if (nodeId >= sceneState.pickMeshes.size() || !sceneState.pickMeshes[nodeId]) return ray.maxT;
+		if (nodeId >= sceneState.modelMatrices.size()) return ray.maxT;
+
+		// Ray into model space. The direction is not renormalised, so t is still the world
+		// distance along the original ray.
+		const auto toModel = glm::inverse(sceneState.modelMatrices[nodeId]);
+		Ray local;
+		local.origin = glm::vec3(toModel * glm::vec4(ray.origin, 1.f));
+		local.direction = glm::vec3(toModel * glm::vec4(ray.direction, 0.f));
+		local.maxT = ray.maxT;
+
+		TriangleHit hit;
+		if (!sceneState.pickMeshes[nodeId]->intersect(local, hit)) return ray.maxT;
+
+		closest = PickHit{ nodeId, hit.triangleId, { 1.f - hit.u - hit.v, hit.u, hit.v }, hit.t };
+		return hit.t;
+	});
+
+	return closest;
+}
+
+} // end namespace
@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+#include "scene/PlanetTileIndex.hpp"
+
+namespace ENG
+{
+
+namespace {
+
+// Slack for points on a shared tile edge
+constexpr float EDGE_EPSILON = 1e-6f;
+
+// Largest angle between a cube map face's axis and a direction that projects onto it
+const float FACE_HALF_ANGLE = std::acos(1.f / std::sqrt(3.f));
+
+struct CubeCoords {
+	uint32_t face;  // 2 * axis, +1 for the negative side
+	float u;        // gnomonic coordinates on the face, in [-1, 1]
+	float v;
+};
+
+CubeCoords to_cube(const glm::vec3& d)
+{
+	const auto ax = std::fabs(d.x);
+	const auto ay = std::fabs(d.y);
+	const auto az = std::fabs(d.z);
+	const int axis = ax >= ay && ax >= az ? 0 : (ay >= az ? 1 : 2);
+	const float major = std::fabs(d[axis]);
+	return { static_cast<uint32_t>(2 * axis + (d[axis] < 0.f ? 1 : 0)), d[(axis + 1) % 3] / major, d[(axis + 2) % 3] / major };
+}
+
+// Equal-angle remapping, so cells near face corners are not smaller than those at the center
+uint32_t to_cell(float gnomonic, uint32_t cellsPerEdge)
+{
+	const float angle = std::atan(std::clamp(gnomonic, -1.f, 1.f)) * (4.f / std::numbers::pi_v<float>);
+	const auto cell = static_cast<int64_t>(std::floor((angle + 1.f) * 0.5f * static_cast<float>(cellsPerEdge)));
+	return static_cast<uint32_t>(std::clamp<int64_t>(cell, 0, cellsPerEdge - 1));
+}
+
+} // end namespace
+
+void PlanetTileIndex::clear()
+{
+	cellsPerEdge = 0;
+	radius = 0.f;
+	polygonOffsets.clear();
+	polygons.clear();
+	centers.clear();
+	cellOffsets.clear();
+	cellTiles.clear();
+}
+
+void PlanetTileIndex::build(std::span<const uint32_t> offsets, std::span<const glm::vec3> tilePolygons)
+{
+	clear();
+	if (offsets.size() < 2) return;
+	if (offsets.back() != tilePolygons.size())
+	{
+		throw std::runtime_error("PlanetTileIndex: polygon offsets do not match the vertex count");
+	}
+
+	const auto tileCount = offsets.size() - 1;
+	polygonOffsets.assign(offsets.begin(), offsets.end());
+	polygons.reserve(tilePolygons.size());
+	centers.reserve(tileCount);
+	for (size_t tile = 0; tile < tileCount; ++tile)
+	{
+		if (offsets[tile + 1] < offsets[tile] + 3)
+		{
+			throw std::runtime_error("PlanetTileIndex: tile " + std::to_string(tile) + " has fewer than 3 vertices");
+		}
+		glm::vec3 sum{ 0.f };
+		for (auto i = offsets[tile]; i < offsets[tile + 1]; ++i)
+		{
+			radius = std::max(radius, glm::length(tilePolygons[i]));
+			polygons.push_back(glm::normalize(tilePolygons[i]));
+			sum += polygons.back();
+		}
+		centers.push_back(glm::normalize(sum));
+	}
+
+	// About one cell per tile, so each cell overlaps a few tiles at any subdivision level
+	cellsPerEdge = std::max(1u, static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(tileCount) / 6.0))));
+	const auto cellsPerFace = cellsPerEdge * cellsPerEdge;
+
+	// Angle from a tile's center to its farthest vertex
+	const auto cap_angle = [this](uint32_t tile) {
+		float minDot = 1.f;
+		for (auto i = polygonOffsets[tile]; i < polygonOffsets[tile + 1]; ++i)
+		{
+			minDot = std::min(minDot, glm::dot(centers[tile], polygons[i]));
+		}
+		return std::acos(std::clamp(minDot, -1.f, 1.f));
+	};
+
+	// Calls fn(cell) for every cell the tile's projection may overlap
+	const auto for_each_cell = [&](uint32_t tile, auto&& fn) {
+		for (uint32_t face = 0; face < 6; ++face)
+		{
+			const int axis = static_cast<int>(face / 2);
+			const float sign = face % 2 == 0 ? 1.f : -1.f;
+			float uMin = std::numeric_limits<float>::max(), uMax = -uMin, vMin = uMin, vMax = -uMin;
+			size_t inFront = 0;
+			const auto count = polygonOffsets[tile + 1] - polygonOffsets[tile];
+			for (auto i = polygonOffsets[tile]; i < polygonOffsets[tile + 1]; ++i)
+			{
+				const auto& p = polygons[i];
+				const float major = sign * p[axis];
+				if (major <= 0.f) continue;
+				++inFront;
+				// Great circles project to lines, so the projected polygon is the hull of its vertices
+				const float u = p[(axis + 1) % 3] / major;
+				const float v = p[(axis + 2) % 3] / major;
+				uMin = std::min(uMin, u);
+				uMax = std::max(uMax, u);
+				vMin = std::min(vMin, v);
+				vMax = std::max(vMax, v);
+			}
+			if (inFront == 0) continue;
+			if (inFront < count)
+			{
+				// Straddles the face's horizon, where the projection is unbounded. Skip the face if
+				// the tile's bounding cap cannot reach it, otherwise (very coarse tilings) take all of it.
+				glm::vec3 axisDirection{ 0.f };
+				axisDirection[axis] = sign;
+				const float toAxis = std::acos(std::clamp(glm::dot(centers[tile], axisDirection), -1.f, 1.f));
+				if (toAxis - cap_angle(tile) > FACE_HALF_ANGLE) continue;
+				uMin = vMin = -1.f;
+				uMax = vMax = 1.f;
+			}
+			if (uMax < -1.f || uMin > 1.f || vMax < -1.f || vMin > 1.f) continue;
+
+			const auto i0 = to_cell(uMin, cellsPerEdge), i1 = to_cell(uMax, cellsPerEdge);
+			const auto j0 = to_cell(vMin, cellsPerEdge), j1 = to_cell(vMax, cellsPerEdge);
+			for (auto j = j0; j <= j1; ++j)
+				for (auto i = i0; i <= i1; ++i)
+					fn(face * cellsPerFace + j * cellsPerEdge + i);
+		}
+	};
+
+	// Counting pass, then fill, into one flat candidate array
+	cellOffsets.assign(6 * cellsPerFace + 1, 0);
+	for (uint32_t tile = 0; tile < tileCount; ++tile)
+	{
+		for_each_cell(tile, [this](uint32_t cell) { ++cellOffsets[cell + 1]; });
+	}
+	for (size_t cell = 1; cell < cellOffsets.size(); ++cell)
+	{
+		cellOffsets[cell] += cellOffsets[cell - 1];
+	}
+	cellTiles.resize(cellOffsets.back());
+	auto cursor = cellOffsets;
+	for (uint32_t tile = 0; tile < tileCount; ++tile)
+	{
+		for_each_cell(tile, [this, &cursor, tile](uint32_t cell) { cellTiles[cursor[cell]++] = tile; });
+	}
+}
+
+bool PlanetTileIndex::contains(uint32_t tile, const glm::vec3& d) const
+{
+	const auto& center = centers[tile];
+	if (glm::dot(center, d) <= 0.f) return false;  // the edge planes also admit the antipodal tile
+
+	const auto first = polygonOffsets[tile];
+	const auto last = polygonOffsets[tile + 1];
+	// Winding taken from the center, so either orientation works
+	const float winding = glm::dot(glm::cross(polygons[first], polygons[first + 1]), center) >= 0.f ? 1.f : -1.f;
+	for (auto i = first; i < last; ++i)
+	{
+		const auto& a = polygons[i];
+		const auto& b = polygons[i + 1 < last ? i + 1 : first];
+		if (winding * glm::dot(glm::cross(a, b), d) < -EDGE_EPSILON) return false;
+	}
+	return true;
+}
+
+std::optional<uint32_t> PlanetTileIndex::tile_at(const glm::vec3& direction) const
+{
+	if (cellsPerEdge == 0) return std::nullopt;
+
+	const auto length = glm::length(direction);
+	if (!(length > 0.f)) return std::nullopt;
+	const auto d = direction / length;
+
+	const auto coords = to_cube(d);
+	const auto cell = coords.face * cellsPerEdge * cellsPerEdge + to_cell(coords.v, cellsPerEdge) * cellsPerEdge + to_cell(coords.u, cellsPerEdge);
+
+	std::optional<uint32_t> nearest;
+	float nearestDot = -2.f;
+	for (auto c = cellOffsets[cell]; c < cellOffsets[cell + 1]; ++c)
+	{
+		const auto tile = cellTiles[c];
+		if (contains(tile, d)) return tile;
+
+		// Rounding on an edge or vertex: fall back to the closest center
+		const float centerDot = glm::dot(centers[tile], d);
+		if (centerDot > nearestDot)
+		{
+			nearestDot = centerDot;
+			nearest = tile;
+		}
+	}
+	return nearest;
+}
+
+std::optional<uint32_t> PlanetTileIndex::pick(const Ray& ray) const
+{
+	if (cellsPerEdge == 0) return std::nullopt;
+
+	// |origin + t * direction| = radius
+	const float a = glm::dot(ray.direction, ray.direction);
+	const float b = glm::dot(ray.origin, ray.direction);
+	const float c = glm::dot(ray.origin, ray.origin) - radius * radius;
+	const float discriminant = b * b - a * c;
+	if (a <= 0.f || discriminant < 0.f) return std::nullopt;
+
+	const float root = std::sqrt(discriminant);
+	const float tNear = (-b - root) / a;
+	const float t = tNear >= 0.f ? tNear : (-b + root) / a;  // exit point when starting inside
+	if (t < 0.f || t > ray.maxT) return std::nullopt;
+
+	return tile_at(ray.origin + t * ray.direction);
+}
+
+size_t PlanetTileIndex::max_candidates() const
+{
+	size_t most = 0;
+	for (size_t cell = 0; cell + 1 < cellOffsets.size(); ++cell)
+	{
+		most = std::max<size_t>(most, cellOffsets[cell + 1] - cellOffsets[cell]);
+	}
+	return most;
+}
+
+} // end namespace
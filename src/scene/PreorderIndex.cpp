@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cassert>
+
+#include "scene/PreorderIndex.hpp"
+#include "scene/Scene.hpp"
+
+namespace ENG
+{
+
+bool PreorderIndex::sync(const SceneGraph& graph)
+{
+	// The version alone is cheap to check, but the live count is only consistent with it
+	// under the lock
+	return graph.read_structure([this, &graph]() {
+		if (builtStructureVersion == graph.structure_version() && nodeIds.size() == graph.nodes.live_count())
+		{
+			return false;
+		}
+		build(graph);
+		return true;
+	});
+}
+
+void PreorderIndex::rebuild(const SceneGraph& graph)
+{
+	graph.read_structure([this, &graph]() { build(graph); });
+}
+
+void PreorderIndex::build(const SceneGraph& graph)
+{
+	builtStructureVersion = graph.structure_version();
+
+	const auto nodeCount = graph.nodes.live_count();
+	nodeIds.clear();
+	parentSlots.clear();
+	nodeIds.reserve(nodeCount);
+	parentSlots.reserve(nodeCount);
+
+	// Explicit stack of (node, parent slot), only walked when the structure changes
+	const auto appendTree = [this](const Node* treeRoot) {
+		stack.emplace_back(treeRoot, NO_SLOT);
+		while (!stack.empty())
+		{
+			const auto [node, parentSlot] = stack.back();
+			stack.pop_back();
+
+			const auto slot = static_cast<uint32_t>(nodeIds.size());
+			nodeIds.push_back(node->nodeId);
+			parentSlots.push_back(parentSlot);
+
+			// Push in reverse so children keep their declaration order in the preorder
+			for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+			{
+				stack.emplace_back(*it, slot);
+			}
+		}
+	};
+
+	if (graph.root)
+	{
+		appendTree(graph.root);
+	}
+
+	// Nodes detached from the root still get a slot so they can be iterated and transformed
+	for (const auto& node : graph.nodes)
+	{
+		if (node.parent == nullptr && &node != graph.root)
+		{
+			appendTree(&node);
+		}
+	}
+
+	assert(nodeIds.size() == nodeCount);
+
+	// Children follow their parent in preorder, so a reverse sweep widens each parent's
+	// subtree to cover its last descendant
+	subtreeEnds.resize(nodeIds.size());
+	for (uint32_t slot = 0; slot < subtreeEnds.size(); ++slot)
+	{
+		subtreeEnds[slot] = slot + 1;
+	}
+	for (size_t slot = subtreeEnds.size(); slot-- > 0;)
+	{
+		const auto parentSlot = parentSlots[slot];
+		if (parentSlot != NO_SLOT)
+		{
+			subtreeEnds[parentSlot] = std::max(subtreeEnds[parentSlot], subtreeEnds[slot]);
+		}
+	}
+
+	slotOfNode.assign(graph.nodes.size(), NO_SLOT);
+	for (uint32_t slot = 0; slot < nodeIds.size(); ++slot)
+	{
+		slotOfNode[nodeIds[slot]] = slot;
+	}
+}
+
+std::span<const uint32_t> PreorderIndex::subtree(uint32_t nodeId) const
+{
+	const auto slot = slot_of(nodeId);
+	if (slot == NO_SLOT) return {};
+	return std::span<const uint32_t>(nodeIds).subspan(slot, subtreeEnds[slot] - slot);
+}
+
+} // end namespace
@@ -0,0 +1,421 @@
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "scene/RayQueries.hpp"
+
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace ENG
+{
+
+namespace {
+
+constexpr uint32_t MAX_PACKET_WIDTH = 8;
+
+// Lanes with a negative maxT are inactive: padding, or rays already resolved
+constexpr float INACTIVE = -1.f;
+
+// Keeps inverse directions finite, so slab tests never compute 0 * inf
+constexpr float MIN_DIRECTION = 1e-20f;
+
+// Rays of one packet in structure-of-arrays form, plus the best hit of every lane so far
+struct alignas(32) RayPacket {
+	float ox[MAX_PACKET_WIDTH], oy[MAX_PACKET_WIDTH], oz[MAX_PACKET_WIDTH];
+	float dx[MAX_PACKET_WIDTH], dy[MAX_PACKET_WIDTH], dz[MAX_PACKET_WIDTH];
+	float ix[MAX_PACKET_WIDTH], iy[MAX_PACKET_WIDTH], iz[MAX_PACKET_WIDTH];
+	float maxT[MAX_PACKET_WIDTH];
+	float u[MAX_PACKET_WIDTH], v[MAX_PACKET_WIDTH];
+	uint32_t triangle[MAX_PACKET_WIDTH];  // leaf order index into the current mesh
+};
+
+float safe_inverse(float d)
+{
+	return 1.f / (std::fabs(d) < MIN_DIRECTION ? std::copysign(MIN_DIRECTION, d) : d);
+}
+
+void set_lane(RayPacket& p, uint32_t lane, const glm::vec3& origin, const glm::vec3& direction, float maxT)
+{
+	p.ox[lane] = origin.x;
+	p.oy[lane] = origin.y;
+	p.oz[lane] = origin.z;
+	p.dx[lane] = direction.x;
+	p.dy[lane] = direction.y;
+	p.dz[lane] = direction.z;
+	p.ix[lane] = safe_inverse(direction.x);
+	p.iy[lane] = safe_inverse(direction.y);
+	p.iz[lane] = safe_inverse(direction.z);
+	p.maxT[lane] = maxT;
+}
+
+// Box and triangle tests over the first width lanes; both return a bit per lane that hit.
+// The triangle test also records the hit in the lane (maxT, u, v, triangle).
+using BoxFn = uint32_t (*)(const RayPacket&, const AABB&);
+using TriangleFn = uint32_t (*)(RayPacket&, const TriangleBvh::Triangle&, uint32_t);
+
+struct PacketKernels {
+	uint32_t width;
+	BoxFn box;
+	TriangleFn triangle;
+};
+
+constexpr uint32_t SCALAR_WIDTH = 4;
+
+uint32_t box_scalar(const RayPacket& p, const AABB& b)
+{
+	uint32_t mask = 0;
+	for (uint32_t lane = 0; lane < SCALAR_WIDTH; ++lane)
+	{
+		const float tx0 = (b.min.x - p.ox[lane]) * p.ix[lane], tx1 = (b.max.x - p.ox[lane]) * p.ix[lane];
+		const float ty0 = (b.min.y - p.oy[lane]) * p.iy[lane], ty1 = (b.max.y - p.oy[lane]) * p.iy[lane];
+		const float tz0 = (b.min.z - p.oz[lane]) * p.iz[lane], tz1 = (b.max.z - p.oz[lane]) * p.iz[lane];
+		const float tMin = std::max({ std::min(tx0, tx1), std::min(ty0, ty1), std::min(tz0, tz1), 0.f });
+		const float tMax = std::min({ std::max(tx0, tx1), std::max(ty0, ty1), std::max(tz0, tz1), p.maxT[lane] });
+		if (tMin <= tMax) mask |= 1u << lane;
+	}
+	return mask;
+}
+
+// Moller-Trumbore, both faces
+uint32_t triangle_scalar(RayPacket& p, const TriangleBvh::Triangle& tri, uint32_t index)
+{
+	uint32_t mask = 0;
+	for (uint32_t lane = 0; lane < SCALAR_WIDTH; ++lane)
+	{
+		const glm::vec3 origin{ p.ox[lane], p.oy[lane], p.oz[lane] };
+		const glm::vec3 direction{ p.dx[lane], p.dy[lane], p.dz[lane] };
+		const auto pv = glm::cross(direction, tri.edge2);
+		const float det = glm::dot(tri.edge1, pv);
+		if (std::fabs(det) < 1e-12f) continue;
+
+		const float invDet = 1.f / det;
+		const auto s = origin - tri.v0;
+		const float u = glm::dot(s, pv) * invDet;
+		const auto q = glm::cross(s, tri.edge1);
+		const float v = glm::dot(direction, q) * invDet;
+		const float t = glm::dot(tri.edge2, q) * invDet;
+		if (u < 0.f || v < 0.f || u + v > 1.f || t < 0.f || t > p.maxT[lane]) continue;
+
+		p.maxT[lane] = t;
+		p.u[lane] = u;
+		p.v[lane] = v;
+		p.triangle[lane] = index;
+		mask |= 1u << lane;
+	}
+	return mask;
+}
+
+#if ENG_SIMD_X86
+
+ENG_TARGET_SSE41
+uint32_t box_sse41(const RayPacket& p, const AABB& b)
+{
+	const __m128 tx0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.min.x), _mm_load_ps(p.ox)), _mm_load_ps(p.ix));
+	const __m128 tx1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.max.x), _mm_load_ps(p.ox)), _mm_load_ps(p.ix));
+	const __m128 ty0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.min.y), _mm_load_ps(p.oy)), _mm_load_ps(p.iy));
+	const __m128 ty1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.max.y), _mm_load_ps(p.oy)), _mm_load_ps(p.iy));
+	const __m128 tz0 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.min.z), _mm_load_ps(p.oz)), _mm_load_ps(p.iz));
+	const __m128 tz1 = _mm_mul_ps(_mm_sub_ps(_mm_set1_ps(b.max.z), _mm_load_ps(p.oz)), _mm_load_ps(p.iz));
+
+	__m128 tMin = _mm_max_ps(_mm_min_ps(tx0, tx1), _mm_setzero_ps());
+	tMin = _mm_max_ps(tMin, _mm_min_ps(ty0, ty1));
+	tMin = _mm_max_ps(tMin, _mm_min_ps(tz0, tz1));
+	__m128 tMax = _mm_min_ps(_mm_max_ps(tx0, tx1), _mm_load_ps(p.maxT));
+	tMax = _mm_min_ps(tMax, _mm_max_ps(ty0, ty1));
+	tMax = _mm_min_ps(tMax, _mm_max_ps(tz0, tz1));
+	return static_cast<uint32_t>(_mm_movemask_ps(_mm_cmple_ps(tMin, tMax)));
+}
+
+ENG_TARGET_SSE41
+uint32_t triangle_sse41(RayPacket& p, const TriangleBvh::Triangle& tri, uint32_t index)
+{
+	const __m128 dx = _mm_load_ps(p.dx), dy = _mm_load_ps(p.dy), dz = _mm_load_ps(p.dz);
+	const __m128 e1x = _mm_set1_ps(tri.edge1.x), e1y = _mm_set1_ps(tri.edge1.y), e1z = _mm_set1_ps(tri.edge1.z);
+	const __m128 e2x = _mm_set1_ps(tri.edge2.x), e2y = _mm_set1_ps(tri.edge2.y), e2z = _mm_set1_ps(tri.edge2.z);
+
+	// p = d x e2, det = e1 . p
+	const __m128 px = _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y));
+	const __m128 py = _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z));
+	const __m128 pz = _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x));
+	const __m128 det = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)), _mm_mul_ps(e1z, pz));
+	const __m128 invDet = _mm_div_ps(_mm_set1_ps(1.f), det);
+
+	// s = o - v0, q = s x e1
+	const __m128 sx = _mm_sub_ps(_mm_load_ps(p.ox), _mm_set1_ps(tri.v0.x));
+	const __m128 sy = _mm_sub_ps(_mm_load_ps(p.oy), _mm_set1_ps(tri.v0.y));
+	const __m128 sz = _mm_sub_ps(_mm_load_ps(p.oz), _mm_set1_ps(tri.v0.z));
+	const __m128 u = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(sx, px), _mm_mul_ps(sy, py)), _mm_mul_ps(sz, pz)), invDet);
+	const __m128 qx = _mm_sub_ps(_mm_mul_ps(sy, e1z), _mm_mul_ps(sz, e1y));
+	const __m128 qy = _mm_sub_ps(_mm_mul_ps(sz, e1x), _mm_mul_ps(sx, e1z));
+	const __m128 qz = _mm_sub_ps(_mm_mul_ps(sx, e1y), _mm_mul_ps(sy, e1x));
+	const __m128 v = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, qx), _mm_mul_ps(dy, qy)), _mm_mul_ps(dz, qz)), invDet);
+	const __m128 t = _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2x, qx), _mm_mul_ps(e2y, qy)), _mm_mul_ps(e2z, qz)), invDet);
+
+	// NaNs from a zero determinant fail every comparison
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 maxT = _mm_load_ps(p.maxT);
+	const __m128 absDet = _mm_andnot_ps(_mm_set1_ps(-0.f), det);
+	__m128 hit = _mm_cmpge_ps(absDet, _mm_set1_ps(1e-12f));
+	hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+	hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+	hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.f)));
+	hit = _mm_and_ps(hit, _mm_cmpge_ps(t, zero));
+	hit = _mm_and_ps(hit, _mm_cmple_ps(t, maxT));
+
+	const auto mask = static_cast<uint32_t>(_mm_movemask_ps(hit));
+	if (mask == 0) return 0;
+
+	_mm_store_ps(p.maxT, _mm_blendv_ps(maxT, t, hit));
+	_mm_store_ps(p.u, _mm_blendv_ps(_mm_load_ps(p.u), u, hit));
+	_mm_store_ps(p.v, _mm_blendv_ps(_mm_load_ps(p.v), v, hit));
+	const __m128i triangles = _mm_load_si128(reinterpret_cast<const __m128i*>(p.triangle));
+	_mm_store_si128(reinterpret_cast<__m128i*>(p.triangle),
+		_mm_blendv_epi8(triangles, _mm_set1_epi32(static_cast<int>(index)), _mm_castps_si128(hit)));
+	return mask;
+}
+
+ENG_TARGET_AVX2
+uint32_t box_avx2(const RayPacket& p, const AABB& b)
+{
+	// (b - o) * i as b * i - o * i, one fused multiply-add per slab plane
+	const __m256 ix = _mm256_load_ps(p.ix), iy = _mm256_load_ps(p.iy), iz = _mm256_load_ps(p.iz);
+	const __m256 oix = _mm256_mul_ps(_mm256_load_ps(p.ox), ix);
+	const __m256 oiy = _mm256_mul_ps(_mm256_load_ps(p.oy), iy);
+	const __m256 oiz = _mm256_mul_ps(_mm256_load_ps(p.oz), iz);
+	const __m256 tx0 = _mm256_fmsub_ps(_mm256_set1_ps(b.min.x), ix, oix);
+	const __m256 tx1 = _mm256_fmsub_ps(_mm256_set1_ps(b.max.x), ix, oix);
+	const __m256 ty0 = _mm256_fmsub_ps(_mm256_set1_ps(b.min.y), iy, oiy);
+	const __m256 ty1 = _mm256_fmsub_ps(_mm256_set1_ps(b.max.y), iy, oiy);
+	const __m256 tz0 = _mm256_fmsub_ps(_mm256_set1_ps(b.min.z), iz, oiz);
+	const __m256 tz1 = _mm256_fmsub_ps(_mm256_set1_ps(b.max.z), iz, oiz);
+
+	__m256 tMin = _mm256_max_ps(_mm256_min_ps(tx0, tx1), _mm256_setzero_ps());
+	tMin = _mm256_max_ps(tMin, _mm256_min_ps(ty0, ty1));
+	tMin = _mm256_max_ps(tMin, _mm256_min_ps(tz0, tz1));
+	__m256 tMax = _mm256_min_ps(_mm256_max_ps(tx0, tx1), _mm256_load_ps(p.maxT));
+	tMax = _mm256_min_ps(tMax, _mm256_max_ps(ty0, ty1));
+	tMax = _mm256_min_ps(tMax, _mm256_max_ps(tz0, tz1));
+	return static_cast<uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(tMin, tMax, _CMP_LE_OQ)));
+}
+
+ENG_TARGET_AVX2
+uint32_t triangle_avx2(RayPacket& p, const TriangleBvh::Triangle& tri, uint32_t index)
+{
+	const __m256 dx = _mm256_load_ps(p.dx), dy = _mm256_load_ps(p.dy), dz = _mm256_load_ps(p.dz);
+	const __m256 e1x = _mm256_set1_ps(tri.edge1.x), e1y = _mm256_set1_ps(tri.edge1.y), e1z = _mm256_set1_ps(tri.edge1.z);
+	const __m256 e2x = _mm256_set1_ps(tri.edge2.x), e2y = _mm256_set1_ps(tri.edge2.y), e2z = _mm256_set1_ps(tri.edge2.z);
+
+	const __m256 px = _mm256_fmsub_ps(dy, e2z, _mm256_mul_ps(dz, e2y));
+	const __m256 py = _mm256_fmsub_ps(dz, e2x, _mm256_mul_ps(dx, e2z));
+	const __m256 pz = _mm256_fmsub_ps(dx, e2y, _mm256_mul_ps(dy, e2x));
+	const __m256 det = _mm256_fmadd_ps(e1x, px, _mm256_fmadd_ps(e1y, py, _mm256_mul_ps(e1z, pz)));
+	const __m256 invDet = _mm256_div_ps(_mm256_set1_ps(1.f), det);
+
+	const __m256 sx = _mm256_sub_ps(_mm256_load_ps(p.ox), _mm256_set1_ps(tri.v0.x));
+	const __m256 sy = _mm256_sub_ps(_mm256_load_ps(p.oy), _mm256_set1_ps(tri.v0.y));
+	const __m256 sz = _mm256_sub_ps(_mm256_load_ps(p.oz), _mm256_set1_ps(tri.v0.z));
+	const __m256 u = _mm256_mul_ps(_mm256_fmadd_ps(sx, px, _mm256_fmadd_ps(sy, py, _mm256_mul_ps(sz, pz))), invDet);
+	const __m256 qx = _mm256_fmsub_ps(sy, e1z, _mm256_mul_ps(sz, e1y));
+	const __m256 qy = _mm256_fmsub_ps(sz, e1x, _mm256_mul_ps(sx, e1z));
+	const __m256 qz = _mm256_fmsub_ps(sx, e1y, _mm256_mul_ps(sy, e1x));
+	const __m256 v = _mm256_mul_ps(_mm256_fmadd_ps(dx, qx, _mm256_fmadd_ps(dy, qy, _mm256_mul_ps(dz, qz))), invDet);
+	const __m256 t = _mm256_mul_ps(_mm256_fmadd_ps(e2x, qx, _mm256_fmadd_ps(e2y, qy, _mm256_mul_ps(e2z, qz))), invDet);
+
+	const __m256 zero = _mm256_setzero_ps();
+	const __m256 maxT = _mm256_load_ps(p.maxT);
+	const __m256 absDet = _mm256_andnot_ps(_mm256_set1_ps(-0.f), det);
+	__m256 hit = _mm256_cmp_ps(absDet, _mm256_set1_ps(1e-12f), _CMP_GE_OQ);
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(u, zero, _CMP_GE_OQ));
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(v, zero, _CMP_GE_OQ));
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(_mm256_add_ps(u, v), _mm256_set1_ps(1.f), _CMP_LE_OQ));
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, zero, _CMP_GE_OQ));
+	hit = _mm256_and_ps(hit, _mm256_cmp_ps(t, maxT, _CMP_LE_OQ));
+
+	const auto mask = static_cast<uint32_t>(_mm256_movemask_ps(hit));
+	if (mask == 0) return 0;
+
+	_mm256_store_ps(p.maxT, _mm256_blendv_ps(maxT, t, hit));
+	_mm256_store_ps(p.u, _mm256_blendv_ps(_mm256_load_ps(p.u), u, hit));
+	_mm256_store_ps(p.v, _mm256_blendv_ps(_mm256_load_ps(p.v), v, hit));
+	const __m256i triangles = _mm256_load_si256(reinterpret_cast<const __m256i*>(p.triangle));
+	_mm256_store_si256(reinterpret_cast<__m256i*>(p.triangle),
+		_mm256_blendv_epi8(triangles, _mm256_set1_epi32(static_cast<int>(index)), _mm256_castps_si256(hit)));
+	return mask;
+}
+
+#endif
+
+PacketKernels select_kernels(SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level)
+	{
+	case SimdLevel::AVX2: return { 8, &box_avx2, &triangle_avx2 };
+	case SimdLevel::SSE41: return { 4, &box_sse41, &triangle_sse41 };
+	default: break;
+	}
+#endif
+	return { SCALAR_WIDTH, &box_scalar, &triangle_scalar };
+}
+
+// Per lane result of one packet, in scene terms
+struct PacketHits {
+	uint32_t nodeId[MAX_PACKET_WIDTH];
+	uint32_t triangleId[MAX_PACKET_WIDTH];
+	float t[MAX_PACKET_WIDTH];
+	float u[MAX_PACKET_WIDTH];
+	float v[MAX_PACKET_WIDTH];
+};
+
+// Walks the scene BVH with the packet, then the triangle BVH of every mesh it reaches.
+// With anyHit, lanes are retired at their first hit and the walk ends once all are.
+void trace_packet(const SceneState& sceneState, const PacketKernels& kernels, RayPacket& world, PacketHits& hits, bool anyHit)
+{
+	const auto laneMask = (1u << kernels.width) - 1u;
+	std::fill(std::begin(hits.nodeId), std::end(hits.nodeId), RAY_MISS);
+
+	sceneState.graph.bvh.query_if(
+		[&](const AABB& box) { return kernels.box(world, box) != 0; },
+		[&](uint32_t nodeId) {
+			if (nodeId >= sceneState.pickMeshes.size() || !sceneState.pickMeshes[nodeId]) return true;
+			if (nodeId >= sceneState.modelMatrices.size()) return true;
+			const auto& mesh = *sceneState.pickMeshes[nodeId];
+
+			// Packet into model space; t keeps its meaning because directions are not renormalised
+			const auto toModel = glm::inverse(sceneState.modelMatrices[nodeId]);
+			RayPacket local;
+			for (uint32_t lane = 0; lane < kernels.width; ++lane)
+			{
+				const auto origin = glm::vec3(toModel * glm::vec4(world.ox[lane], world.oy[lane], world.oz[lane], 1.f));
+				const auto direction = glm::vec3(toModel * glm::vec4(world.dx[lane], world.dy[lane], world.dz[lane], 0.f));
+				set_lane(local, lane, origin, direction, world.maxT[lane]);
+				local.u[lane] = local.v[lane] = 0.f;
+				local.triangle[lane] = 0;
+			}
+
+			uint32_t improved = 0;
+			mesh.for_each_leaf(
+				[&](const AABB& box) { return kernels.box(local, box) != 0; },
+				[&](uint32_t first, uint32_t count) {
+					for (uint32_t i = first; i < first + count; ++i)
+					{
+						const auto mask = kernels.triangle(local, mesh.triangle(i), i);
+						if (mask == 0) continue;
+						improved |= mask;
+						if (anyHit)
+						{
+							for (uint32_t lane = 0; lane < kernels.width; ++lane)
+							{
+								if (mask & (1u << lane)) local.maxT[lane] = INACTIVE;
+							}
+						}
+					}
+				});
+
+			for (uint32_t lane = 0; lane < kernels.width; ++lane)
+			{
+				if (!(improved & (1u << lane))) continue;
+				world.maxT[lane] = local.maxT[lane];
+				hits.nodeId[lane] = nodeId;
+				hits.triangleId[lane] = mesh.triangle_id(local.triangle[lane]);
+				hits.t[lane] = local.maxT[lane];
+				hits.u[lane] = local.u[lane];
+				hits.v[lane] = local.v[lane];
+			}
+
+			if (!anyHit) return true;
+			uint32_t active = 0;
+			for (uint32_t lane = 0; lane < kernels.width; ++lane)
+			{
+				if (world.maxT[lane] >= 0.f) active |= 1u << lane;
+			}
+			return (active & laneMask) != 0;
+		});
+}
+
+// Feeds the rays through trace_packet width at a time; emit(rayIndex, hits, lane) stores results
+template<typename Emit>
+void trace_rays(const SceneState& sceneState, const PacketKernels& kernels, std::span<const Ray> rays, bool anyHit, Emit&& emit)
+{
+	RayPacket packet;
+	PacketHits hits;
+	for (size_t base = 0; base < rays.size(); base += kernels.width)
+	{
+		const auto count = static_cast<uint32_t>(std::min<size_t>(kernels.width, rays.size() - base));
+		for (uint32_t lane = 0; lane < MAX_PACKET_WIDTH; ++lane)
+		{
+			if (lane < count)
+			{
+				const auto& ray = rays[base + lane];
+				set_lane(packet, lane, ray.origin, ray.direction, ray.maxT);
+			}
+			else
+			{
+				set_lane(packet, lane, glm::vec3(0.f), glm::vec3(0.f, 0.f, 1.f), INACTIVE);
+			}
+		}
+
+		trace_packet(sceneState, kernels, packet, hits, anyHit);
+		for (uint32_t lane = 0; lane < count; ++lane)
+		{
+			emit(base + lane, hits, lane);
+		}
+	}
+}
+
+void run_intersect(const PacketKernels& kernels, const SceneState& sceneState, std::span<const Ray> rays, std::span<RayHit> out)
+{
+	if (out.size() < rays.size())
+	{
+		throw std::runtime_error("intersect_rays: hit span is shorter than the ray span");
+	}
+	trace_rays(sceneState, kernels, rays, false, [&](size_t i, const PacketHits& hits, uint32_t lane) {
+		auto& hit = out[i];
+		hit = RayHit{};
+		if (hits.nodeId[lane] == RAY_MISS) return;
+		hit.nodeId = hits.nodeId[lane];
+		hit.triangleId = hits.triangleId[lane];
+		hit.t = hits.t[lane];
+		hit.u = hits.u[lane];
+		hit.v = hits.v[lane];
+	});
+}
+
+void run_occluded(const PacketKernels& kernels, const SceneState& sceneState, std::span<const Ray> rays, std::span<uint8_t> out)
+{
+	if (out.size() < rays.size())
+	{
+		throw std::runtime_error("occluded_rays: result span is shorter than the ray span");
+	}
+	trace_rays(sceneState, kernels, rays, true, [&](size_t i, const PacketHits& hits, uint32_t lane) {
+		out[i] = hits.nodeId[lane] != RAY_MISS ? 1 : 0;
+	});
+}
+
+} // end namespace
+
+void intersect_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<RayHit> hits)
+{
+	static const auto kernels = select_kernels(best_simd_level());
+	run_intersect(kernels, sceneState, rays, hits);
+}
+
+void intersect_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<RayHit> hits, SimdLevel level)
+{
+	run_intersect(select_kernels(level), sceneState, rays, hits);
+}
+
+void occluded_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<uint8_t> occluded)
+{
+	static const auto kernels = select_kernels(best_simd_level());
+	run_occluded(kernels, sceneState, rays, occluded);
+}
+
+void occluded_rays(const SceneState& sceneState, std::span<const Ray> rays, std::span<uint8_t> occluded, SimdLevel level)
+{
+	run_occluded(select_kernels(level), sceneState, rays, occluded);
+}
+
+} // end namespace
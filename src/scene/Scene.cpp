@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <cassert>
+
 #include "scene/Scene.hpp"
 #include "logger/Logging.hpp"
 
@@ -12,12 +15,8 @@ Node& get_node_by_id(SceneGraph& sceneGraph, const size_t nodeId)
 
 glm::mat4 transformation_matrix(const Node& node)
 {
-	glm::mat4 model_matrix = glm::mat4(1.0f);
-	model_matrix = glm::scale(model_matrix, node.scale);
-	model_matrix = model_matrix * glm::mat4_cast(node.rotation);
-	model_matrix = glm::translate(model_matrix, node.translation);
-
-	return model_matrix;
+	// Same T * R * S order as the world matrix update
+	return compose_trs(TRS{ node.translation, node.rotation, node.scale });
 }
 
 Camera* get_active_camera(const SceneState& sceneState)
@@ -25,7 +24,7 @@ Camera* get_active_camera(const SceneState& sceneState)
 	const auto& cameraNode = sceneState.graph.nodes.at(sceneState.activeCameraNodeIdx);
 
 	ENG_LOG_TRACE("Updating UniformBuffer from camera" << std::endl);
-	ENG_LOG_TRACE("Camera node name: " << cameraNode.name << "at idx: " << sceneState.activeCameraNodeIdx << std::endl); 
+	ENG_LOG_TRACE("Camera node name: " << cameraNode.name() << "at idx: " << sceneState.activeCameraNodeIdx << std::endl); 
 	ENG_LOG_TRACE("Cameras vec address: " << &sceneState.graph.cameras << std::endl);
 	ENG_LOG_TRACE("Camera address: " << cameraNode.camera << std::endl);
 	ENG_LOG_TRACE("Camera ptr retrieved" << std::endl);
@@ -41,13 +40,294 @@ Camera* get_active_camera(const SceneState& sceneState)
 }
 
 
-Node* find_node_by_name(const SceneGraph& graph, const std::string& name)
+void SceneGraph::set_name(Node& node, std::string_view name)
+{
+	const auto symbol = node_names().intern(name);
+
+	std::lock_guard lock(mut);
+	index_name(node, symbol);
+}
+
+void SceneGraph::set_names(const NodeRange& range, std::span<const std::string> names)
+{
+	assert(names.size() <= range.count);
+
+	// Intern first, NameTable has its own lock
+	std::vector<NameSymbol> symbols;
+	symbols.reserve(names.size());
+	for (const auto& name : names)
+	{
+		symbols.push_back(node_names().intern(name));
+	}
+
+	std::lock_guard lock(mut);
+	for (size_t i = 0; i < symbols.size(); ++i)
+	{
+		index_name(nodes[range.id(i)], symbols[i]);
+	}
+}
+
+void SceneGraph::index_name(Node& node, NameSymbol symbol)
+{
+	if (node.nameSymbol == symbol) return;
+
+	unindex_name(node);
+	node.nameSymbol = symbol;
+	if (symbol != EMPTY_NAME)
+	{
+		auto& ids = nodesByName[symbol];
+		ids.insert(std::upper_bound(ids.begin(), ids.end(), node.nodeId), node.nodeId);
+	}
+}
+
+NodeRange SceneGraph::create_nodes(std::span<const uint32_t> batchParents, Node* attachTo)
+{
+	const auto count = batchParents.size();
+	if (count == 0) return {};
+
+	std::lock_guard lock(mut);
+	const auto first = nodes.allocate_range(count);
+	const NodeRange range{ first, static_cast<uint32_t>(count) };
+
+	// Count children first so every children vector grows once
+	std::vector<uint32_t> childCounts(count, 0);
+	size_t attachedCount = 0;
+	for (const auto batchParent : batchParents)
+	{
+		if (batchParent == BATCH_ROOT) ++attachedCount;
+		else
+		{
+			assert(batchParent < count);
+			++childCounts[batchParent];
+		}
+	}
+	if (attachTo) attachTo->children.reserve(attachTo->children.size() + attachedCount);
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto& node = nodes[range.id(i)];
+		node.nodeId = range.id(i);
+		node.children.reserve(childCounts[i]);
+	}
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		auto& node = nodes[range.id(i)];
+		auto* parent = (batchParents[i] == BATCH_ROOT) ? attachTo : &nodes[range.id(batchParents[i])];
+		if (parent == nullptr) continue;
+		parent->children.push_back(&node);
+		node.parent = parent;
+	}
+
+	structureVersion.fetch_add(1, std::memory_order_release);
+	return range;
+}
+
+NodeRange SceneGraph::create_nodes(size_t count, Node* attachTo)
+{
+	const std::vector<uint32_t> batchParents(count, BATCH_ROOT);
+	return create_nodes(batchParents, attachTo);
+}
+
+void SceneGraph::destroy_subtree(Node& node, const std::function<void(Node&)>& onDestroy)
+{
+	std::vector<Node*> subtree{ &node };
+	{
+		std::lock_guard lock(mut);
+		if (node.parent)
+		{
+			std::erase(node.parent->children, &node);
+			node.parent = nullptr;
+		}
+		for (size_t i = 0; i < subtree.size(); ++i)
+		{
+			subtree.insert(subtree.end(), subtree[i]->children.begin(), subtree[i]->children.end());
+		}
+		if (&node == root) root = nullptr;
+		structureVersion.fetch_add(1, std::memory_order_release);
+	}
+
+	// Unlocked, so callbacks can use the graph and take their own locks without ordering
+	// them after mut
+	if (onDestroy)
+	{
+		for (auto* destroyed : subtree)
+		{
+			onDestroy(*destroyed);
+		}
+	}
+
+	std::lock_guard lock(mut);
+	for (auto* destroyed : subtree)
+	{
+		unindex_name(*destroyed);
+		if (destroyed->bvhProxy != DynamicAabbTree::NULL_NODE) bvh.destroy_proxy(destroyed->bvhProxy);
+		nodes.release(destroyed->nodeId);
+	}
+	structureVersion.fetch_add(1, std::memory_order_release);
+}
+
+void SceneGraph::unindex_name(const Node& node)
+{
+	if (node.nameSymbol == EMPTY_NAME) return;
+
+	const auto it = nodesByName.find(node.nameSymbol);
+	if (it == nodesByName.end()) return;
+
+	std::erase(it->second, node.nodeId);
+	if (it->second.empty()) nodesByName.erase(it);
+}
+
+Node* SceneGraph::find_by_name(std::string_view name) const
+{
+	// A name that was never interned cannot be on any node
+	const auto symbol = node_names().find(name);
+	if (!symbol) return nullptr;
+
+	std::lock_guard lock(mut);
+	const auto it = nodesByName.find(*symbol);
+	if (it == nodesByName.end()) return nullptr;
+
+	// Pool storage is stable and the graph owns its nodes; constness only guards the index
+	return const_cast<Node*>(&nodes[it->second.front()]);
+}
+
+void update_world_bounds(SceneState& sceneState, std::span<const MatrixRange> ranges)
 {
-	for (const auto& node : graph.nodes) {
-		if (node.name == name) return const_cast<Node*>(&node);
+	auto& graph = sceneState.graph;
+	auto& culling = sceneState.cullingBounds;
+	if (culling.size() < graph.nodes.size())
+	{
+		culling.resize(graph.nodes.size());
 	}
 
-	return nullptr;
+	for (const auto& range : ranges)
+	{
+		for (auto nodeId = range.first; nodeId < range.first + range.count; ++nodeId)
+		{
+			if (!graph.nodes.is_alive(nodeId))
+			{
+				if (nodeId < culling.size()) culling.set_hidden(nodeId);
+				continue;
+			}
+
+			auto& node = graph.nodes[nodeId];
+			const bool hasBounds = nodeId < sceneState.aabbs.size() && !is_empty(sceneState.aabbs[nodeId]);
+			if (!hasBounds)
+			{
+				culling.set_unbounded(nodeId);
+				if (node.bvhProxy != DynamicAabbTree::NULL_NODE)
+				{
+					graph.bvh.destroy_proxy(node.bvhProxy);
+					node.bvhProxy = DynamicAabbTree::NULL_NODE;
+				}
+				continue;
+			}
+
+			assert(nodeId < sceneState.modelMatrices.size());
+			const auto worldBounds = transform_aabb(sceneState.modelMatrices[nodeId], sceneState.aabbs[nodeId]);
+			culling.set(nodeId, worldBounds);
+			if (node.bvhProxy == DynamicAabbTree::NULL_NODE)
+			{
+				node.bvhProxy = graph.bvh.create_proxy(worldBounds, nodeId);
+			}
+			else
+			{
+				graph.bvh.move_proxy(node.bvhProxy, worldBounds);
+			}
+		}
+	}
+
+	sceneState.subtreeBounds.update(sceneState.transforms.preorder(), culling, ranges);
+}
+
+void cull_scene(SceneState& sceneState, const glm::mat4& viewProjection)
+{
+	const auto frustum = frustum_from_matrix(viewProjection);
+	auto& stats = sceneState.cullStats;
+	auto& visible = sceneState.visibleNodeIds;
+	stats = cull_hierarchy(frustum, sceneState.transforms.preorder(), sceneState.subtreeBounds, sceneState.cullingBounds, visible);
+
+	// Occluders in view go into the depth buffer first, then every other bounded node is
+	// tested against its pyramid
+	auto& graph = sceneState.graph;
+	auto& occlusion = sceneState.occlusion;
+	const auto is_occluder = [&](uint32_t nodeId) {
+		return graph.nodes.is_alive(nodeId) && graph.nodes[nodeId].occluder
+			&& nodeId < sceneState.pickMeshes.size() && sceneState.pickMeshes[nodeId]
+			&& nodeId < sceneState.modelMatrices.size();
+	};
+	occlusion.clear();
+	bool anyOccluder = false;
+	for (const auto nodeId : visible)
+	{
+		if (!is_occluder(nodeId)) continue;
+		occlusion.rasterize(viewProjection * sceneState.modelMatrices[nodeId], *sceneState.pickMeshes[nodeId]);
+		anyOccluder = true;
+	}
+	if (anyOccluder)
+	{
+		occlusion.build_pyramid();
+		const auto& bounds = sceneState.cullingBounds;
+		const auto before = visible.size();
+		std::erase_if(visible, [&](uint32_t nodeId) {
+			const bool bounded = nodeId < sceneState.aabbs.size() && !is_empty(sceneState.aabbs[nodeId]);
+			if (!bounded || is_occluder(nodeId)) return false;
+			return occlusion.occluded(viewProjection, bounds.box(nodeId));
+		});
+		stats.occluded = static_cast<uint32_t>(before - visible.size());
+		stats.visible -= stats.occluded;
+	}
+	ENG_LOG_TRACE("Frustum culling: " << stats.visible << " visible, " << stats.culled << " culled, "
+		<< stats.occluded << " occluded" << std::endl);
+}
+
+void select_lods(SceneState& sceneState, const glm::mat4& view, const glm::mat4& projection)
+{
+	auto& stats = sceneState.lodStats;
+	stats = {};
+	const auto cameraPosition = glm::vec3(glm::inverse(view)[3]);
+	auto& graph = sceneState.graph;
+
+	std::erase_if(sceneState.visibleNodeIds, [&](uint32_t nodeId) {
+		const bool bounded = nodeId < sceneState.boundingSpheres.size() && sceneState.boundingSpheres[nodeId].radius > 0.f
+			&& nodeId < sceneState.modelMatrices.size();
+		if (!bounded || !graph.nodes.is_alive(nodeId)) return false;
+
+		const auto worldSphere = transform_sphere(sceneState.modelMatrices[nodeId], sceneState.boundingSpheres[nodeId]);
+		const auto screenSize = projected_screen_size(worldSphere, cameraPosition, projection);
+
+		if (nodeId >= sceneState.lods.size() || sceneState.lods[nodeId].empty())
+		{
+			if (nodeId >= sceneState.belowCutoff.size())
+			{
+				sceneState.belowCutoff.resize(nodeId + 1, 0);
+			}
+			const bool tooSmall = below_cutoff(screenSize, sceneState.belowCutoff[nodeId] != 0, sceneState.lodSettings);
+			sceneState.belowCutoff[nodeId] = tooSmall ? 1 : 0;
+			stats.culled += tooSmall ? 1 : 0;
+			return tooSmall;
+		}
+
+		auto& lod = sceneState.lods[nodeId];
+		const auto previous = lod.current();
+		const auto level = lod.select(screenSize, sceneState.lodSettings);
+		if (level == LOD_CULLED)
+		{
+			++stats.culled;
+			return true;
+		}
+		++stats.selected;
+		stats.switched += level != previous ? 1 : 0;
+		graph.nodes[nodeId].draw_data_idx = lod.levels()[level].drawDataIdx;
+		return false;
+	});
+	sceneState.cullStats.visible -= std::min(sceneState.cullStats.visible, stats.culled);
+}
+
+Node* find_node_by_name(const SceneGraph& graph, std::string_view name)
+{
+	return graph.find_by_name(name);
 }
 
 } // end namespace
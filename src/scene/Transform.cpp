@@ -0,0 +1,263 @@
+#include <algorithm>
+#include <cassert>
+
+#include "scene/Transform.hpp"
+#include "scene/TransformKernels.hpp"
+#include "application/ThreadPool.hpp"
+#include "scene/Scene.hpp"
+
+namespace ENG
+{
+
+void merge_matrix_ranges(std::vector<MatrixRange>& ranges)
+{
+	if (ranges.empty()) return;
+
+	std::sort(ranges.begin(), ranges.end(), [](const MatrixRange& a, const MatrixRange& b) {
+		return a.first < b.first;
+	});
+
+	size_t out = 0;
+	for (size_t i = 1; i < ranges.size(); ++i)
+	{
+		auto& current = ranges[out];
+		const auto& next = ranges[i];
+		const auto currentEnd = current.first + current.count;
+		if (next.first <= currentEnd)
+		{
+			current.count = std::max(currentEnd, next.first + next.count) - current.first;
+		}
+		else
+		{
+			ranges[++out] = next;
+		}
+	}
+	ranges.resize(out + 1);
+}
+
+glm::mat4 compose_trs(const TRS& trs)
+{
+	return glm::translate(glm::mat4(1.f), trs.translation)
+		* glm::mat4_cast(trs.rotation)
+		* glm::scale(glm::mat4(1.f), trs.scale);
+}
+
+bool TransformHierarchy::sync_structure(const SceneGraph& graph)
+{
+	if (!order.sync(graph)) return false;
+
+	resize_to_layout();
+	return true;
+}
+
+void TransformHierarchy::rebuild(const SceneGraph& graph)
+{
+	order.rebuild(graph);
+	resize_to_layout();
+}
+
+void TransformHierarchy::resize_to_layout()
+{
+	locals.resize(order.size());
+	localMatrices.resize(order.size());
+	worldMatrices.resize(order.size());
+	fullUpdatePending = true;
+
+	build_parallel_partition();
+}
+
+void TransformHierarchy::set_parallel_policy(size_t threshold, size_t grain)
+{
+	parallelThreshold = threshold;
+	parallelGrain = grain > 0 ? grain : 1;
+	build_parallel_partition();
+}
+
+void TransformHierarchy::build_parallel_partition()
+{
+	spineSlots.clear();
+	parallelTasks.clear();
+
+	const auto& parentSlots = order.parent_slots();
+	const auto& subtreeEnds = order.subtree_ends();
+
+	// Linear sweep in preorder: descend into subtrees larger than the grain (they become
+	// spine), and batch smaller subtrees into tasks. Only siblings are batched together,
+	// so each task lies entirely inside the subtree of its spine parent.
+	uint32_t pendingParent = NO_PARENT;
+	const auto slotCount = static_cast<uint32_t>(order.size());
+	uint32_t slot = 0;
+	while (slot < slotCount)
+	{
+		const auto subtreeSize = subtreeEnds[slot] - slot;
+		if (subtreeSize > parallelGrain)
+		{
+			spineSlots.push_back(slot);
+			++slot;
+			continue;
+		}
+
+		auto* pending = parallelTasks.empty() ? nullptr : &parallelTasks.back();
+		const bool extendsPending = pending
+			&& pending->first + pending->count == slot
+			&& pendingParent == parentSlots[slot]
+			&& pending->count + subtreeSize <= parallelGrain;
+		if (extendsPending)
+		{
+			pending->count += subtreeSize;
+		}
+		else
+		{
+			parallelTasks.push_back(MatrixRange{ slot, subtreeSize });
+			pendingParent = parentSlots[slot];
+		}
+		slot = subtreeEnds[slot];
+	}
+}
+
+void TransformHierarchy::gather_local_transforms(const SceneGraph& graph)
+{
+	gather_local_transforms(graph, 0, static_cast<uint32_t>(order.size()));
+}
+
+void TransformHierarchy::gather_local_transforms(const SceneGraph& graph, uint32_t beginSlot, uint32_t endSlot)
+{
+	const auto& nodeIds = order.node_ids();
+	for (uint32_t slot = beginSlot; slot < endSlot; ++slot)
+	{
+		const auto& node = graph.nodes[nodeIds[slot]];
+		locals[slot] = TRS{ node.translation, node.rotation, node.scale };
+	}
+}
+
+void TransformHierarchy::update_world_matrices(std::vector<glm::mat4>& modelMatrices)
+{
+	const auto slotCount = static_cast<uint32_t>(order.size());
+	if (pool == nullptr || slotCount < parallelThreshold)
+	{
+		update_world_matrices(modelMatrices, 0, slotCount);
+		return;
+	}
+
+	// Spine first, in slot order, so every task finds its parent already resolved
+	for (const auto slot : spineSlots)
+	{
+		update_world_matrices(modelMatrices, slot, slot + 1);
+	}
+
+	pool->parallel_for(parallelTasks.size(), [this, &modelMatrices](size_t task) {
+		const auto& range = parallelTasks[task];
+		update_world_matrices(modelMatrices, range.first, range.first + range.count);
+	});
+}
+
+void TransformHierarchy::update_subtree(std::vector<glm::mat4>& modelMatrices, uint32_t slot)
+{
+	const auto end = order.subtree_ends()[slot];
+	const bool isSpine = std::binary_search(spineSlots.begin(), spineSlots.end(), slot);
+	if (pool == nullptr || !isSpine || end - slot < parallelThreshold)
+	{
+		update_world_matrices(modelMatrices, slot, end);
+		return;
+	}
+
+	// A spine subtree contains whole tasks only, found by their first slot
+	const auto spineBegin = std::lower_bound(spineSlots.begin(), spineSlots.end(), slot);
+	const auto spineEnd = std::lower_bound(spineBegin, spineSlots.end(), end);
+	for (auto it = spineBegin; it != spineEnd; ++it)
+	{
+		update_world_matrices(modelMatrices, *it, *it + 1);
+	}
+
+	const auto byFirst = [](const MatrixRange& range, uint32_t value) { return range.first < value; };
+	const auto taskBegin = std::lower_bound(parallelTasks.begin(), parallelTasks.end(), slot, byFirst);
+	const auto taskEnd = std::lower_bound(taskBegin, parallelTasks.end(), end, byFirst);
+	const auto* tasks = parallelTasks.data() + (taskBegin - parallelTasks.begin());
+	pool->parallel_for(static_cast<size_t>(taskEnd - taskBegin), [this, tasks, &modelMatrices](size_t task) {
+		const auto& range = tasks[task];
+		update_world_matrices(modelMatrices, range.first, range.first + range.count);
+	});
+}
+
+void TransformHierarchy::update_world_matrices(std::vector<glm::mat4>& modelMatrices, uint32_t beginSlot, uint32_t endSlot)
+{
+	// Parents always precede children, so a single forward pass resolves the hierarchy.
+	// For a partial range the parent of beginSlot lies outside it and is already up to date.
+	compose_trs_batch(locals.data() + beginSlot, localMatrices.data() + beginSlot, endSlot - beginSlot);
+
+	const auto& nodeIds = order.node_ids();
+	const auto& parentSlots = order.parent_slots();
+
+	for (uint32_t slot = beginSlot; slot < endSlot; ++slot)
+	{
+		const auto parentSlot = parentSlots[slot];
+		const auto& local = localMatrices[slot];
+		worldMatrices[slot] = (parentSlot == NO_PARENT) ? local : worldMatrices[parentSlot] * local;
+
+		assert(nodeIds[slot] < modelMatrices.size());
+		modelMatrices[nodeIds[slot]] = worldMatrices[slot];
+	}
+}
+
+void TransformHierarchy::update(SceneGraph& graph, std::vector<glm::mat4>& modelMatrices, std::vector<MatrixRange>& changedRanges)
+{
+	// Take the dirty list before checking structure, so nodes created in between are
+	// always covered by the rebuild
+	graph.take_dirty_transforms(dirtyScratch);
+
+	sync_structure(graph);
+	const auto& slotOfNode = order.slot_of_node();
+	if (fullUpdatePending)
+	{
+		fullUpdatePending = false;
+		if (modelMatrices.size() < slotOfNode.size())
+		{
+			modelMatrices.resize(slotOfNode.size(), glm::mat4(1.f));
+		}
+		gather_local_transforms(graph);
+		update_world_matrices(modelMatrices);
+		changedRanges.push_back(MatrixRange{ 0, static_cast<uint32_t>(slotOfNode.size()) });
+		return;
+	}
+
+	if (dirtyScratch.empty()) return;
+
+	// Convert to sorted slots, so a dirty ancestor is visited before its dirty descendants
+	for (auto& id : dirtyScratch)
+	{
+		id = (id < slotOfNode.size()) ? slotOfNode[id] : NO_PARENT;
+	}
+	std::sort(dirtyScratch.begin(), dirtyScratch.end());
+
+	const auto& nodeIds = order.node_ids();
+	const auto& subtreeEnds = order.subtree_ends();
+	changedScratch.clear();
+	uint32_t coveredEnd = 0;
+	for (const auto slot : dirtyScratch)
+	{
+		if (slot == NO_PARENT) break;
+		if (slot < coveredEnd) continue;  // already recomputed as part of an ancestor's subtree
+
+		const auto end = subtreeEnds[slot];
+		gather_local_transforms(graph, slot, end);
+		update_subtree(modelMatrices, slot);
+		changedScratch.insert(changedScratch.end(), nodeIds.begin() + slot, nodeIds.begin() + end);
+		coveredEnd = end;
+	}
+
+	// Subtrees are contiguous in slot order but not necessarily in nodeId order
+	std::sort(changedScratch.begin(), changedScratch.end());
+	for (const auto id : changedScratch)
+	{
+		if (!changedRanges.empty() && changedRanges.back().first + changedRanges.back().count == id)
+		{
+			changedRanges.back().count++;
+		}
+		else
+		{
+			changedRanges.push_back(MatrixRange{ id, 1 });
+		}
+	}
+}
+
+} // end namespace
@@ -0,0 +1,220 @@
+#include <cstddef>
+
+#include "scene/TransformKernels.hpp"
+
+#if ENG_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace ENG
+{
+
+// The SIMD paths read TRS as 10 packed floats: tx ty tz qx qy qz qw sx sy sz
+static_assert(sizeof(TRS) == 10 * sizeof(float), "TRS must be tightly packed floats");
+static_assert(offsetof(TRS, rotation) == 3 * sizeof(float), "unexpected TRS layout");
+static_assert(offsetof(TRS, scale) == 7 * sizeof(float), "unexpected TRS layout");
+static_assert(offsetof(glm::quat, x) == 0 && offsetof(glm::quat, w) == 3 * sizeof(float),
+	"compose kernels expect glm quaternion storage order xyzw");
+static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "mat4 must be 16 packed floats");
+
+namespace {
+
+void compose_trs_scalar(const TRS* trs, glm::mat4* out, size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+	{
+		const auto& t = trs[i].translation;
+		const auto& q = trs[i].rotation;
+		const auto& s = trs[i].scale;
+
+		const float x2 = q.x + q.x, y2 = q.y + q.y, z2 = q.z + q.z;
+		const float xx = q.x * x2, yy = q.y * y2, zz = q.z * z2;
+		const float xy = q.x * y2, xz = q.x * z2, yz = q.y * z2;
+		const float wx = q.w * x2, wy = q.w * y2, wz = q.w * z2;
+
+		auto& m = out[i];
+		m[0] = glm::vec4((1.f - (yy + zz)) * s.x, (xy + wz) * s.x, (xz - wy) * s.x, 0.f);
+		m[1] = glm::vec4((xy - wz) * s.y, (1.f - (xx + zz)) * s.y, (yz + wx) * s.y, 0.f);
+		m[2] = glm::vec4((xz + wy) * s.z, (yz - wx) * s.z, (1.f - (xx + yy)) * s.z, 0.f);
+		m[3] = glm::vec4(t.x, t.y, t.z, 1.f);
+	}
+}
+
+#if ENG_SIMD_X86
+
+ENG_TARGET_SSE41
+void compose_trs_sse41(const TRS* trs, glm::mat4* out, size_t count)
+{
+	const __m128 one = _mm_set1_ps(1.f);
+	const __m128 zero = _mm_setzero_ps();
+
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		const float* src = reinterpret_cast<const float*>(trs + i);
+		constexpr size_t stride = 10;
+
+		// AoS -> SoA: two 4x4 transposes plus a 4x2 for the trailing scale components
+		__m128 tx = _mm_loadu_ps(src + 0 * stride);
+		__m128 ty = _mm_loadu_ps(src + 1 * stride);
+		__m128 tz = _mm_loadu_ps(src + 2 * stride);
+		__m128 qx = _mm_loadu_ps(src + 3 * stride);
+		_MM_TRANSPOSE4_PS(tx, ty, tz, qx);
+
+		__m128 qy = _mm_loadu_ps(src + 0 * stride + 4);
+		__m128 qz = _mm_loadu_ps(src + 1 * stride + 4);
+		__m128 qw = _mm_loadu_ps(src + 2 * stride + 4);
+		__m128 sx = _mm_loadu_ps(src + 3 * stride + 4);
+		_MM_TRANSPOSE4_PS(qy, qz, qw, sx);
+
+		__m128 sy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src + 0 * stride + 8)));
+		__m128 sz = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src + 1 * stride + 8)));
+		__m128 s2 = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src + 2 * stride + 8)));
+		__m128 s3 = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src + 3 * stride + 8)));
+		_MM_TRANSPOSE4_PS(sy, sz, s2, s3);
+
+		const __m128 x2 = _mm_add_ps(qx, qx), y2 = _mm_add_ps(qy, qy), z2 = _mm_add_ps(qz, qz);
+		const __m128 xx = _mm_mul_ps(qx, x2), yy = _mm_mul_ps(qy, y2), zz = _mm_mul_ps(qz, z2);
+		const __m128 xy = _mm_mul_ps(qx, y2), xz = _mm_mul_ps(qx, z2), yz = _mm_mul_ps(qy, z2);
+		const __m128 wx = _mm_mul_ps(qw, x2), wy = _mm_mul_ps(qw, y2), wz = _mm_mul_ps(qw, z2);
+
+		// rows[column][row], each lane holding one of the four matrices
+		__m128 rows[4][4] = {
+			{ _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(yy, zz)), sx), _mm_mul_ps(_mm_add_ps(xy, wz), sx), _mm_mul_ps(_mm_sub_ps(xz, wy), sx), zero },
+			{ _mm_mul_ps(_mm_sub_ps(xy, wz), sy), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, zz)), sy), _mm_mul_ps(_mm_add_ps(yz, wx), sy), zero },
+			{ _mm_mul_ps(_mm_add_ps(xz, wy), sz), _mm_mul_ps(_mm_sub_ps(yz, wx), sz), _mm_mul_ps(_mm_sub_ps(one, _mm_add_ps(xx, yy)), sz), zero },
+			{ tx, ty, tz, one },
+		};
+
+		float* dst = reinterpret_cast<float*>(out + i);
+		for (int column = 0; column < 4; ++column)
+		{
+			__m128 m0 = rows[column][0], m1 = rows[column][1], m2 = rows[column][2], m3 = rows[column][3];
+			_MM_TRANSPOSE4_PS(m0, m1, m2, m3);
+			_mm_storeu_ps(dst + 0 * 16 + column * 4, m0);
+			_mm_storeu_ps(dst + 1 * 16 + column * 4, m1);
+			_mm_storeu_ps(dst + 2 * 16 + column * 4, m2);
+			_mm_storeu_ps(dst + 3 * 16 + column * 4, m3);
+		}
+	}
+
+	compose_trs_scalar(trs + i, out + i, count - i);
+}
+
+ENG_TARGET_AVX2
+void compose_trs_avx2(const TRS* trs, glm::mat4* out, size_t count)
+{
+	const __m256 one = _mm256_set1_ps(1.f);
+	const __m256 zero = _mm256_setzero_ps();
+	constexpr int stride = 10;
+	const __m256i gatherIdx = _mm256_setr_epi32(0, stride, 2 * stride, 3 * stride, 4 * stride, 5 * stride, 6 * stride, 7 * stride);
+
+	size_t i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		const float* src = reinterpret_cast<const float*>(trs + i);
+
+		// AoS -> SoA: 8x8 transpose of the first eight floats of each TRS
+		const __m256 r0 = _mm256_loadu_ps(src + 0 * stride);
+		const __m256 r1 = _mm256_loadu_ps(src + 1 * stride);
+		const __m256 r2 = _mm256_loadu_ps(src + 2 * stride);
+		const __m256 r3 = _mm256_loadu_ps(src + 3 * stride);
+		const __m256 r4 = _mm256_loadu_ps(src + 4 * stride);
+		const __m256 r5 = _mm256_loadu_ps(src + 5 * stride);
+		const __m256 r6 = _mm256_loadu_ps(src + 6 * stride);
+		const __m256 r7 = _mm256_loadu_ps(src + 7 * stride);
+
+		const __m256 t0 = _mm256_unpacklo_ps(r0, r1), t1 = _mm256_unpackhi_ps(r0, r1);
+		const __m256 t2 = _mm256_unpacklo_ps(r2, r3), t3 = _mm256_unpackhi_ps(r2, r3);
+		const __m256 t4 = _mm256_unpacklo_ps(r4, r5), t5 = _mm256_unpackhi_ps(r4, r5);
+		const __m256 t6 = _mm256_unpacklo_ps(r6, r7), t7 = _mm256_unpackhi_ps(r6, r7);
+
+		const __m256 u0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 u1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 u2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 u3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 u4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 u5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+		const __m256 u6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+		const __m256 u7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+		const __m256 tx = _mm256_permute2f128_ps(u0, u4, 0x20);
+		const __m256 ty = _mm256_permute2f128_ps(u1, u5, 0x20);
+		const __m256 tz = _mm256_permute2f128_ps(u2, u6, 0x20);
+		const __m256 qx = _mm256_permute2f128_ps(u3, u7, 0x20);
+		const __m256 qy = _mm256_permute2f128_ps(u0, u4, 0x31);
+		const __m256 qz = _mm256_permute2f128_ps(u1, u5, 0x31);
+		const __m256 qw = _mm256_permute2f128_ps(u2, u6, 0x31);
+		const __m256 sx = _mm256_permute2f128_ps(u3, u7, 0x31);
+		const __m256 sy = _mm256_i32gather_ps(src + 8, gatherIdx, 4);
+		const __m256 sz = _mm256_i32gather_ps(src + 9, gatherIdx, 4);
+
+		const __m256 x2 = _mm256_add_ps(qx, qx), y2 = _mm256_add_ps(qy, qy), z2 = _mm256_add_ps(qz, qz);
+		const __m256 xx = _mm256_mul_ps(qx, x2), yy = _mm256_mul_ps(qy, y2), zz = _mm256_mul_ps(qz, z2);
+		const __m256 xy = _mm256_mul_ps(qx, y2), xz = _mm256_mul_ps(qx, z2), yz = _mm256_mul_ps(qy, z2);
+		const __m256 wx = _mm256_mul_ps(qw, x2), wy = _mm256_mul_ps(qw, y2), wz = _mm256_mul_ps(qw, z2);
+
+		const __m256 rows[4][4] = {
+			{ _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx), _mm256_mul_ps(_mm256_add_ps(xy, wz), sx), _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx), zero },
+			{ _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy), _mm256_mul_ps(_mm256_add_ps(yz, wx), sy), zero },
+			{ _mm256_mul_ps(_mm256_add_ps(xz, wy), sz), _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz), _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz), zero },
+			{ tx, ty, tz, one },
+		};
+
+		// SoA -> AoS: an in-lane 4x4 transpose yields matrix k in the low half and k + 4 in the high half
+		float* dst = reinterpret_cast<float*>(out + i);
+		for (int column = 0; column < 4; ++column)
+		{
+			const __m256 a0 = _mm256_unpacklo_ps(rows[column][0], rows[column][1]);
+			const __m256 a1 = _mm256_unpackhi_ps(rows[column][0], rows[column][1]);
+			const __m256 a2 = _mm256_unpacklo_ps(rows[column][2], rows[column][3]);
+			const __m256 a3 = _mm256_unpackhi_ps(rows[column][2], rows[column][3]);
+
+			const __m256 m[4] = {
+				_mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(a0, a2, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(a1, a3, _MM_SHUFFLE(3, 2, 3, 2)),
+			};
+			for (int k = 0; k < 4; ++k)
+			{
+				_mm_storeu_ps(dst + k * 16 + column * 4, _mm256_castps256_ps128(m[k]));
+				_mm_storeu_ps(dst + (k + 4) * 16 + column * 4, _mm256_extractf128_ps(m[k], 1));
+			}
+		}
+	}
+
+	compose_trs_sse41(trs + i, out + i, count - i);
+}
+
+#endif
+
+using ComposeFn = void (*)(const TRS*, glm::mat4*, size_t);
+
+ComposeFn select_compose(SimdLevel level)
+{
+#if ENG_SIMD_X86
+	switch (level)
+	{
+	case SimdLevel::AVX2: return &compose_trs_avx2;
+	case SimdLevel::SSE41: return &compose_trs_sse41;
+	default: break;
+	}
+#endif
+	return &compose_trs_scalar;
+}
+
+} // end namespace
+
+void compose_trs_batch(const TRS* trs, glm::mat4* out, size_t count)
+{
+	static const ComposeFn compose = select_compose(best_simd_level());
+	compose(trs, out, count);
+}
+
+void compose_trs_batch(const TRS* trs, glm::mat4* out, size_t count, SimdLevel level)
+{
+	select_compose(level)(trs, out, count);
+}
+
+} // end namespace
@@ -0,0 +1,247 @@
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include "scene/TriangleBvh.hpp"
+
+namespace ENG
+{
+
+namespace {
+
+constexpr int SAH_BIN_COUNT = 12;
+
+glm::vec3 point_at(const float* positions, size_t i, size_t stride)
+{
+	const auto* p = reinterpret_cast<const float*>(reinterpret_cast<const char*>(positions) + i * stride);
+	return { p[0], p[1], p[2] };
+}
+
+float area_or_zero(const AABB& box)
+{
+	return is_empty(box) ? 0.f : surface_area(box);
+}
+
+// Moller-Trumbore, accepting both faces
+bool intersect_triangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& v0,
+	const glm::vec3& edge1, const glm::vec3& edge2, float& t, float& u, float& v)
+{
+	const auto p = glm::cross(direction, edge2);
+	const float det = glm::dot(edge1, p);
+	if (std::fabs(det) < 1e-12f) return false;
+
+	const float invDet = 1.f / det;
+	const auto s = origin - v0;
+	u = glm::dot(s, p) * invDet;
+	if (u < 0.f || u > 1.f) return false;
+
+	const auto q = glm::cross(s, edge1);
+	v = glm::dot(direction, q) * invDet;
+	if (v < 0.f || u + v > 1.f) return false;
+
+	t = glm::dot(edge2, q) * invDet;
+	return true;
+}
+
+} // end namespace
+
+TriangleBvh::TriangleBvh(const float* positions, size_t vertexCount, size_t stride, std::span<const uint32_t> indices)
+{
+	const size_t triangleCount = indices.empty() ? vertexCount / 3 : indices.size() / 3;
+	if (triangleCount == 0) return;
+
+	const auto vertex = [&](size_t corner) -> glm::vec3 {
+		const size_t index = indices.empty() ? corner : indices[corner];
+		if (index >= vertexCount)
+		{
+			throw std::runtime_error("TriangleBvh: index " + std::to_string(index) + " out of range of " + std::to_string(vertexCount) + " vertices");
+		}
+		return point_at(positions, index, stride);
+	};
+
+	std::vector<Triangle> source(triangleCount);
+	std::vector<AABB> boxes(triangleCount);
+	std::vector<glm::vec3> centroids(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		const auto a = vertex(3 * i);
+		const auto b = vertex(3 * i + 1);
+		const auto c = vertex(3 * i + 2);
+		source[i] = { a, b - a, c - a };
+		boxes[i] = make_aabb(glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)));
+		centroids[i] = center(boxes[i]);
+	}
+
+	triangleIds.resize(triangleCount);
+	std::iota(triangleIds.begin(), triangleIds.end(), 0u);
+
+	nodes.reserve(2 * triangleCount);
+	nodes.push_back({ {}, 0, static_cast<uint32_t>(triangleCount) });
+	subdivide(0, boxes, centroids);
+	nodes.shrink_to_fit();
+
+	triangles.resize(triangleCount);
+	for (size_t i = 0; i < triangleCount; ++i)
+	{
+		triangles[i] = source[triangleIds[i]];
+	}
+}
+
+void TriangleBvh::subdivide(uint32_t rootId, std::vector<AABB>& boxes, std::vector<glm::vec3>& centroids)
+{
+	std::vector<uint32_t> pending{ rootId };
+	while (!pending.empty())
+	{
+		const auto nodeId = pending.back();
+		pending.pop_back();
+
+		const auto first = nodes[nodeId].first;
+		const auto count = nodes[nodeId].count;
+		AABB box;
+		AABB centroidBox;
+		for (uint32_t i = first; i < first + count; ++i)
+		{
+			box = merge(box, boxes[triangleIds[i]]);
+			const auto& c = centroids[triangleIds[i]];
+			centroidBox = merge(centroidBox, make_aabb(c, c));
+		}
+		nodes[nodeId].box = box;
+		if (count <= TRIANGLE_BVH_MAX_LEAF_SIZE) continue;
+
+		// Binned SAH over the centroid bounds on every axis
+		int bestAxis = -1;
+		int bestSplit = 0;
+		float bestCost = area_or_zero(box) * static_cast<float>(count);
+		const auto lo = glm::vec3(centroidBox.min);
+		const auto span = glm::vec3(centroidBox.max) - lo;
+		for (int axis = 0; axis < 3; ++axis)
+		{
+			if (span[axis] <= 0.f) continue;
+
+			std::array<AABB, SAH_BIN_COUNT> binBoxes{};
+			std::array<uint32_t, SAH_BIN_COUNT> binCounts{};
+			const float scale = SAH_BIN_COUNT / span[axis];
+			for (uint32_t i = first; i < first + count; ++i)
+			{
+				const auto id = triangleIds[i];
+				const int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((centroids[id][axis] - lo[axis]) * scale));
+				binBoxes[bin] = merge(binBoxes[bin], boxes[id]);
+				++binCounts[bin];
+			}
+
+			// Sweep from the right to get the cost of every right side, then from the left
+			std::array<float, SAH_BIN_COUNT> rightCost{};
+			AABB right;
+			uint32_t rightCount = 0;
+			for (int bin = SAH_BIN_COUNT - 1; bin > 0; --bin)
+			{
+				right = merge(right, binBoxes[bin]);
+				rightCount += binCounts[bin];
+				rightCost[bin] = area_or_zero(right) * static_cast<float>(rightCount);
+			}
+			AABB left;
+			uint32_t leftCount = 0;
+			for (int split = 1; split < SAH_BIN_COUNT; ++split)
+			{
+				left = merge(left, binBoxes[split - 1]);
+				leftCount += binCounts[split - 1];
+				if (leftCount == 0 || leftCount == count) continue;
+				const float cost = area_or_zero(left) * static_cast<float>(leftCount) + rightCost[split];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestAxis = axis;
+					bestSplit = split;
+				}
+			}
+		}
+		if (bestAxis < 0) continue;  // no split beats a leaf, or all centroids coincide
+
+		const float scale = SAH_BIN_COUNT / span[bestAxis];
+		const auto middle = std::partition(triangleIds.begin() + first, triangleIds.begin() + first + count,
+			[&](uint32_t id) {
+				// Same binning as above, so the partition matches the evaluated split exactly
+				const int bin = std::min(SAH_BIN_COUNT - 1, static_cast<int>((centroids[id][bestAxis] - lo[bestAxis]) * scale));
+				return bin < bestSplit;
+			});
+		const auto leftCount = static_cast<uint32_t>(middle - (triangleIds.begin() + first));
+
+		const auto leftId = static_cast<uint32_t>(nodes.size());
+		nodes.push_back({ {}, first, leftCount });
+		nodes.push_back({ {}, first + leftCount, count - leftCount });
+		nodes[nodeId].first = leftId;
+		nodes[nodeId].count = 0;
+		pending.push_back(leftId + 1);
+		pending.push_back(leftId);
+	}
+}
+
+bool TriangleBvh::intersect(const Ray& input, TriangleHit& hit) const
+{
+	if (nodes.empty()) return false;
+
+	auto ray = input;
+	float tEntry = 0.f;
+	if (!intersect_ray(ray, nodes.front().box, tEntry)) return false;
+
+	bool found = false;
+	std::array<uint32_t, 64> stack;
+	std::vector<uint32_t> overflow;
+	size_t depth = 0;
+	const auto push = [&](uint32_t id) {
+		if (depth < stack.size()) stack[depth] = id;
+		else overflow.push_back(id);
+		++depth;
+	};
+	const auto pop = [&]() {
+		--depth;
+		if (depth < stack.size()) return stack[depth];
+		const auto id = overflow.back();
+		overflow.pop_back();
+		return id;
+	};
+
+	push(0);
+	while (depth > 0)
+	{
+		const auto& node = nodes[pop()];
+		// Re-tested because an earlier hit may have clipped the ray since the push
+		if (!intersect_ray(ray, node.box, tEntry)) continue;
+
+		if (node.count > 0)
+		{
+			for (uint32_t i = node.first; i < node.first + node.count; ++i)
+			{
+				const auto& tri = triangles[i];
+				float t, u, v;
+				if (intersect_triangle(ray.origin, ray.direction, tri.v0, tri.edge1, tri.edge2, t, u, v)
+					&& t >= 0.f && t <= ray.maxT)
+				{
+					ray.maxT = t;
+					hit = { triangleIds[i], t, u, v };
+					found = true;
+				}
+			}
+			continue;
+		}
+
+		// Nearest child last, so it is popped first and clips the farther one
+		float tLeft = 0.f;
+		float tRight = 0.f;
+		const bool hitLeft = intersect_ray(ray, nodes[node.first].box, tLeft);
+		const bool hitRight = intersect_ray(ray, nodes[node.first + 1].box, tRight);
+		if (hitLeft && hitRight)
+		{
+			push(tLeft <= tRight ? node.first + 1 : node.first);
+			push(tLeft <= tRight ? node.first : node.first + 1);
+		}
+		else if (hitLeft) push(node.first);
+		else if (hitRight) push(node.first + 1);
+	}
+	return found;
+}
+
+} // end namespace
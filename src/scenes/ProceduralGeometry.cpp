@@ -2,7 +2,7 @@
 #include "scenes/ProceduralGeometry.hpp"
 #include "renderer/vk/Renderer.hpp"
 #include "renderer/vk_adapter/VkAdapter.hpp"
-#include "application/ConcurrentQueue.hpp"
+#include "application/MpscQueue.hpp"
 #include "pmp/surface_mesh.h"
 #include "pmp/algorithms/triangulation.h"
 #include "pmp/algorithms/shapes.h"
@@ -176,14 +176,12 @@ pmp::SurfaceMesh create_dodecahedron()
 }
 
 void load_pmp_mesh(
-	ENG::Node& parent, const pmp::SurfaceMesh& mesh, const std::string& mesh_name, const std::string& node_name, const glm::vec4& color,
-	VkAdapter& adapter, SceneState& sceneState, ConcurrentQueue<GraphicsEvent>& graphicsEventQueue)
+	ENG::Node& pmpNode, const pmp::SurfaceMesh& mesh, const std::string& mesh_name, const glm::vec4& color,
+	VkAdapter& adapter, SceneState& sceneState, MpscQueue<GraphicsEvent>& graphicsEventQueue)
 {
+	// One vertex triple per face for flat normals, drawn without indices
 	std::vector<VertexPosNorCol> vertices;
-	std::vector<uint32_t> indices;
-
-	vertices.reserve(mesh.vertices_size());
-	indices.resize(12); // unused
+	vertices.reserve(mesh.faces_size() * 3);
 
 	const auto& points = mesh.get_vertex_property<pmp::Point>("v:point");
 
@@ -211,19 +209,15 @@ void load_pmp_mesh(
 		vertices.emplace_back(vert2);
 	}
 
-	auto& pmpNode = sceneState.graph.create_node();
-	pmpNode.name = node_name;
-	pmpNode.parent = &parent;
 	pmpNode.selectable = true;
-	parent.children.push_back(&pmpNode);
 
 	graphicsEventQueue.push(
 		BindHostMeshDataEvent{
-			HostMeshData{
+			prepare_host_mesh_data(HostMeshData{
 				std::move(vertices),
-				std::move(indices),
+				{},
 				"PosNorCol"
-			},
+			}),
 			pmpNode.nodeId
 		}
 	);
@@ -231,12 +225,48 @@ void load_pmp_mesh(
 
 void triangulate_as_triangle_fan_preserving_face_ids(pmp::SurfaceMesh& mesh, const std::vector<glm::vec4>& faceColors, VkAdapter& adapter, SceneState& sceneState)
 {
-	// parent node for all submeshes
-	auto& parentNode = sceneState.graph.create_node();
-	parentNode.name = "Goldberg";
-	parentNode.parent = sceneState.graph.root;
+	// Parent node for all submeshes at batch position 0, followed by one node per face,
+	// all created and linked under a single lock
+	const auto tileCount = mesh.faces_size();
+	std::vector<uint32_t> batchParents(tileCount + 1, 0);
+	batchParents[0] = SceneGraph::BATCH_ROOT;
+	std::vector<std::string> nodeNames;
+	nodeNames.reserve(tileCount + 1);
+	nodeNames.emplace_back("Goldberg");
+	for (size_t tile = 0; tile < tileCount; ++tile)
+	{
+		nodeNames.push_back("GoldbergPolyhedra_" + std::to_string(tile));
+	}
+	const auto range = sceneState.graph.create_nodes(batchParents, sceneState.graph.root);
+	sceneState.graph.set_names(range, nodeNames);
+
+	auto& parentNode = sceneState.graph.nodes[range.first];
 	parentNode.selectable = true;
-	sceneState.graph.root->children.push_back(&parentNode);
+
+	// Tile outlines by faceId, so picking resolves a faceId from a ray without touching the tile meshes
+	{
+		std::vector<std::vector<glm::vec3>> outlines(tileCount);
+		for (auto f : mesh.faces())
+		{
+			const auto faceId = mesh.get_face_property<uint32_t>("f:faceId")[f];
+			for (auto v : mesh.vertices(f))
+			{
+				const auto& p = mesh.position(v);
+				outlines.at(faceId).emplace_back(p[0], p[1], p[2]);
+			}
+		}
+		std::vector<uint32_t> offsets{ 0 };
+		std::vector<glm::vec3> vertices;
+		for (const auto& outline : outlines)
+		{
+			vertices.insert(vertices.end(), outline.begin(), outline.end());
+			offsets.push_back(static_cast<uint32_t>(vertices.size()));
+		}
+		sceneState.worldTiles.build(offsets, vertices);
+		sceneState.worldTilesNode = sceneState.graph.handle_of(parentNode);
+		ENG_LOG_DEBUG("World tile index: " << sceneState.worldTiles.tile_count() << " tiles, "
+			<< sceneState.worldTiles.max_candidates() << " candidates per cell at most" << std::endl);
+	}
 
 	// create new SurfaceMesh for every face
 	std::vector<pmp::SurfaceMesh> newMeshes;
@@ -281,11 +311,10 @@ void triangulate_as_triangle_fan_preserving_face_ids(pmp::SurfaceMesh& mesh, con
 
 		std::stringstream meshName;
 		meshName << "GoldbergMesh_" << meshcount;
-		std::stringstream nodeName;
-		nodeName << "GoldbergPolyhedra_" << meshcount;
-
 
-		load_pmp_mesh(parentNode, newMesh, meshName.str(), nodeName.str(), faceColor, adapter, sceneState, adapter.graphicsEventQueue);
+		auto& tileNode = sceneState.graph.nodes[range.id(meshcount + 1)];
+		tileNode.occluder = true;  // the planet hides whatever is behind it
+		load_pmp_mesh(tileNode, newMesh, meshName.str(), faceColor, adapter, sceneState, adapter.graphicsEventQueue);
 		meshcount++;
 	}
 
@@ -2,7 +2,7 @@
 #include "scenes/ProceduralGeometry.hpp"
 #include "scene/Mesh.hpp"
 #include "renderer/vk_adapter/VkAdapter.hpp"
-#include "application/ConcurrentQueue.hpp"
+#include "application/MpscQueue.hpp"
 #include "scenes/SceneWorld.hpp"
 #include "scenes/SceneWorldInput.hpp"
 
@@ -199,7 +199,7 @@ void create_world_polyhedra(VkRenderer& renderer, VkAdapter& adapter, SceneState
 	}
 }
 
-void create_tetrahedron_no_pmp(SceneState& sceneState, ConcurrentQueue<GraphicsEvent>& graphicsEventQueue, const std::string& nodeName)
+void create_tetrahedron_no_pmp(SceneState& sceneState, MpscQueue<GraphicsEvent>& graphicsEventQueue, const std::string& nodeName)
 {
 	std::vector<VertexPosNorCol> tetraVertices {
 		{ {1.,  1.,  1.} },
@@ -208,13 +208,6 @@ void create_tetrahedron_no_pmp(SceneState& sceneState, ConcurrentQueue<GraphicsE
 		{ {-1., -1., 1.} }
 	};
 
-	std::vector<uint32_t> tetraIndices {
-		0, 1, 2,
-		0, 3, 1,
-		0, 2, 3,
-		3, 2, 1
-	};
-
 	std::vector<glm::vec4> colors {
 		{1.0, 0.5, 0.5, 1.0},
 		{0.5, 1.0, 0.5, 1.0},
@@ -222,7 +215,7 @@ void create_tetrahedron_no_pmp(SceneState& sceneState, ConcurrentQueue<GraphicsE
 		{0.5, 0.5, 0.5, 1.0},
 	};
 
-	// vertices are duplicated for face-specific color
+	// vertices are duplicated for face-specific color, one triple per face drawn without indices
 	std::vector<VertexPosNorCol> tetraVerticesDuplicated {
 		tetraVertices.at(0), tetraVertices.at(1), tetraVertices.at(2),
 		tetraVertices.at(0), tetraVertices.at(3), tetraVertices.at(1),
@@ -246,33 +239,45 @@ void create_tetrahedron_no_pmp(SceneState& sceneState, ConcurrentQueue<GraphicsE
 	}
 
 	auto& tetraNode = sceneState.graph.create_node();
-	tetraNode.name = nodeName;
-	tetraNode.parent = sceneState.graph.root;
-	sceneState.graph.root->children.push_back(&tetraNode);
+	sceneState.graph.set_name(tetraNode, nodeName);
+	sceneState.graph.add_child(*sceneState.graph.root, tetraNode);
 
 	graphicsEventQueue.push(
 		BindHostMeshDataEvent{
-			HostMeshData{
+			prepare_host_mesh_data(HostMeshData{
 				std::move(tetraVerticesDuplicated),
-				std::move(tetraIndices),
+				{},
 				"PosNorCol"
-			},
+			}),
 			tetraNode.nodeId
 		}
 	);
 }
 
-void unloadWorldScene(SceneState& sceneState)
+void unloadWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState)
 {
+	// Must run on the main thread: draw data is released between frames
+	renderer.sceneReadyToRender = false;
+	sceneState.initialized = false;
+
+	if (sceneState.graph.root != nullptr)
+	{
+		adapter.destroyNodeSubtree(sceneState, *sceneState.graph.root);
+	}
 
+	// Camera nodes are gone, so nothing references the cameras anymore
+	sceneState.graph.cameras.clear();
+	sceneState.activeCameraNodeIdx = 0;
+	sceneState.activeNodeIdx = 0;
+	sceneState.worldTiles.clear();
+	sceneState.worldTilesNode = {};
+	ENG_LOG_DEBUG("World scene unloaded, " << sceneState.graph.nodes.live_count() << " nodes remain" << std::endl);
 }
 
 void initializeWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState& sceneState) {
 	// Set callback handlers for inputs
 	SceneWorldInput::set_callbacks();
 
-	// TODO: implement pools to avoid reference invalidation on reallocation problem
-	sceneState.graph.nodes.reserve(1000);
 	sceneState.graph.cameras.reserve(100);
 
 	// Create modelMatrices mapped to SceneGraph node idx (index is 1-1 with scenegraph.nodes)
@@ -282,10 +287,12 @@ void initializeWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState&
 
 	// These are AABBs for nodes, with 1-1 indexing with scenegraph.nodes
 	sceneState.aabbs.resize(SCENE_WORLD_MAX_NODES);
+	sceneState.boundingSpheres.resize(SCENE_WORLD_MAX_NODES);
+	sceneState.pickMeshes.resize(SCENE_WORLD_MAX_NODES);
 
-	auto& attachmentPoint = sceneState.graph.nodes.emplace_back();
+	auto& attachmentPoint = sceneState.graph.create_node();
 	sceneState.graph.root = &attachmentPoint;
-	sceneState.graph.root->name = "Root";
+	sceneState.graph.set_name(attachmentPoint, "Root");
 
 	load_gltf(adapter, get_gltf_dir(), sceneState, attachmentPoint);
 	auto& cameraNode = sceneState.graph.nodes.at(sceneState.activeCameraNodeIdx);
@@ -293,6 +300,14 @@ void initializeWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState&
 	const auto& meshName = std::string("Room");
 	ENG::loadModel(adapter, meshName, get_room_obj(), get_room_tex(), sceneState, attachmentPoint);
 
+	// The room's walls hide most of what is outside it
+	sceneState.graph.read_structure([&attachmentPoint, &meshName]() {
+		for (auto* child : attachmentPoint.children)
+		{
+			if (child->name().starts_with(meshName + "-")) child->occluder = true;
+		}
+	});
+
 	// load space floor
 	ENG::loadModel(adapter, "Spacefloor3", get_spacefloor_obj2(), get_spacefloor_tex(), sceneState, attachmentPoint);
 
@@ -329,12 +344,14 @@ void initializeWorldScene(VkRenderer& renderer, VkAdapter& adapter, SceneState&
 	{
 		tetrahedronNode->visible = true;
 		tetrahedronNode->translation = glm::vec3(0., 1., 0.);
+		sceneState.graph.mark_transform_dirty(*tetrahedronNode);
 	}
 
 	auto* camera = cameraNode.camera;
 	camera->fovy = 1.;
 
 	cameraNode.translation = glm::vec3(0., 0., 8.);
+	sceneState.graph.mark_transform_dirty(cameraNode);
 
 	sceneState.activeNodeIdx = 3;
 }
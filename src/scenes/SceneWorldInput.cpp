@@ -96,6 +96,12 @@ void SceneWorldInput::mouse_button_callback(GLFWwindow* window, int button, int
 {
 	auto* windowUserData = static_cast<WindowUserData*>(glfwGetWindowUserPointer(window));
 
+	if (button == GLFW_MOUSE_BUTTON_LEFT && action == GLFW_PRESS)
+	{
+		ENG_LOG_TRACE("Left mouse press" << std::endl);
+		windowUserData->selectRequested = true;
+	}
+
 	if (button == GLFW_MOUSE_BUTTON_MIDDLE)
 	{
 		if (action == GLFW_PRESS) // && initial_press)
@@ -0,0 +1,139 @@
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "application/MpscQueue.hpp"
+
+namespace {
+
+struct Item {
+	uint32_t producer{ 0 };
+	uint32_t sequence{ 0 };
+};
+
+// Pushes count items per producer from producerCount threads while this thread drains
+// them, and checks that every item arrives exactly once and in order for its producer.
+void run_stress(MpscQueue<Item>& queue, uint32_t producerCount, uint32_t count)
+{
+	std::vector<std::thread> producers;
+	for (uint32_t p = 0; p < producerCount; ++p) {
+		producers.emplace_back([&queue, p, count] {
+			for (uint32_t i = 0; i < count; ++i) {
+				queue.push(Item{ p, i });
+			}
+		});
+	}
+
+	std::vector<uint32_t> next(producerCount, 0);
+	std::array<Item, 16> items{};
+	size_t received = 0;
+	size_t outOfOrder = 0;
+	const size_t total = size_t{ producerCount } * count;
+	while (received < total) {
+		const auto drained = queue.drain_into(items);
+		if (drained == 0) std::this_thread::yield();
+		for (size_t i = 0; i < drained; ++i) {
+			const auto& item = items[i];
+			if (item.sequence != next[item.producer]) ++outOfOrder;
+			next[item.producer] = item.sequence + 1;
+		}
+		received += drained;
+	}
+	for (auto& producer : producers) {
+		producer.join();
+	}
+
+	EXPECT_EQ(outOfOrder, 0u);
+	EXPECT_EQ(next, std::vector<uint32_t>(producerCount, count));
+	EXPECT_TRUE(queue.empty());
+}
+
+} // end namespace
+
+TEST(MpscQueue, PopsInPushOrder) {
+	MpscQueue<int> queue;
+	EXPECT_TRUE(queue.empty());
+	EXPECT_FALSE(queue.try_pop().has_value());
+
+	for (int i = 0; i < 3; ++i) queue.push(i);
+	EXPECT_EQ(queue.try_pop(), 0);
+
+	// Pushed while the consumer still holds older items
+	queue.push(3);
+	for (int i = 1; i < 4; ++i) {
+		EXPECT_EQ(queue.try_pop(), i);
+	}
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, DrainKeepsWhatDoesNotFit) {
+	MpscQueue<int> queue;
+	for (int i = 0; i < 5; ++i) queue.push(i);
+
+	std::array<int, 3> small{};
+	ASSERT_EQ(queue.drain_into(small), 3u);
+	EXPECT_EQ(small, (std::array<int, 3>{ 0, 1, 2 }));
+	EXPECT_FALSE(queue.empty());
+
+	// Leftovers come before anything pushed since
+	queue.push(5);
+	std::array<int, 8> large{};
+	ASSERT_EQ(queue.drain_into(large), 3u);
+	EXPECT_EQ(large[0], 3);
+	EXPECT_EQ(large[1], 4);
+	EXPECT_EQ(large[2], 5);
+	EXPECT_EQ(queue.drain_into(large), 0u);
+	EXPECT_TRUE(queue.empty());
+}
+
+TEST(MpscQueue, TryPushFailsAtCapacity) {
+	MpscQueue<std::unique_ptr<int>> queue(2);
+	EXPECT_EQ(queue.capacity(), 2u);
+	EXPECT_TRUE(queue.try_push(std::make_unique<int>(0)));
+	EXPECT_TRUE(queue.try_push(std::make_unique<int>(1)));
+
+	auto rejected = std::make_unique<int>(2);
+	EXPECT_FALSE(queue.try_push(std::move(rejected)));
+	ASSERT_NE(rejected, nullptr);
+
+	ASSERT_EQ(*queue.try_pop().value(), 0);
+	EXPECT_TRUE(queue.try_push(std::move(rejected)));
+	EXPECT_EQ(*queue.try_pop().value(), 1);
+	EXPECT_EQ(*queue.try_pop().value(), 2);
+}
+
+TEST(MpscQueue, BlockedPushWakesAfterDrain) {
+	MpscQueue<int> queue(1);
+	queue.push(0);
+
+	std::atomic<bool> pushed{ false };
+	std::thread producer([&] {
+		queue.push(1);
+		pushed.store(true, std::memory_order_release);
+	});
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	EXPECT_FALSE(pushed.load(std::memory_order_acquire));
+
+	std::array<int, 4> items{};
+	ASSERT_EQ(queue.drain_into(items), 1u);
+	EXPECT_EQ(items[0], 0);
+	producer.join();
+	EXPECT_TRUE(pushed.load(std::memory_order_acquire));
+	EXPECT_EQ(queue.try_pop(), 1);
+}
+
+TEST(MpscQueue, ManyProducersLoseNothing) {
+	MpscQueue<Item> queue;
+	run_stress(queue, 4, 20000);
+}
+
+TEST(MpscQueue, ManyProducersLoseNothingWhenBounded) {
+	MpscQueue<Item> queue(64);
+	run_stress(queue, 4, 20000);
+}
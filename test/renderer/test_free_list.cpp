@@ -0,0 +1,109 @@
+#include <random>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "renderer/vk_adapter/FreeList.hpp"
+
+TEST(FreeList, PicksSmallestRangeThatFits) {
+	FreeList list(100);
+	ASSERT_EQ(list.allocate(10), 0u);
+	const auto b = list.allocate(20);
+	ASSERT_EQ(list.allocate(10), 30u);
+	const auto d = list.allocate(30);
+	ASSERT_EQ(list.allocate(15), 70u);
+	ASSERT_TRUE(b.has_value() && d.has_value());
+
+	// Free ranges of 20 at 10, 30 at 40 and 15 at 85
+	list.free(*b, 20);
+	list.free(*d, 30);
+	EXPECT_EQ(list.free_count(), 65u);
+
+	EXPECT_EQ(list.allocate(25), 40u);
+	EXPECT_EQ(list.allocate(15), 85u);
+	EXPECT_EQ(list.allocate(12), 10u);
+	EXPECT_EQ(list.free_count(), 13u);
+}
+
+TEST(FreeList, AlignsOffsets) {
+	FreeList list(64);
+	ASSERT_EQ(list.allocate(3), 0u);
+	EXPECT_EQ(list.allocate(8, 8), 8u);
+	EXPECT_EQ(list.free_count(), 53u);
+
+	// The padding stays free
+	EXPECT_EQ(list.allocate(5), 3u);
+	EXPECT_EQ(list.allocate(4, 16), 16u);
+}
+
+TEST(FreeList, SkipsBestFitThatIsTooSmallOnceAligned) {
+	FreeList list(40);
+	ASSERT_EQ(list.allocate(1), 0u);
+	ASSERT_EQ(list.allocate(9), 1u);
+	ASSERT_EQ(list.allocate(6), 10u);
+	ASSERT_EQ(list.allocate(24), 16u);
+	list.free(1, 9);
+	list.free(16, 24);
+
+	// 9 units at 1 only hold 2 from 8 on
+	EXPECT_EQ(list.allocate(8, 8), 16u);
+	EXPECT_EQ(list.allocate(2, 8), 8u);
+}
+
+TEST(FreeList, MergesWithBothNeighbours) {
+	FreeList list(30);
+	ASSERT_EQ(list.allocate(10), 0u);
+	ASSERT_EQ(list.allocate(10), 10u);
+	ASSERT_EQ(list.allocate(10), 20u);
+
+	list.free(0, 10);
+	list.free(20, 10);
+	EXPECT_FALSE(list.allocate(11).has_value());
+
+	list.free(10, 10);
+	EXPECT_EQ(list.free_count(), 30u);
+	EXPECT_EQ(list.allocate(30), 0u);
+}
+
+TEST(FreeList, ReturnsNulloptWhenExhausted) {
+	FreeList list(16);
+	EXPECT_FALSE(list.allocate(17).has_value());
+	EXPECT_FALSE(list.allocate(0).has_value());
+	ASSERT_EQ(list.allocate(16), 0u);
+	EXPECT_EQ(list.free_count(), 0u);
+	EXPECT_FALSE(list.allocate(1).has_value());
+
+	list.free(4, 4);
+	EXPECT_FALSE(list.allocate(5).has_value());
+	EXPECT_EQ(list.allocate(4), 4u);
+}
+
+TEST(FreeList, ChurnLeavesOneFreeRange) {
+	constexpr uint32_t CAPACITY = 4096;
+	FreeList list(CAPACITY);
+	std::mt19937 rng(7);
+	std::uniform_int_distribution<uint32_t> size(1, 64);
+	std::vector<std::pair<uint32_t, uint32_t>> live;
+
+	for (int step = 0; step < 5000; ++step) {
+		if (!live.empty() && rng() % 3 == 0) {
+			const auto victim = rng() % live.size();
+			list.free(live[victim].first, live[victim].second);
+			live[victim] = live.back();
+			live.pop_back();
+			continue;
+		}
+		const auto count = size(rng);
+		if (const auto offset = list.allocate(count)) {
+			live.emplace_back(*offset, count);
+		}
+	}
+	ASSERT_FALSE(live.empty());
+
+	for (const auto& [offset, count] : live) {
+		list.free(offset, count);
+	}
+	EXPECT_EQ(list.free_count(), CAPACITY);
+	EXPECT_EQ(list.allocate(CAPACITY), 0u);
+}
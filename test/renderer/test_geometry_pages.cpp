@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include "renderer/vk_adapter/GeometryPages.hpp"
+
+namespace {
+
+// 64 vertices of 16 bytes and 256 indices per page
+constexpr uint64_t PAGE_SIZE = 1024;
+constexpr uint32_t STRIDE = 16;
+
+} // end namespace
+
+TEST(GeometryPages, AddsPageWhenNoneFits) {
+	GeometryPages pages(PAGE_SIZE);
+	EXPECT_EQ(pages.page_count(0), 0u);
+
+	const auto a = pages.allocate(0, STRIDE, 32, 60);
+	const auto b = pages.allocate(0, STRIDE, 32, 60);
+	EXPECT_EQ(a.page, 0u);
+	EXPECT_EQ(b.page, 0u);
+	EXPECT_EQ(b.firstVertex, 32u);
+	EXPECT_EQ(b.firstIndex, 60u);
+	EXPECT_EQ(pages.vertex_capacity(0, 0), 64u);
+	EXPECT_EQ(pages.index_capacity(0, 0), 256u);
+
+	const auto c = pages.allocate(0, STRIDE, 32, 60);
+	EXPECT_EQ(c.page, 1u);
+	EXPECT_EQ(c.firstVertex, 0u);
+	EXPECT_EQ(pages.page_count(0), 2u);
+}
+
+TEST(GeometryPages, ReusesFreedRangesBeforeGrowing) {
+	GeometryPages pages(PAGE_SIZE);
+	pages.allocate(0, STRIDE, 32, 60);
+	const auto b = pages.allocate(0, STRIDE, 32, 60);
+	pages.free(b);
+
+	const auto c = pages.allocate(0, STRIDE, 32, 60);
+	EXPECT_EQ(c.page, 0u);
+	EXPECT_EQ(c.firstVertex, 32u);
+	EXPECT_EQ(pages.page_count(0), 1u);
+}
+
+TEST(GeometryPages, SizesPagesUpForLargeMeshes) {
+	GeometryPages pages(PAGE_SIZE);
+	pages.allocate(0, STRIDE, 8, 8);
+
+	const auto large = pages.allocate(0, STRIDE, 100, 1000);
+	EXPECT_EQ(large.page, 1u);
+	EXPECT_EQ(pages.vertex_capacity(0, 1), 100u);
+	EXPECT_EQ(pages.index_capacity(0, 1), 1000u);
+
+	// The next small mesh still fits the first page
+	EXPECT_EQ(pages.allocate(0, STRIDE, 8, 8).page, 0u);
+}
+
+TEST(GeometryPages, ReturnsVerticesWhenIndicesDoNotFit) {
+	GeometryPages pages(PAGE_SIZE);
+	pages.allocate(0, STRIDE, 1, 256);
+
+	// Vertices fit page 0 but indices do not
+	const auto grown = pages.allocate(0, STRIDE, 1, 1);
+	EXPECT_EQ(grown.page, 1u);
+
+	// All 63 remaining vertices of page 0 are still free
+	const auto rest = pages.allocate(0, STRIDE, 63, 0);
+	EXPECT_EQ(rest.page, 0u);
+	EXPECT_EQ(rest.firstVertex, 1u);
+}
+
+TEST(GeometryPages, KeepsFormatsApart) {
+	GeometryPages pages(PAGE_SIZE);
+	pages.allocate(0, STRIDE, 64, 0);
+
+	const auto other = pages.allocate(1, 32, 4, 6);
+	EXPECT_EQ(other.format, 1u);
+	EXPECT_EQ(other.page, 0u);
+	EXPECT_EQ(pages.page_count(0), 1u);
+	EXPECT_EQ(pages.page_count(1), 1u);
+	EXPECT_EQ(pages.vertex_stride(1), 32u);
+	EXPECT_EQ(pages.vertex_capacity(1, 0), 32u);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "renderer/vk_adapter/RingAllocator.hpp"
+
+TEST(RingAllocator, AlignsOffsets) {
+	RingAllocator ring(64);
+	EXPECT_EQ(ring.allocate(3, 1), 0u);
+	EXPECT_EQ(ring.allocate(8, 16), 16u);
+	EXPECT_EQ(ring.allocate(8, 4), 24u);
+	EXPECT_TRUE(ring.has_open_batch());
+}
+
+TEST(RingAllocator, WrapsWhenTheEndDoesNotFit) {
+	RingAllocator ring(100);
+	ASSERT_EQ(ring.allocate(40, 1), 0u);
+	ring.close_batch(1);
+	ASSERT_EQ(ring.allocate(40, 1), 40u);
+	ring.close_batch(2);
+	ring.reclaim(1);
+
+	// 20 bytes left at the end, 40 free at the front
+	EXPECT_FALSE(ring.allocate(50, 1).has_value());
+	EXPECT_EQ(ring.allocate(30, 1), 0u);
+
+	// The wrapped head stops at the tail
+	EXPECT_FALSE(ring.allocate(20, 1).has_value());
+	ring.reclaim(2);
+	EXPECT_EQ(ring.allocate(20, 1), 30u);
+}
+
+TEST(RingAllocator, ReclaimsOnlyCompletedBatches) {
+	RingAllocator ring(64);
+	ring.close_batch(3);
+	EXPECT_FALSE(ring.oldest_serial().has_value());
+
+	ASSERT_EQ(ring.allocate(32, 1), 0u);
+	ring.close_batch(5);
+	ASSERT_EQ(ring.allocate(32, 1), 32u);
+	ring.close_batch(6);
+	EXPECT_FALSE(ring.has_open_batch());
+	EXPECT_FALSE(ring.allocate(1, 1).has_value());
+	EXPECT_EQ(ring.oldest_serial(), 5u);
+
+	ring.reclaim(4);
+	EXPECT_FALSE(ring.allocate(1, 1).has_value());
+	EXPECT_EQ(ring.oldest_serial(), 5u);
+
+	ring.reclaim(5);
+	EXPECT_EQ(ring.oldest_serial(), 6u);
+	EXPECT_EQ(ring.allocate(16, 1), 0u);
+	EXPECT_FALSE(ring.allocate(32, 1).has_value());
+	ring.close_batch(7);
+
+	// Once everything completed the whole ring is free again
+	ring.reclaim(7);
+	EXPECT_FALSE(ring.oldest_serial().has_value());
+	EXPECT_EQ(ring.allocate(64, 1), 0u);
+}
+
+TEST(RingAllocator, KeepsOpenBatchAcrossReclaim) {
+	RingAllocator ring(64);
+	ASSERT_EQ(ring.allocate(16, 1), 0u);
+	ring.reclaim(100);
+	EXPECT_TRUE(ring.has_open_batch());
+	EXPECT_EQ(ring.allocate(16, 1), 16u);
+}
+
+TEST(RingAllocator, RejectsAllocationsLargerThanTheRing) {
+	RingAllocator ring(64);
+	EXPECT_FALSE(ring.allocate(65, 1).has_value());
+	EXPECT_FALSE(ring.allocate(0, 1).has_value());
+	EXPECT_FALSE(ring.has_open_batch());
+	EXPECT_EQ(ring.allocate(64, 1), 0u);
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/Bvh.hpp"
+
+namespace {
+
+ENG::AABB unit_box_at(const glm::vec3& p)
+{
+	return ENG::make_aabb(p - glm::vec3(0.5f), p + glm::vec3(0.5f));
+}
+
+std::vector<uint32_t> sorted(std::vector<uint32_t> ids)
+{
+	std::sort(ids.begin(), ids.end());
+	return ids;
+}
+
+} // end namespace
+
+TEST(Bounds, TransformAabbCoversRotatedBox) {
+	const auto local = ENG::make_aabb(glm::vec3(-1.f), glm::vec3(1.f));
+	glm::mat4 m(1.f);
+	// 90 degrees about z, then translate
+	m[0] = glm::vec4(0.f, 1.f, 0.f, 0.f);
+	m[1] = glm::vec4(-1.f, 0.f, 0.f, 0.f);
+	m[3] = glm::vec4(10.f, 0.f, 0.f, 1.f);
+	const auto world = ENG::transform_aabb(m, local);
+	EXPECT_FLOAT_EQ(world.min.x, 9.f);
+	EXPECT_FLOAT_EQ(world.max.x, 11.f);
+	EXPECT_FLOAT_EQ(world.max.z, 1.f);
+	EXPECT_TRUE(ENG::is_empty(ENG::AABB{}));
+}
+
+class ComputePointBounds : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(ComputePointBounds, MatchesScalarForAnyStride) {
+	const auto level = GetParam();
+	if (static_cast<int>(level) > static_cast<int>(ENG::best_simd_level())) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	// Tightly packed positions (12 byte stride) and an interleaved 40 byte vertex,
+	// with counts that leave every possible tail
+	struct Interleaved { glm::vec3 pos; float extra[7]; };
+	std::mt19937 rng(5);
+	std::uniform_real_distribution<float> dist(-50.f, 50.f);
+	for (size_t count : { 0, 1, 2, 3, 4, 5, 9, 131 }) {
+		std::vector<glm::vec3> packed(count);
+		std::vector<Interleaved> interleaved(count);
+		glm::vec3 lo{ std::numeric_limits<float>::max() };
+		glm::vec3 hi{ -std::numeric_limits<float>::max() };
+		for (size_t i = 0; i < count; ++i) {
+			packed[i] = { dist(rng), dist(rng), dist(rng) };
+			interleaved[i].pos = packed[i];
+			std::fill(std::begin(interleaved[i].extra), std::end(interleaved[i].extra), 1e9f);
+			lo = glm::min(lo, packed[i]);
+			hi = glm::max(hi, packed[i]);
+		}
+
+		const auto a = ENG::compute_point_bounds(count ? &packed[0].x : nullptr, count, sizeof(glm::vec3), level);
+		const auto b = ENG::compute_point_bounds(count ? &interleaved[0].pos.x : nullptr, count, sizeof(Interleaved), level);
+		if (count == 0) {
+			EXPECT_TRUE(ENG::is_empty(a.box));
+			EXPECT_TRUE(ENG::is_empty(b.box));
+			continue;
+		}
+		for (const auto& bounds : { a, b }) {
+			for (int axis = 0; axis < 3; ++axis) {
+				EXPECT_EQ(bounds.box.min[axis], lo[axis]) << "count " << count;
+				EXPECT_EQ(bounds.box.max[axis], hi[axis]) << "count " << count;
+			}
+			for (const auto& p : packed) {
+				EXPECT_LE(glm::length(p - bounds.sphere.center), bounds.sphere.radius * 1.0001f);
+			}
+		}
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, ComputePointBounds,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});
+
+TEST(DynamicAabbTree, StaysBalancedAndMatchesBruteForce) {
+	ENG::DynamicAabbTree tree;
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> coord(-100.f, 100.f);
+
+	std::vector<glm::vec3> positions;
+	std::vector<int32_t> proxies;
+	for (uint32_t i = 0; i < 2000; ++i) {
+		positions.emplace_back(coord(rng), coord(rng), coord(rng));
+		proxies.push_back(tree.create_proxy(unit_box_at(positions.back()), i));
+	}
+	// Sorted insertion order is the worst case for an unbalanced tree
+	for (uint32_t i = 0; i < 1000; ++i) {
+		positions.emplace_back(static_cast<float>(i), 0.f, 0.f);
+		proxies.push_back(tree.create_proxy(unit_box_at(positions.back()), 2000 + i));
+	}
+	ASSERT_TRUE(tree.validate());
+	EXPECT_EQ(tree.proxy_count(), 3000u);
+	EXPECT_LE(tree.height(), 24);
+
+	// Move half of them far enough to leave their fat boxes
+	for (size_t i = 0; i < positions.size(); i += 2) {
+		positions[i] += glm::vec3(5.f, 0.f, 0.f);
+		EXPECT_TRUE(tree.move_proxy(proxies[i], unit_box_at(positions[i])));
+	}
+	// A tiny move stays inside the margin
+	EXPECT_FALSE(tree.move_proxy(proxies[1], unit_box_at(positions[1] + glm::vec3(0.01f, 0.f, 0.f))));
+
+	for (size_t i = 0; i < positions.size(); i += 3) {
+		tree.destroy_proxy(proxies[i]);
+		proxies[i] = ENG::DynamicAabbTree::NULL_NODE;
+	}
+	ASSERT_TRUE(tree.validate());
+	EXPECT_LE(tree.height(), 24);
+
+	const auto queryBox = ENG::make_aabb(glm::vec3(-20.f), glm::vec3(20.f));
+	std::vector<uint32_t> expected;
+	for (uint32_t i = 0; i < positions.size(); ++i) {
+		if (proxies[i] != ENG::DynamicAabbTree::NULL_NODE && ENG::overlaps(tree.fat_aabb(proxies[i]), queryBox)) {
+			expected.push_back(i);
+		}
+	}
+	std::vector<uint32_t> found;
+	tree.query(queryBox, [&found](uint32_t id) { found.push_back(id); return true; });
+	EXPECT_EQ(sorted(found), expected);
+
+	const ENG::Sphere sphere{ glm::vec3(0.f), 15.f };
+	expected.clear();
+	for (uint32_t i = 0; i < positions.size(); ++i) {
+		if (proxies[i] != ENG::DynamicAabbTree::NULL_NODE && ENG::overlaps(tree.fat_aabb(proxies[i]), sphere)) {
+			expected.push_back(i);
+		}
+	}
+	found.clear();
+	tree.query(sphere, [&found](uint32_t id) { found.push_back(id); return true; });
+	EXPECT_EQ(sorted(found), expected);
+}
+
+TEST(DynamicAabbTree, FrustumAndRayQueries) {
+	ENG::DynamicAabbTree tree(0.f);
+	for (uint32_t i = 0; i < 10; ++i) {
+		tree.create_proxy(unit_box_at(glm::vec3(0.f, 0.f, -5.f * (i + 1))), i);
+	}
+	tree.create_proxy(unit_box_at(glm::vec3(0.f, 0.f, 5.f)), 100);  // behind the camera
+	tree.create_proxy(unit_box_at(glm::vec3(50.f, 0.f, -10.f)), 101);  // outside the side planes
+
+	const auto proj = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 30.f);
+	const auto view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	const auto frustum = ENG::frustum_from_matrix(proj * view);
+
+	std::vector<uint32_t> visible;
+	tree.query(frustum, [&visible](uint32_t id) { visible.push_back(id); return true; });
+	// Boxes at z = -5 .. -30 within the far plane at 30
+	EXPECT_EQ(sorted(visible), (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 5 }));
+
+	// Closest hit along -z: clip the ray at every hit, the last reported is the nearest
+	ENG::Ray ray{ glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), 1000.f };
+	uint32_t nearest = UINT32_MAX;
+	std::vector<uint32_t> reported;
+	tree.ray_cast(ray, [&](uint32_t id, const ENG::Ray& clipped) {
+		float t = 0.f;
+		reported.push_back(id);
+		if (!ENG::intersect_ray(clipped, unit_box_at(glm::vec3(0.f, 0.f, -5.f * (id + 1))), t)) return clipped.maxT;
+		nearest = id;
+		return t;
+	});
+	EXPECT_EQ(nearest, 0u);
+	// Nearest-first traversal with clipping never reaches the far boxes
+	EXPECT_LT(reported.size(), 4u);
+}
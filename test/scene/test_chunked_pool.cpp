@@ -0,0 +1,77 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/ChunkedPool.hpp"
+
+namespace {
+
+struct Item {
+	int value{ 0 };
+	std::string label;
+};
+
+using SmallPool = ENG::ChunkedPool<Item, 4, 16>;
+
+} // end namespace
+
+TEST(ChunkedPool, AddressesAreStableAcrossGrowth) {
+	SmallPool pool;
+	const auto first = pool.allocate();
+	auto* firstAddress = &pool[first];
+	firstAddress->value = 7;
+
+	for (int i = 0; i < 40; ++i) {
+		pool[pool.allocate()].value = i;
+	}
+
+	EXPECT_EQ(&pool[first], firstAddress);
+	EXPECT_EQ(pool[first].value, 7);
+	EXPECT_EQ(pool.size(), 41u);
+	EXPECT_EQ(pool.live_count(), 41u);
+}
+
+TEST(ChunkedPool, ReleasedSlotsAreReusedWithNewGeneration) {
+	SmallPool pool;
+	const auto a = pool.allocate();
+	const auto b = pool.allocate();
+	pool[b].label = "b";
+	const auto handle = pool.handle_of(b);
+	ASSERT_EQ(pool.get(handle), &pool[b]);
+
+	pool.release(b);
+	EXPECT_FALSE(pool.is_alive(b));
+	EXPECT_EQ(pool.get(handle), nullptr);
+	EXPECT_THROW(pool.at(b), std::out_of_range);
+
+	const auto reused = pool.allocate();
+	EXPECT_EQ(reused, b);
+	EXPECT_TRUE(pool[reused].label.empty());
+	EXPECT_FALSE(pool.is_valid(handle));
+	EXPECT_NE(pool.handle_of(reused), handle);
+	EXPECT_EQ(pool.size(), 2u);
+	EXPECT_TRUE(pool.is_alive(a));
+}
+
+TEST(ChunkedPool, IterationSkipsReleasedSlots) {
+	SmallPool pool;
+	for (int i = 0; i < 10; ++i) {
+		pool[pool.allocate()].value = i;
+	}
+	pool.release(0);
+	pool.release(5);
+	pool.release(9);
+
+	std::vector<int> seen;
+	for (const auto& item : pool) {
+		seen.push_back(item.value);
+	}
+	EXPECT_EQ(seen, (std::vector<int>{ 1, 2, 3, 4, 6, 7, 8 }));
+}
+
+TEST(ChunkedPool, ThrowsWhenFull) {
+	ENG::ChunkedPool<Item, 2, 2> pool;
+	for (int i = 0; i < 4; ++i) pool.allocate();
+	EXPECT_THROW(pool.allocate(), std::runtime_error);
+}
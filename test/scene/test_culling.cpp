@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "scene/Culling.hpp"
+#include "scene/Scene.hpp"
+
+namespace {
+
+// Inward planes of the box [-1, 1]^3
+ENG::Frustum unit_box_frustum()
+{
+	ENG::Frustum frustum;
+	frustum.planes[0] = { 1.f, 0.f, 0.f, 1.f };
+	frustum.planes[1] = { -1.f, 0.f, 0.f, 1.f };
+	frustum.planes[2] = { 0.f, 1.f, 0.f, 1.f };
+	frustum.planes[3] = { 0.f, -1.f, 0.f, 1.f };
+	frustum.planes[4] = { 0.f, 0.f, 1.f, 1.f };
+	frustum.planes[5] = { 0.f, 0.f, -1.f, 1.f };
+	return frustum;
+}
+
+ENG::AABB box_at(const glm::vec3& center, float halfSize)
+{
+	return ENG::make_aabb(center - glm::vec3(halfSize), center + glm::vec3(halfSize));
+}
+
+bool level_supported(ENG::SimdLevel level)
+{
+	return static_cast<int>(level) <= static_cast<int>(ENG::best_simd_level());
+}
+
+} // end namespace
+
+TEST(Culling, KeepsIntersectingAndUnboundedDropsOutsideAndHidden) {
+	ENG::CullingBounds bounds;
+	bounds.resize(5);
+	bounds.set(0, box_at({ 0.f, 0.f, 0.f }, 0.5f));   // inside
+	bounds.set(1, box_at({ 1.2f, 0.f, 0.f }, 0.5f));  // straddles the right plane
+	bounds.set(2, box_at({ 0.f, 0.f, -3.f }, 0.5f));  // outside
+	bounds.set_hidden(3);
+	// 4 was never set, so it stays unbounded
+
+	std::vector<uint32_t> visible;
+	const auto stats = ENG::cull_frustum(unit_box_frustum(), bounds, visible);
+
+	EXPECT_EQ(visible, (std::vector<uint32_t>{ 0, 1, 4 }));
+	EXPECT_EQ(stats.tested, 5u);
+	EXPECT_EQ(stats.visible, 3u);
+	EXPECT_EQ(stats.culled, 2u);
+}
+
+class CullFrustum : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(CullFrustum, MatchesClassify) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	// Odd count exercises the vector body and the scalar tail
+	std::mt19937 rng(99);
+	std::uniform_real_distribution<float> position(-3.f, 3.f);
+	std::uniform_real_distribution<float> size(0.01f, 1.f);
+	std::vector<ENG::AABB> boxes(1003);
+	ENG::CullingBounds bounds;
+	bounds.resize(boxes.size());
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		boxes[i] = box_at({ position(rng), position(rng), position(rng) }, size(rng));
+		bounds.set(i, boxes[i]);
+	}
+
+	const auto frustum = unit_box_frustum();
+	std::vector<uint32_t> expected;
+	for (uint32_t i = 0; i < boxes.size(); ++i) {
+		if (ENG::classify(frustum, boxes[i]) != ENG::Containment::Outside) expected.push_back(i);
+	}
+
+	std::vector<uint32_t> visible;
+	const auto stats = ENG::cull_frustum(frustum, bounds, visible, level);
+	EXPECT_EQ(visible, expected);
+	EXPECT_EQ(stats.visible + stats.culled, stats.tested);
+	EXPECT_GT(stats.culled, 0u);
+	EXPECT_GT(stats.visible, 0u);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, CullFrustum,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});
+
+namespace {
+
+// Root with a group of unit boxes spread along x below it, and one unit box beside the group
+struct GroupedScene {
+	ENG::SceneState sceneState;
+	ENG::Node* group{ nullptr };
+	ENG::Node* single{ nullptr };
+	std::vector<ENG::Node*> members;
+
+	explicit GroupedScene(size_t memberCount) {
+		auto& graph = sceneState.graph;
+		auto& root = graph.create_node();
+		graph.root = &root;
+		group = &graph.create_node();
+		single = &graph.create_node();
+		graph.add_child(root, *group);
+		graph.add_child(root, *single);
+		const auto range = graph.create_nodes(memberCount, group);
+		for (size_t i = 0; i < memberCount; ++i) {
+			auto& member = graph.nodes[range.id(i)];
+			member.translation = { 2.f * static_cast<float>(i), 0.f, 0.f };
+			members.push_back(&member);
+		}
+
+		sceneState.aabbs.resize(graph.nodes.size());
+		sceneState.aabbs[single->nodeId] = box_at(glm::vec3(0.f), 0.5f);
+		for (const auto* member : members) sceneState.aabbs[member->nodeId] = box_at(glm::vec3(0.f), 0.5f);
+		update();
+	}
+
+	uint32_t graph_root() const { return sceneState.graph.root->nodeId; }
+
+	void update() {
+		std::vector<ENG::MatrixRange> ranges;
+		sceneState.transforms.update(sceneState.graph, sceneState.modelMatrices, ranges);
+		ENG::update_world_bounds(sceneState, ranges);
+	}
+};
+
+} // end namespace
+
+TEST(SubtreeBounds, MergesDescendantsAndRefitsIncrementally) {
+	GroupedScene scene(4);
+	auto& sceneState = scene.sceneState;
+	const auto& subtrees = sceneState.subtreeBounds;
+
+	const auto groupBox = subtrees[scene.group->nodeId];
+	EXPECT_EQ(glm::vec3(groupBox.min), glm::vec3(-0.5f));
+	EXPECT_EQ(glm::vec3(groupBox.max), glm::vec3(6.5f, 0.5f, 0.5f));
+	EXPECT_EQ(glm::vec3(subtrees[scene.graph_root()].max), glm::vec3(6.5f, 0.5f, 0.5f));
+	EXPECT_EQ(glm::vec3(subtrees[scene.members[1]->nodeId].min), glm::vec3(1.5f, -0.5f, -0.5f));
+
+	// Moving the outermost member in shrinks the group and the root
+	scene.members[3]->translation = { 0.f, 3.f, 0.f };
+	sceneState.graph.mark_transform_dirty(*scene.members[3]);
+	scene.update();
+	EXPECT_EQ(glm::vec3(subtrees[scene.group->nodeId].max), glm::vec3(4.5f, 3.5f, 0.5f));
+	EXPECT_EQ(glm::vec3(subtrees[scene.graph_root()].max), glm::vec3(4.5f, 3.5f, 0.5f));
+
+	// Moving the group moves every member's box with it
+	scene.group->translation = { 0.f, 0.f, 10.f };
+	sceneState.graph.mark_transform_dirty(*scene.group);
+	scene.update();
+	EXPECT_EQ(glm::vec3(subtrees[scene.group->nodeId].min), glm::vec3(-0.5f, -0.5f, 9.5f));
+	EXPECT_EQ(glm::vec3(subtrees[scene.graph_root()].min), glm::vec3(-0.5f));
+
+	// Destroyed members no longer count
+	sceneState.graph.destroy_subtree(*scene.members[3]);
+	scene.update();
+	EXPECT_EQ(glm::vec3(subtrees[scene.group->nodeId].max), glm::vec3(4.5f, 0.5f, 10.5f));
+}
+
+TEST(CullHierarchy, RejectsSubtreesWithOneTest) {
+	GroupedScene scene(640);
+	auto& sceneState = scene.sceneState;
+	// Camera at the single box looking down -z, the group is moved behind it
+	scene.group->translation = { 0.f, 0.f, 20.f };
+	sceneState.graph.mark_transform_dirty(*scene.group);
+	scene.update();
+	const auto viewProjection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f)
+		* glm::lookAt(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+	const auto frustum = ENG::frustum_from_matrix(viewProjection);
+
+	std::vector<uint32_t> visible;
+	const auto stats = ENG::cull_hierarchy(frustum, sceneState.transforms.preorder(), sceneState.subtreeBounds,
+		sceneState.cullingBounds, visible);
+	EXPECT_EQ(visible, (std::vector<uint32_t>{ scene.graph_root(), scene.single->nodeId }));
+	// Root subtree and root, the group's subtree, the single box
+	EXPECT_EQ(stats.tested, 4u);
+	EXPECT_EQ(stats.culled, 641u);
+	EXPECT_EQ(stats.visible, 2u);
+
+	// Testing every box finds the same nodes, apart from the group itself, which has no
+	// bounds of its own and is only dropped along with its subtree
+	std::vector<uint32_t> flat;
+	ENG::cull_frustum(frustum, sceneState.cullingBounds, flat);
+	std::erase(flat, scene.group->nodeId);
+	EXPECT_EQ(flat, visible);
+}
+
+TEST(CullHierarchy, KeepsSubtreesInsideWithoutTesting) {
+	GroupedScene scene(8);
+	auto& sceneState = scene.sceneState;
+	const auto viewProjection = glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f)
+		* glm::lookAt(glm::vec3(7.f, 0.f, 30.f), glm::vec3(7.f, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+	const auto frustum = ENG::frustum_from_matrix(viewProjection);
+
+	std::vector<uint32_t> visible;
+	const auto stats = ENG::cull_hierarchy(frustum, sceneState.transforms.preorder(), sceneState.subtreeBounds,
+		sceneState.cullingBounds, visible);
+	EXPECT_EQ(stats.tested, 1u);
+	EXPECT_EQ(stats.visible, 11u);
+	EXPECT_EQ(visible.size(), 11u);
+	EXPECT_EQ(std::vector<uint32_t>(sceneState.transforms.preorder().all().begin(), sceneState.transforms.preorder().all().end()), visible);
+
+	// Partially visible subtrees are descended into and keep the flat result
+	const auto closeUp = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f)
+		* glm::lookAt(glm::vec3(0.f, 0.f, 3.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+	ENG::cull_hierarchy(ENG::frustum_from_matrix(closeUp), sceneState.transforms.preorder(), sceneState.subtreeBounds,
+		sceneState.cullingBounds, visible);
+	std::vector<uint32_t> flat;
+	ENG::cull_frustum(ENG::frustum_from_matrix(closeUp), sceneState.cullingBounds, flat);
+	std::sort(visible.begin(), visible.end());
+	EXPECT_EQ(flat, visible);
+	EXPECT_LT(visible.size(), 11u);
+}
+
+TEST(CullHierarchy, MatchesFlatCullForPartlyVisibleGroups) {
+	GroupedScene scene(100);
+	auto& sceneState = scene.sceneState;
+	const auto& order = sceneState.transforms.preorder();
+	std::vector<uint32_t> visible;
+	std::vector<uint32_t> flat;
+
+	// Cameras along the group see none, part or all of it
+	for (const float x : { -50.f, 10.f, 60.f, 99.f, 300.f }) {
+		const auto viewProjection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f)
+			* glm::lookAt(glm::vec3(x, 0.f, 10.f), glm::vec3(x, 0.f, 0.f), glm::vec3(0.f, 1.f, 0.f));
+		const auto frustum = ENG::frustum_from_matrix(viewProjection);
+		const auto stats = ENG::cull_hierarchy(frustum, order, sceneState.subtreeBounds, sceneState.cullingBounds, visible);
+		EXPECT_EQ(stats.visible, visible.size()) << "camera at " << x;
+
+		// Same bounded nodes as testing every box, in preorder. Unbounded ones depend on
+		// whether their subtree was rejected.
+		std::vector<uint32_t> expected;
+		std::vector<uint32_t> bounded;
+		ENG::cull_frustum(frustum, sceneState.cullingBounds, flat);
+		for (const auto nodeId : order.all()) {
+			if (sceneState.cullingBounds.bounded(nodeId) && std::binary_search(flat.begin(), flat.end(), nodeId)) expected.push_back(nodeId);
+		}
+		for (const auto nodeId : visible) {
+			if (sceneState.cullingBounds.bounded(nodeId)) bounded.push_back(nodeId);
+		}
+		EXPECT_EQ(bounded, expected) << "camera at " << x;
+		EXPECT_TRUE(std::is_sorted(visible.begin(), visible.end(), [&](uint32_t a, uint32_t b) {
+			return order.slot_of(a) < order.slot_of(b);
+		})) << "camera at " << x;
+	}
+}
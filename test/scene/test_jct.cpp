@@ -0,0 +1,158 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/JCT.hpp"
+#include "scene/TriangleBvh.hpp"
+
+namespace {
+
+bool level_supported(ENG::SimdLevel level)
+{
+	return static_cast<int>(level) <= static_cast<int>(ENG::best_simd_level());
+}
+
+const glm::vec3 DOWN{ 0.f, 0.f, -1.f };
+
+// Concave U in the z = 0 plane, counter-clockwise from +z, with its notch over x in (1, 2), y > 1
+const std::vector<glm::vec3> U_SHAPE{ { 0.f, 0.f, 0.f }, { 3.f, 0.f, 0.f }, { 3.f, 3.f, 0.f }, { 2.f, 3.f, 0.f },
+	{ 2.f, 1.f, 0.f }, { 1.f, 1.f, 0.f }, { 1.f, 3.f, 0.f }, { 0.f, 3.f, 0.f } };
+
+// Small pentagons and hexagons tangent to the unit sphere, as on a Goldberg polyhedron
+void goldberg_like_faces(size_t count, std::vector<uint32_t>& offsets, std::vector<glm::vec3>& vertices)
+{
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	offsets = { 0 };
+	vertices.clear();
+	for (size_t face = 0; face < count; ++face) {
+		const auto normal = glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+		const auto tangent = glm::normalize(glm::cross(normal, std::fabs(normal.x) < 0.9f ? glm::vec3(1.f, 0.f, 0.f) : glm::vec3(0.f, 1.f, 0.f)));
+		const auto bitangent = glm::cross(normal, tangent);
+		const int corners = face % 2 == 0 ? 6 : 5;
+		for (int k = 0; k < corners; ++k) {
+			const float angle = 6.2831853f * k / corners;
+			vertices.push_back(normal + 0.2f * (std::cos(angle) * tangent + std::sin(angle) * bitangent));
+		}
+		offsets.push_back(static_cast<uint32_t>(vertices.size()));
+	}
+}
+
+} // end namespace
+
+TEST(JCT, ConvexPolygonFrontFaceOnly) {
+	const std::vector<glm::vec3> square{ { -1.f, -1.f, 0.f }, { 1.f, -1.f, 0.f }, { 1.f, 1.f, 0.f }, { -1.f, 1.f, 0.f } };
+	float distance = 0.f;
+	EXPECT_TRUE(ray_polygon_intersection({ 0.5f, 0.25f, 4.f }, DOWN, square, distance));
+	EXPECT_NEAR(distance, 4.f, 1e-6f);
+	EXPECT_FALSE(ray_polygon_intersection({ 1.5f, 0.f, 4.f }, DOWN, square));
+	// From behind, and pointing away
+	EXPECT_FALSE(ray_polygon_intersection({ 0.f, 0.f, -4.f }, -DOWN, square));
+	EXPECT_FALSE(ray_polygon_intersection({ 0.f, 0.f, 4.f }, -DOWN, square));
+
+	// An explicitly closed strip is the same polygon
+	auto closed = square;
+	closed.push_back(square.front());
+	EXPECT_TRUE(ray_polygon_intersection({ 0.5f, 0.25f, 4.f }, DOWN, closed));
+	EXPECT_FALSE(ray_polygon_intersection({ 1.5f, 0.f, 4.f }, DOWN, closed));
+}
+
+TEST(JCT, ConcavePolygon) {
+	EXPECT_TRUE(ray_polygon_intersection({ 0.5f, 2.5f, 1.f }, DOWN, U_SHAPE));
+	EXPECT_TRUE(ray_polygon_intersection({ 2.5f, 2.5f, 1.f }, DOWN, U_SHAPE));
+	EXPECT_TRUE(ray_polygon_intersection({ 1.5f, 0.5f, 1.f }, DOWN, U_SHAPE));
+	EXPECT_FALSE(ray_polygon_intersection({ 1.5f, 2.f, 1.f }, DOWN, U_SHAPE));  // in the notch
+	// Level with the notch's inner vertices, where the crossing line passes through them
+	EXPECT_TRUE(ray_polygon_intersection({ 0.5f, 1.f, 1.f }, DOWN, U_SHAPE));
+
+	// Starting at the reflex vertex must not flip the normal
+	std::vector<glm::vec3> rotated(U_SHAPE.begin() + 4, U_SHAPE.end());
+	rotated.insert(rotated.end(), U_SHAPE.begin(), U_SHAPE.begin() + 4);
+	EXPECT_TRUE(ray_polygon_intersection({ 0.5f, 2.5f, 1.f }, DOWN, rotated));
+	EXPECT_FALSE(ray_polygon_intersection({ 1.5f, 2.f, 1.f }, DOWN, rotated));
+}
+
+TEST(JCT, RayLineIntersection) {
+	const glm::vec3 a{ 0.f, -1.f, 0.f }, b{ 0.f, 1.f, 0.f };
+	const auto hit = ray_line_intersection({ -2.f, 0.5f, 0.f }, { 1.f, 0.f, 0.f }, a, b);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_NEAR(hit->y, 0.5f, 1e-6f);
+	EXPECT_NEAR(hit->x, 0.f, 1e-6f);
+	EXPECT_FALSE(ray_line_intersection({ 2.f, 0.5f, 0.f }, { 1.f, 0.f, 0.f }, a, b).has_value());  // behind
+	EXPECT_FALSE(ray_line_intersection({ -2.f, 1.5f, 0.f }, { 1.f, 0.f, 0.f }, a, b).has_value());  // past the end
+	EXPECT_FALSE(ray_line_intersection({ -2.f, 0.f, 0.f }, { 0.f, 1.f, 0.f }, a, b).has_value());  // parallel
+	EXPECT_FALSE(ray_line_intersection({ -2.f, 0.f, 1.f }, { 1.f, 0.f, 0.f }, a, b).has_value());  // skew
+}
+
+TEST(PolygonBatch, RejectsBadPolygons) {
+	const std::vector<glm::vec3> vertices(8, glm::vec3(0.f));
+	const std::vector<uint32_t> tooFew{ 0, 2 };
+	const std::vector<uint32_t> tooMany{ 0, 7 };
+	EXPECT_THROW(PolygonBatch(tooFew, vertices), std::runtime_error);
+	EXPECT_THROW(PolygonBatch(tooMany, vertices), std::runtime_error);
+}
+
+class PolygonBatchLevels : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(PolygonBatchLevels, MatchesTriangleFans) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	// Odd count leaves a partly filled block
+	std::vector<uint32_t> offsets;
+	std::vector<glm::vec3> vertices;
+	goldberg_like_faces(301, offsets, vertices);
+	const PolygonBatch batch(offsets, vertices);
+	ASSERT_EQ(batch.size(), 301u);
+
+	// Reference: every face as a triangle fan, two-sided like the batch
+	std::vector<uint32_t> fan;
+	std::vector<uint32_t> fanFace;
+	for (uint32_t face = 0; face + 1 < offsets.size(); ++face) {
+		for (auto k = offsets[face] + 1; k + 1 < offsets[face + 1]; ++k) {
+			fan.insert(fan.end(), { offsets[face], k, k + 1 });
+			fanFace.push_back(face);
+		}
+	}
+	const ENG::TriangleBvh triangles(&vertices[0].x, vertices.size(), sizeof(glm::vec3), fan);
+
+	std::mt19937 rng(8);
+	std::uniform_real_distribution<float> unit(-1.f, 1.f);
+	int hits = 0;
+	for (int r = 0; r < 500; ++r) {
+		const glm::vec3 origin = 3.f * glm::normalize(glm::vec3(unit(rng), unit(rng), unit(rng)));
+		const auto direction = glm::normalize(-origin + 0.4f * glm::vec3(unit(rng), unit(rng), unit(rng)));
+
+		ENG::Ray ray;
+		ray.origin = origin;
+		ray.direction = direction;
+		ray.maxT = 10.f;
+		ENG::TriangleHit expected;
+		const bool found = triangles.intersect(ray, expected);
+
+		const auto hit = batch.intersect(origin, direction, 10.f, level);
+		ASSERT_EQ(hit.has_value(), found) << "ray " << r;
+		if (!found) continue;
+		++hits;
+		EXPECT_EQ(hit->polygon, fanFace[expected.triangleId]) << "ray " << r;
+		EXPECT_NEAR(hit->distance, expected.t, 1e-4f) << "ray " << r;
+	}
+	EXPECT_GT(hits, 0);
+
+	// Clipped by maxT
+	EXPECT_FALSE(batch.intersect({ 0.f, 0.f, 3.f }, DOWN, 0.5f, level).has_value());
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, PolygonBatchLevels,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});
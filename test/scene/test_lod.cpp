@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/Scene.hpp"
+
+namespace {
+
+// Levels for 50% and 20% of the viewport height, and a coarsest one below that
+ENG::LodGroup three_levels()
+{
+	ENG::LodGroup lod;
+	lod.add_level(12, 0.f);
+	lod.add_level(10, 0.5f);
+	lod.add_level(11, 0.2f);
+	return lod;
+}
+
+} // end namespace
+
+TEST(Lod, LevelsAreOrderedFinestFirst) {
+	const auto lod = three_levels();
+	ASSERT_EQ(lod.levels().size(), 3u);
+	EXPECT_EQ(lod.levels()[0].drawDataIdx, 10u);
+	EXPECT_EQ(lod.levels()[1].drawDataIdx, 11u);
+	EXPECT_EQ(lod.levels()[2].drawDataIdx, 12u);
+	EXPECT_EQ(lod.current(), 0u);
+}
+
+TEST(Lod, SelectionHasHysteresis) {
+	auto lod = three_levels();
+	const ENG::LodSettings settings{ 0.1f, 0.01f };
+
+	EXPECT_EQ(lod.select(1.f, settings), 0u);
+	EXPECT_EQ(lod.select(0.46f, settings), 0u);   // inside the band below 0.5
+	EXPECT_EQ(lod.select(0.44f, settings), 1u);
+	EXPECT_EQ(lod.select(0.52f, settings), 1u);   // inside the band above 0.5
+	EXPECT_EQ(lod.select(0.56f, settings), 0u);
+
+	// Large jumps cross several levels at once
+	EXPECT_EQ(lod.select(0.05f, settings), 2u);
+	EXPECT_EQ(lod.select(0.8f, settings), 0u);
+
+	// Contribution cutoff, with the same band
+	EXPECT_EQ(lod.select(0.0095f, settings), 2u);
+	EXPECT_EQ(lod.select(0.0085f, settings), ENG::LOD_CULLED);
+	EXPECT_EQ(lod.select(0.0105f, settings), ENG::LOD_CULLED);
+	EXPECT_EQ(lod.select(0.012f, settings), 2u);
+	EXPECT_EQ(lod.current(), 2u);
+
+	EXPECT_EQ(ENG::LodGroup{}.select(1.f, settings), ENG::LOD_CULLED);
+}
+
+TEST(Lod, ProjectedScreenSize) {
+	// 90 degree field of view: a sphere whose tangent cone has a 45 degree half angle fills the view
+	glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f);
+	const ENG::Sphere sphere{ { 0.f, 0.f, -std::sqrt(2.f) }, 1.f };
+	EXPECT_NEAR(ENG::projected_screen_size(sphere, glm::vec3(0.f), proj), 1.f, 1e-5f);
+	const ENG::Sphere far{ { 0.f, 0.f, -100.f }, 1.f };
+	EXPECT_NEAR(ENG::projected_screen_size(far, glm::vec3(0.f), proj), 0.01f, 1e-5f);
+
+	// Vulkan's flipped y does not change the size
+	proj[1][1] *= -1.f;
+	EXPECT_NEAR(ENG::projected_screen_size(sphere, glm::vec3(0.f), proj), 1.f, 1e-5f);
+	EXPECT_EQ(ENG::projected_screen_size(sphere, sphere.center, proj), std::numeric_limits<float>::max());
+
+	// Orthographic, 20 units tall: independent of distance
+	glm::mat4 ortho(1.f);
+	ortho[1][1] = 0.1f;
+	EXPECT_NEAR(ENG::projected_screen_size(far, glm::vec3(0.f), ortho), 0.1f, 1e-6f);
+}
+
+TEST(Lod, TransformSphereUsesLargestScale) {
+	glm::mat4 model = glm::translate(glm::mat4(1.f), glm::vec3(1.f, 2.f, 3.f));
+	model = glm::scale(model, glm::vec3(1.f, 3.f, 2.f));
+	const auto sphere = ENG::transform_sphere(model, { { 1.f, 0.f, 0.f }, 0.5f });
+	EXPECT_NEAR(sphere.radius, 1.5f, 1e-6f);
+	EXPECT_NEAR(sphere.center.x, 2.f, 1e-6f);
+	EXPECT_NEAR(sphere.center.y, 2.f, 1e-6f);
+	EXPECT_NEAR(sphere.center.z, 3.f, 1e-6f);
+}
+
+TEST(SelectLods, SwitchesDrawDataAndCullsTinyNodes) {
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& detailed = graph.create_node();
+	auto& speck = graph.create_node();
+	graph.add_child(root, detailed);
+	graph.add_child(root, speck);
+	detailed.translation = { 0.f, 0.f, -2.f };
+	detailed.draw_data_idx = 10;
+	speck.translation = { 0.f, 0.f, -50.f };
+
+	sceneState.boundingSpheres.resize(graph.nodes.size());
+	sceneState.boundingSpheres[detailed.nodeId] = { glm::vec3(0.f), 1.f };
+	sceneState.boundingSpheres[speck.nodeId] = { glm::vec3(0.f), 0.01f };
+	sceneState.lods.resize(graph.nodes.size());
+	sceneState.lods[detailed.nodeId] = three_levels();
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	sceneState.visibleNodeIds = { root.nodeId, detailed.nodeId, speck.nodeId };
+	sceneState.cullStats.visible = 3;
+
+	const glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f);
+	ENG::select_lods(sceneState, glm::mat4(1.f), proj);
+	EXPECT_EQ(detailed.draw_data_idx, 10u);
+	EXPECT_EQ(sceneState.visibleNodeIds, (std::vector<uint32_t>{ root.nodeId, detailed.nodeId }));
+	EXPECT_EQ(sceneState.lodStats.culled, 1u);
+	EXPECT_EQ(sceneState.lodStats.selected, 1u);
+	EXPECT_EQ(sceneState.cullStats.visible, 2u);
+
+	// Moving the camera back 18 units leaves the detailed node at about 5% of the view
+	const glm::mat4 view = glm::translate(glm::mat4(1.f), glm::vec3(0.f, 0.f, -18.f));
+	sceneState.visibleNodeIds = { root.nodeId, detailed.nodeId };
+	ENG::select_lods(sceneState, view, proj);
+	EXPECT_EQ(detailed.draw_data_idx, 12u);
+	EXPECT_EQ(sceneState.lodStats.switched, 1u);
+}
+
+TEST(SelectLods, CutoffHasHysteresisForNodesWithoutLods) {
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& node = graph.create_node();
+	graph.add_child(root, node);
+	node.translation = { 0.f, 0.f, -1.f };
+	node.draw_data_idx = 3;
+	sceneState.lodSettings.minScreenSize = 0.01f;
+	sceneState.lodSettings.hysteresis = 0.1f;
+	sceneState.boundingSpheres.resize(graph.nodes.size());
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+
+	// With a 90 degree field of view the projected size is about radius / distance
+	const glm::mat4 proj = glm::perspective(glm::radians(90.f), 1.f, 0.1f, 100.f);
+	const auto drawn_at_radius = [&](float radius) {
+		sceneState.boundingSpheres[node.nodeId] = { glm::vec3(0.f), radius };
+		sceneState.visibleNodeIds = { node.nodeId };
+		sceneState.cullStats.visible = 1;
+		ENG::select_lods(sceneState, glm::mat4(1.f), proj);
+		return sceneState.visibleNodeIds.size() == 1;
+	};
+
+	EXPECT_TRUE(drawn_at_radius(0.02f));
+	EXPECT_TRUE(drawn_at_radius(0.0095f));   // below the cutoff, inside the band
+	EXPECT_FALSE(drawn_at_radius(0.0085f));  // below the band
+	EXPECT_FALSE(drawn_at_radius(0.0105f));  // above the cutoff, inside the band
+	EXPECT_TRUE(drawn_at_radius(0.0115f));   // above the band
+}
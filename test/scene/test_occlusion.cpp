@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/Occlusion.hpp"
+#include "scene/Scene.hpp"
+
+namespace {
+
+bool level_supported(ENG::SimdLevel level)
+{
+	return static_cast<int>(level) <= static_cast<int>(ENG::best_simd_level());
+}
+
+// Square [-h, h]^2 at height z, as two triangles
+ENG::TriangleBvh square_mesh(float h, float z)
+{
+	const std::vector<glm::vec3> positions{ { -h, -h, z }, { h, -h, z }, { h, h, z }, { -h, h, z } };
+	const std::vector<uint32_t> indices{ 0, 1, 2, 0, 2, 3 };
+	return ENG::TriangleBvh(&positions[0].x, positions.size(), sizeof(glm::vec3), indices);
+}
+
+glm::mat4 camera_view_projection()
+{
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f), glm::vec3(0.f, 0.f, -1.f), glm::vec3(0.f, 1.f, 0.f));
+	const glm::mat4 proj = glm::perspective(glm::radians(60.f), 2.f, 0.1f, 100.f);
+	return proj * view;
+}
+
+ENG::AABB box_at(const glm::vec3& center, float halfSize)
+{
+	return ENG::make_aabb(center - glm::vec3(halfSize), center + glm::vec3(halfSize));
+}
+
+} // end namespace
+
+TEST(OcclusionBuffer, RasterizesAtPixelCenters) {
+	// Identity clip space: the square covers the middle half of the NDC square
+	ENG::OcclusionBuffer buffer(64, 32);
+	buffer.rasterize(glm::mat4(1.f), square_mesh(0.5f, 0.25f));
+
+	size_t covered = 0;
+	for (uint32_t y = 0; y < buffer.height(); ++y) {
+		for (uint32_t x = 0; x < buffer.width(); ++x) {
+			const bool inside = x >= 16 && x < 48 && y >= 8 && y < 24;
+			EXPECT_EQ(buffer.depth(x, y), inside ? 0.25f : 1.f) << x << ", " << y;
+			covered += inside ? 1 : 0;
+		}
+	}
+	EXPECT_EQ(covered, 32u * 16u);
+
+	// Clearing resets to the far plane
+	buffer.clear();
+	EXPECT_TRUE(std::all_of(buffer.depth_image().begin(), buffer.depth_image().end(), [](float d) { return d == 1.f; }));
+}
+
+TEST(OcclusionBuffer, InterpolatesDepthAndKeepsNearest) {
+	ENG::OcclusionBuffer buffer(16, 16);
+	// Depth rises with x from 0 at the left edge to 0.5 at the right
+	const std::vector<glm::vec3> ramp{ { -1.f, -1.f, 0.f }, { 1.f, -1.f, 0.5f }, { 1.f, 1.f, 0.5f }, { -1.f, 1.f, 0.f } };
+	const std::vector<uint32_t> indices{ 0, 1, 2, 0, 2, 3 };
+	buffer.rasterize(glm::mat4(1.f), ENG::TriangleBvh(&ramp[0].x, ramp.size(), sizeof(glm::vec3), indices));
+	for (uint32_t x = 0; x < 16; ++x) {
+		EXPECT_NEAR(buffer.depth(x, 5), 0.25f * (x + 0.5f) / 8.f, 1e-6f);
+	}
+
+	// A flat square at 0.2 only wins where it is nearer
+	buffer.rasterize(glm::mat4(1.f), square_mesh(1.f, 0.2f));
+	EXPECT_NEAR(buffer.depth(1, 5), 0.25f * 1.5f / 8.f, 1e-6f);
+	EXPECT_EQ(buffer.depth(14, 5), 0.2f);
+}
+
+TEST(OcclusionBuffer, PyramidHoldsMinAndMax) {
+	ENG::OcclusionBuffer buffer(40, 24);
+	buffer.rasterize(glm::mat4(1.f), square_mesh(0.5f, 0.25f));
+	buffer.build_pyramid();
+
+	const auto top = buffer.level_count() - 1;
+	EXPECT_EQ(buffer.min_depth(top, 0, 0), 0.25f);
+	EXPECT_EQ(buffer.max_depth(top, 0, 0), 1.f);
+	// Every texel of level 1 bounds its 2 x 2 block of the image
+	for (uint32_t y = 0; y < 12; ++y) {
+		for (uint32_t x = 0; x < 20; ++x) {
+			const float a = buffer.depth(2 * x, 2 * y), b = buffer.depth(2 * x + 1, 2 * y);
+			const float c = buffer.depth(2 * x, 2 * y + 1), d = buffer.depth(2 * x + 1, 2 * y + 1);
+			EXPECT_EQ(buffer.min_depth(1, x, y), std::min({ a, b, c, d }));
+			EXPECT_EQ(buffer.max_depth(1, x, y), std::max({ a, b, c, d }));
+		}
+	}
+}
+
+TEST(OcclusionBuffer, BoxesBehindAWall) {
+	const auto viewProjection = camera_view_projection();
+	ENG::OcclusionBuffer buffer(128, 64);
+	buffer.rasterize(viewProjection, square_mesh(2.f, -5.f));
+	buffer.build_pyramid();
+
+	EXPECT_TRUE(buffer.occluded(viewProjection, box_at({ 0.f, 0.f, -10.f }, 1.f)));
+	EXPECT_TRUE(buffer.occluded(viewProjection, box_at({ 0.5f, -0.5f, -6.f }, 0.3f)));
+	EXPECT_FALSE(buffer.occluded(viewProjection, box_at({ 0.f, 0.f, -3.f }, 0.5f)));   // in front
+	EXPECT_FALSE(buffer.occluded(viewProjection, box_at({ 5.f, 0.f, -10.f }, 1.f)));   // beside, partly
+	EXPECT_FALSE(buffer.occluded(viewProjection, box_at({ 0.f, 0.f, -10.f }, 6.f)));   // larger than the wall
+	EXPECT_FALSE(buffer.occluded(viewProjection, box_at({ 0.f, 0.f, 0.f }, 1.f)));     // around the camera
+	EXPECT_FALSE(buffer.occluded(viewProjection, box_at({ 0.f, 0.f, 10.f }, 1.f)));    // behind the camera
+}
+
+class OcclusionRasterize : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(OcclusionRasterize, MatchesScalarExactly) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	std::mt19937 rng(17);
+	std::uniform_real_distribution<float> position(-6.f, 6.f);
+	std::uniform_real_distribution<float> depth(-30.f, -2.f);
+	std::uniform_real_distribution<float> offset(-2.f, 2.f);
+	std::vector<glm::vec3> positions;
+	for (int i = 0; i < 200; ++i) {
+		const glm::vec3 c{ position(rng), position(rng), depth(rng) };
+		for (int corner = 0; corner < 3; ++corner) {
+			positions.push_back(c + glm::vec3(offset(rng), offset(rng), offset(rng)));
+		}
+	}
+	const ENG::TriangleBvh mesh(&positions[0].x, positions.size(), sizeof(glm::vec3), {});
+
+	// Odd height and a width rounded up to 8
+	ENG::OcclusionBuffer scalar(101, 57);
+	ENG::OcclusionBuffer simd(101, 57);
+	ASSERT_EQ(scalar.width(), 104u);
+	scalar.rasterize(camera_view_projection(), mesh, ENG::SimdLevel::Scalar);
+	simd.rasterize(camera_view_projection(), mesh, level);
+	EXPECT_EQ(scalar.depth_image(), simd.depth_image());
+	EXPECT_GT(std::count_if(scalar.depth_image().begin(), scalar.depth_image().end(), [](float d) { return d < 1.f; }), 1000);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, OcclusionRasterize,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});
+
+TEST(CullScene, DropsNodesHiddenBehindOccluders) {
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& wall = graph.create_node();
+	auto& hidden = graph.create_node();
+	auto& beside = graph.create_node();
+	graph.add_child(root, wall);
+	graph.add_child(root, hidden);
+	graph.add_child(root, beside);
+	wall.translation = { 0.f, 0.f, -5.f };
+	wall.occluder = true;
+	hidden.translation = { 0.f, 0.f, -10.f };
+	beside.translation = { 6.f, 0.f, -10.f };
+
+	const auto wallMesh = std::make_shared<const ENG::TriangleBvh>(square_mesh(2.f, 0.f));
+	sceneState.aabbs.resize(graph.nodes.size());
+	sceneState.pickMeshes.resize(graph.nodes.size());
+	sceneState.aabbs[wall.nodeId] = wallMesh->bounds();
+	sceneState.pickMeshes[wall.nodeId] = wallMesh;
+	sceneState.aabbs[hidden.nodeId] = box_at(glm::vec3(0.f), 1.f);
+	sceneState.aabbs[beside.nodeId] = box_at(glm::vec3(0.f), 1.f);
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+	ENG::cull_scene(sceneState, camera_view_projection());
+
+	const auto& visible = sceneState.visibleNodeIds;
+	EXPECT_NE(std::find(visible.begin(), visible.end(), root.nodeId), visible.end());  // unbounded
+	EXPECT_NE(std::find(visible.begin(), visible.end(), wall.nodeId), visible.end());
+	EXPECT_NE(std::find(visible.begin(), visible.end(), beside.nodeId), visible.end());
+	EXPECT_EQ(std::find(visible.begin(), visible.end(), hidden.nodeId), visible.end());
+	EXPECT_EQ(sceneState.cullStats.occluded, 1u);
+	EXPECT_EQ(sceneState.cullStats.visible, 3u);
+
+	// Without occluders the stage is skipped
+	wall.occluder = false;
+	ENG::cull_scene(sceneState, camera_view_projection());
+	EXPECT_EQ(sceneState.cullStats.occluded, 0u);
+	EXPECT_EQ(sceneState.cullStats.visible, 4u);
+}
+
+TEST(CullScene, NonIndexedOccluderHidesNodes) {
+	// Wall built like the planet tiles: PosNorCol vertex triples without indices
+	constexpr float h = 2.f;
+	const std::vector<glm::vec3> corners{ { -h, -h, 0.f }, { h, -h, 0.f }, { h, h, 0.f }, { -h, -h, 0.f }, { h, h, 0.f }, { -h, h, 0.f } };
+	std::vector<ENG::VertexPosNorCol> vertices;
+	for (const auto& corner : corners) {
+		vertices.push_back({ corner, { 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 1.f } });
+	}
+	const auto wallData = ENG::prepare_host_mesh_data(ENG::HostMeshData{ std::move(vertices), {}, "PosNorCol" });
+
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& wall = graph.create_node();
+	auto& hidden = graph.create_node();
+	graph.add_child(root, wall);
+	graph.add_child(root, hidden);
+	wall.translation = { 0.f, 0.f, -5.f };
+	wall.occluder = true;
+	hidden.translation = { 0.f, 0.f, -10.f };
+
+	sceneState.aabbs.resize(graph.nodes.size());
+	sceneState.pickMeshes.resize(graph.nodes.size());
+	sceneState.aabbs[wall.nodeId] = wallData.localBounds.box;
+	sceneState.pickMeshes[wall.nodeId] = wallData.pickMesh;
+	sceneState.aabbs[hidden.nodeId] = box_at(glm::vec3(0.f), 1.f);
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+	ENG::cull_scene(sceneState, camera_view_projection());
+
+	const auto& visible = sceneState.visibleNodeIds;
+	EXPECT_NE(std::find(visible.begin(), visible.end(), wall.nodeId), visible.end());
+	EXPECT_EQ(std::find(visible.begin(), visible.end(), hidden.nodeId), visible.end());
+	EXPECT_EQ(sceneState.cullStats.occluded, 1u);
+}
@@ -0,0 +1,177 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/Picking.hpp"
+
+namespace {
+
+// Two-sided unit quad in the z = 0 plane, as two triangles
+const std::vector<glm::vec3> QUAD_POSITIONS{ { -1.f, -1.f, 0.f }, { 1.f, -1.f, 0.f }, { 1.f, 1.f, 0.f }, { -1.f, 1.f, 0.f } };
+const std::vector<uint32_t> QUAD_INDICES{ 0, 1, 2, 0, 2, 3 };
+
+} // end namespace
+
+TEST(TriangleBvh, MatchesBruteForceOnTriangleSoup) {
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> position(-10.f, 10.f);
+	std::uniform_real_distribution<float> offset(-0.5f, 0.5f);
+	std::vector<glm::vec3> positions;
+	for (int i = 0; i < 500; ++i) {
+		const glm::vec3 c{ position(rng), position(rng), position(rng) };
+		for (int corner = 0; corner < 3; ++corner) {
+			positions.push_back(c + glm::vec3(offset(rng), offset(rng), offset(rng)));
+		}
+	}
+
+	// No index buffer: consecutive vertices form triangles
+	const ENG::TriangleBvh bvh(&positions[0].x, positions.size(), sizeof(glm::vec3), {});
+	ASSERT_EQ(bvh.triangle_count(), 500u);
+	EXPECT_LT(bvh.node_count(), 2u * 500u);
+
+	int hits = 0;
+	for (int r = 0; r < 200; ++r) {
+		ENG::Ray ray;
+		ray.origin = { position(rng), position(rng), -20.f };
+		ray.direction = glm::normalize(glm::vec3(offset(rng), offset(rng), 1.f));
+
+		// Brute force over every triangle, one triangle BVH each
+		float bestT = std::numeric_limits<float>::max();
+		uint32_t bestId = UINT32_MAX;
+		for (uint32_t t = 0; t < 500; ++t) {
+			const ENG::TriangleBvh one(&positions[3 * t].x, 3, sizeof(glm::vec3), {});
+			ENG::TriangleHit hit;
+			if (one.intersect(ray, hit) && hit.t < bestT) {
+				bestT = hit.t;
+				bestId = t;
+			}
+		}
+
+		ENG::TriangleHit hit;
+		const bool found = bvh.intersect(ray, hit);
+		ASSERT_EQ(found, bestId != UINT32_MAX) << "ray " << r;
+		if (found) {
+			++hits;
+			EXPECT_EQ(hit.triangleId, bestId) << "ray " << r;
+			EXPECT_NEAR(hit.t, bestT, 1e-4f) << "ray " << r;
+		}
+	}
+	EXPECT_GT(hits, 0);
+}
+
+TEST(TriangleBvh, RejectsOutOfRangeIndices) {
+	const std::vector<uint32_t> bad{ 0, 1, 7 };
+	EXPECT_THROW(ENG::TriangleBvh(&QUAD_POSITIONS[0].x, QUAD_POSITIONS.size(), sizeof(glm::vec3), bad), std::runtime_error);
+}
+
+TEST(Picking, ClosestSelectableTriangleThroughSceneBvh) {
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& nearQuad = graph.create_node();
+	auto& farQuad = graph.create_node();
+	auto& hiddenQuad = graph.create_node();
+	graph.add_child(root, nearQuad);
+	graph.add_child(root, farQuad);
+	graph.add_child(root, hiddenQuad);
+	nearQuad.translation = { 0.f, 0.f, -5.f };
+	nearQuad.scale = { 2.f, 2.f, 2.f };
+	farQuad.translation = { 0.f, 0.f, -10.f };
+	hiddenQuad.translation = { 0.f, 0.f, -2.f };  // in front of both, but not selectable
+	nearQuad.selectable = true;
+	farQuad.selectable = true;
+
+	const auto quad = std::make_shared<const ENG::TriangleBvh>(&QUAD_POSITIONS[0].x, QUAD_POSITIONS.size(), sizeof(glm::vec3), QUAD_INDICES);
+	sceneState.aabbs.resize(graph.nodes.size());
+	sceneState.pickMeshes.resize(graph.nodes.size());
+	for (const auto* node : { &nearQuad, &farQuad, &hiddenQuad }) {
+		sceneState.aabbs[node->nodeId] = quad->bounds();
+		sceneState.pickMeshes[node->nodeId] = quad;
+	}
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+
+	// Down -z, hitting the scaled quad at x = 1, which is outside the far quad
+	ENG::Ray ray;
+	ray.origin = { 1.5f, 0.5f, 0.f };
+	ray.direction = { 0.f, 0.f, -1.f };
+	auto hit = ENG::pick(sceneState, ray);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_EQ(hit->nodeId, nearQuad.nodeId);
+	EXPECT_NEAR(hit->distance, 5.f, 1e-4f);
+	EXPECT_NEAR(hit->barycentrics.x + hit->barycentrics.y + hit->barycentrics.z, 1.f, 1e-5f);
+
+	// Through the centre both quads are hit; the nearer one wins
+	ray.origin = { 0.2f, 0.1f, 0.f };
+	hit = ENG::pick(sceneState, ray);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_EQ(hit->nodeId, nearQuad.nodeId);
+
+	// Beyond the near quad's edge only the far quad is left
+	ray.origin = { 0.f, 0.f, -7.f };
+	hit = ENG::pick(sceneState, ray);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_EQ(hit->nodeId, farQuad.nodeId);
+	EXPECT_NEAR(hit->distance, 3.f, 1e-4f);
+
+	ray.origin = { 5.f, 5.f, 0.f };
+	EXPECT_FALSE(ENG::pick(sceneState, ray).has_value());
+}
+
+TEST(Picking, NonIndexedMeshPicksTheDrawnTriangles) {
+	// Flat shaded quad as loaders emit it for PosNorCol: one vertex triple per face, no indices
+	std::vector<ENG::VertexPosNorCol> vertices;
+	for (const uint32_t index : QUAD_INDICES) {
+		vertices.push_back({ QUAD_POSITIONS[index], { 0.f, 0.f, 1.f }, { 1.f, 1.f, 1.f, 1.f } });
+	}
+	const auto meshData = ENG::prepare_host_mesh_data(ENG::HostMeshData{ std::move(vertices), {}, "PosNorCol" });
+	ASSERT_FALSE(ENG::draws_indexed(meshData.indexBuffer.size()));
+	ASSERT_TRUE(meshData.pickMesh);
+	EXPECT_EQ(meshData.pickMesh->triangle_count(), 2u);
+
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& quad = graph.create_node();
+	graph.add_child(root, quad);
+	quad.translation = { 0.f, 0.f, -5.f };
+	quad.selectable = true;
+	sceneState.aabbs.resize(graph.nodes.size());
+	sceneState.pickMeshes.resize(graph.nodes.size());
+	sceneState.aabbs[quad.nodeId] = meshData.localBounds.box;
+	sceneState.pickMeshes[quad.nodeId] = meshData.pickMesh;
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+
+	// Both triangles of the quad are hit, the first one below the diagonal
+	ENG::Ray ray;
+	ray.origin = { 0.5f, -0.5f, 0.f };
+	ray.direction = { 0.f, 0.f, -1.f };
+	auto hit = ENG::pick(sceneState, ray);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_EQ(hit->nodeId, quad.nodeId);
+	EXPECT_EQ(hit->triangleId, 0u);
+	EXPECT_NEAR(hit->distance, 5.f, 1e-4f);
+
+	ray.origin = { -0.5f, 0.5f, 0.f };
+	hit = ENG::pick(sceneState, ray);
+	ASSERT_TRUE(hit.has_value());
+	EXPECT_EQ(hit->triangleId, 1u);
+}
+
+TEST(Picking, CursorRayThroughScreenCentreLooksDownTheView) {
+	const glm::mat4 view = glm::lookAt(glm::vec3(0.f, 0.f, 5.f), glm::vec3(0.f), glm::vec3(0.f, 1.f, 0.f));
+	glm::mat4 proj = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 100.f);
+	proj[1][1] *= -1;
+	const auto ray = ENG::cursor_ray(view, proj, { 0.f, 0.f });
+	EXPECT_NEAR(ray.origin.z, 5.f, 1e-4f);
+	EXPECT_NEAR(ray.direction.z, -1.f, 1e-4f);
+	EXPECT_NEAR(ray.maxT, 100.f, 1e-2f);
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/PlanetTileIndex.hpp"
+
+namespace {
+
+struct Tiling {
+	std::vector<uint32_t> offsets{ 0 };
+	std::vector<glm::vec3> vertices;
+
+	void add(const std::vector<glm::vec3>& polygon)
+	{
+		vertices.insert(vertices.end(), polygon.begin(), polygon.end());
+		offsets.push_back(static_cast<uint32_t>(vertices.size()));
+	}
+};
+
+// Rodrigues rotation by a fixed, arbitrary axis and angle
+glm::vec3 rotate_off_axes(const glm::vec3& v)
+{
+	const auto k = glm::normalize(glm::vec3(0.3f, -0.7f, 0.5f));
+	const float c = std::cos(0.61f);
+	const float s = std::sin(0.61f);
+	return v * c + glm::cross(k, v) * s + k * (glm::dot(k, v) * (1.f - c));
+}
+
+// n x n quads on every face of a cube, projected onto a sphere of the given radius and
+// rotated off the cube map axes. Grid lines of a cube project to great circles, so the
+// tiles are convex spherical quads covering the sphere exactly once.
+Tiling rotated_cube_sphere(uint32_t n, float radius)
+{
+	Tiling tiling;
+	const auto corner = [&](int axis, float sign, float u, float v) {
+		glm::vec3 p;
+		p[axis] = sign;
+		p[(axis + 1) % 3] = u;
+		p[(axis + 2) % 3] = v;
+		return rotate_off_axes(radius * glm::normalize(p));
+	};
+	for (int axis = 0; axis < 3; ++axis)
+		for (float sign : { 1.f, -1.f })
+			for (uint32_t j = 0; j < n; ++j)
+				for (uint32_t i = 0; i < n; ++i) {
+					const float u0 = -1.f + 2.f * i / n, u1 = -1.f + 2.f * (i + 1) / n;
+					const float v0 = -1.f + 2.f * j / n, v1 = -1.f + 2.f * (j + 1) / n;
+					tiling.add({ corner(axis, sign, u0, v0), corner(axis, sign, u1, v0), corner(axis, sign, u1, v1), corner(axis, sign, u0, v1) });
+				}
+	return tiling;
+}
+
+// Reference: every tile whose edge planes contain the direction, up to a tolerance for
+// directions on a shared edge, by linear search
+std::vector<uint32_t> brute_force_tiles(const Tiling& tiling, const glm::vec3& d)
+{
+	std::vector<uint32_t> tiles;
+	for (uint32_t tile = 0; tile + 1 < tiling.offsets.size(); ++tile) {
+		const auto first = tiling.offsets[tile];
+		const auto last = tiling.offsets[tile + 1];
+		glm::vec3 center{ 0.f };
+		for (auto i = first; i < last; ++i) center += glm::normalize(tiling.vertices[i]);
+		if (glm::dot(center, d) <= 0.f) continue;
+
+		int positive = 0, negative = 0;
+		for (auto i = first; i < last; ++i) {
+			const auto a = glm::normalize(tiling.vertices[i]);
+			const auto b = glm::normalize(tiling.vertices[i + 1 < last ? i + 1 : first]);
+			const float side = glm::dot(glm::cross(a, b), d);
+			positive += side > 1e-5f;
+			negative += side < -1e-5f;
+		}
+		if (positive == 0 || negative == 0) tiles.push_back(tile);
+	}
+	return tiles;
+}
+
+} // end namespace
+
+TEST(PlanetTileIndex, MatchesBruteForceAndStaysBounded) {
+	const auto tiling = rotated_cube_sphere(24, 2.f);
+	ENG::PlanetTileIndex index;
+	index.build(tiling.offsets, tiling.vertices);
+	ASSERT_EQ(index.tile_count(), 6u * 24u * 24u);
+	EXPECT_LE(index.max_candidates(), 16u);
+
+	std::mt19937 rng(3);
+	std::normal_distribution<float> dist;
+	for (int i = 0; i < 2000; ++i) {
+		const glm::vec3 d{ dist(rng), dist(rng), dist(rng) };
+		const auto expected = brute_force_tiles(tiling, glm::normalize(d));
+		ASSERT_FALSE(expected.empty());
+		const auto tile = index.tile_at(d);
+		ASSERT_TRUE(tile.has_value());
+		EXPECT_NE(std::find(expected.begin(), expected.end(), *tile), expected.end()) << "sample " << i;
+	}
+
+	// Candidate lists do not grow with the tile count
+	const auto fine = rotated_cube_sphere(128, 1.f);
+	ENG::PlanetTileIndex fineIndex;
+	fineIndex.build(fine.offsets, fine.vertices);
+	EXPECT_LE(fineIndex.max_candidates(), 16u);
+}
+
+TEST(PlanetTileIndex, CoarseOctahedronAndRayPick) {
+	// Eight octant triangles: every tile touches the horizon of some cube map face
+	Tiling octahedron;
+	const glm::vec3 x{ 1.f, 0.f, 0.f }, y{ 0.f, 1.f, 0.f }, z{ 0.f, 0.f, 1.f };
+	for (float sx : { 1.f, -1.f })
+		for (float sy : { 1.f, -1.f })
+			for (float sz : { 1.f, -1.f })
+				octahedron.add({ sx * x, sy * y, sz * z });
+
+	ENG::PlanetTileIndex index;
+	index.build(octahedron.offsets, octahedron.vertices);
+	EXPECT_EQ(index.tile_at({ 1.f, 1.f, 1.f }), 0u);
+	EXPECT_EQ(index.tile_at({ -1.f, -1.f, -1.f }), 7u);
+	EXPECT_EQ(index.tile_at({ 0.2f, -0.3f, 0.9f }), 2u);
+
+	// From outside along -z: enters at the +z pole region of the (+x, +y) quadrant
+	ENG::Ray ray;
+	ray.origin = { 0.1f, 0.1f, 5.f };
+	ray.direction = { 0.f, 0.f, -1.f };
+	EXPECT_EQ(index.pick(ray), 0u);
+
+	ray.maxT = 3.f;  // stops short of the sphere
+	EXPECT_FALSE(index.pick(ray).has_value());
+
+	ray.origin = { 3.f, 3.f, 5.f };
+	ray.maxT = std::numeric_limits<float>::max();
+	EXPECT_FALSE(index.pick(ray).has_value());
+
+	index.clear();
+	EXPECT_FALSE(index.tile_at({ 1.f, 0.f, 0.f }).has_value());
+}
@@ -0,0 +1,90 @@
+#include <atomic>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+#include "scene/Scene.hpp"
+#include "scene/PreorderIndex.hpp"
+
+TEST(PreorderIndex, SubtreesAreContiguousSlices) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& a = graph.create_node();
+	auto& b = graph.create_node();
+	auto& a0 = graph.create_node();
+	auto& a1 = graph.create_node();
+	graph.add_child(root, a);
+	graph.add_child(root, b);
+	graph.add_child(a, a0);
+	graph.add_child(a, a1);
+
+	ENG::PreorderIndex index;
+	ASSERT_TRUE(index.sync(graph));
+	EXPECT_FALSE(index.sync(graph));
+
+	const auto all = index.all();
+	EXPECT_EQ(std::vector<uint32_t>(all.begin(), all.end()),
+		(std::vector<uint32_t>{ root.nodeId, a.nodeId, a0.nodeId, a1.nodeId, b.nodeId }));
+
+	const auto sub = index.subtree(a.nodeId);
+	EXPECT_EQ(std::vector<uint32_t>(sub.begin(), sub.end()),
+		(std::vector<uint32_t>{ a.nodeId, a0.nodeId, a1.nodeId }));
+	EXPECT_EQ(index.subtree(b.nodeId).size(), 1u);
+
+	// Destroyed nodes drop out of the index on the next sync
+	const auto aId = a.nodeId;
+	const auto a0Id = a0.nodeId;
+	graph.destroy_subtree(a);
+	ASSERT_TRUE(index.sync(graph));
+	EXPECT_EQ(index.size(), 2u);
+	EXPECT_TRUE(index.subtree(a0Id).empty());
+	EXPECT_EQ(index.slot_of(aId), ENG::PreorderIndex::NO_SLOT);
+}
+
+TEST(PreorderIndex, EarlySyncStillTriggersFullTransformUpdate) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& child = graph.create_node();
+	child.translation = { 1.f, 2.f, 3.f };
+	graph.add_child(root, child);
+
+	ENG::TransformHierarchy transforms;
+	std::vector<glm::mat4> modelMatrices;
+	std::vector<ENG::MatrixRange> ranges;
+	// As the scene GUI does before iterating a subtree
+	transforms.sync_structure(graph);
+	transforms.update(graph, modelMatrices, ranges);
+
+	ASSERT_EQ(ranges.size(), 1u);
+	EXPECT_EQ(ranges[0].count, 2u);
+	ASSERT_EQ(modelMatrices.size(), 2u);
+	EXPECT_EQ(modelMatrices[child.nodeId][3], glm::vec4(1.f, 2.f, 3.f, 1.f));
+}
+
+TEST(PreorderIndex, SyncWhileLoaderAddsNodes) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+
+	// A loader thread growing the tree while the index is synced, as the GUI can do
+	std::atomic<bool> done{ false };
+	std::thread loader([&graph, &root, &done] {
+		for (int i = 0; i < 200; ++i) {
+			graph.create_nodes(8, &root);
+		}
+		done.store(true, std::memory_order_release);
+	});
+
+	ENG::PreorderIndex index;
+	while (!done.load(std::memory_order_acquire)) {
+		index.sync(graph);
+		EXPECT_EQ(index.all().front(), root.nodeId);
+	}
+	loader.join();
+
+	index.sync(graph);
+	EXPECT_EQ(index.size(), 1u + 200u * 8u);
+	EXPECT_EQ(index.subtree(root.nodeId).size(), index.size());
+}
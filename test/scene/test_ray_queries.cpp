@@ -0,0 +1,175 @@
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "scene/RayQueries.hpp"
+
+namespace {
+
+bool level_supported(ENG::SimdLevel level)
+{
+	return static_cast<int>(level) <= static_cast<int>(ENG::best_simd_level());
+}
+
+// Grid of transformed triangle soups, with one node that has no pick mesh
+struct RayScene {
+	ENG::SceneState sceneState;
+	std::vector<glm::vec3> positions;
+	uint32_t unpickableId{ 0 };
+
+	RayScene()
+	{
+		std::mt19937 rng(5);
+		std::uniform_real_distribution<float> offset(-1.f, 1.f);
+		for (int i = 0; i < 60; ++i) {
+			const glm::vec3 c{ offset(rng), offset(rng), offset(rng) };
+			for (int corner = 0; corner < 3; ++corner) {
+				positions.push_back(c + 0.4f * glm::vec3(offset(rng), offset(rng), offset(rng)));
+			}
+		}
+		const auto soup = std::make_shared<const ENG::TriangleBvh>(&positions[0].x, positions.size(), sizeof(glm::vec3), std::span<const uint32_t>{});
+
+		auto& graph = sceneState.graph;
+		auto& root = graph.create_node();
+		graph.root = &root;
+		std::vector<ENG::Node*> meshes;
+		for (int x = 0; x < 4; ++x) {
+			for (int y = 0; y < 3; ++y) {
+				auto& node = graph.create_node();
+				graph.add_child(root, node);
+				node.translation = { 3.f * x - 4.5f, 3.f * y - 3.f, -10.f - x };
+				node.scale = glm::vec3(0.8f + 0.1f * y);
+				node.rotation = glm::angleAxis(0.3f * x + 0.2f * y, glm::normalize(glm::vec3(1.f, 2.f, 0.5f)));
+				meshes.push_back(&node);
+			}
+		}
+
+		sceneState.aabbs.resize(graph.nodes.size());
+		sceneState.pickMeshes.resize(graph.nodes.size());
+		for (auto* node : meshes) {
+			sceneState.aabbs[node->nodeId] = soup->bounds();
+			sceneState.pickMeshes[node->nodeId] = soup;
+		}
+		// Bounded, so the scene BVH reaches it, but without triangles to hit
+		unpickableId = meshes.back()->nodeId;
+		sceneState.pickMeshes[unpickableId] = nullptr;
+
+		std::vector<ENG::MatrixRange> ranges;
+		sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+		ENG::update_world_bounds(sceneState, ranges);
+	}
+
+	// One ray at a time through every mesh
+	ENG::RayHit brute_force(const ENG::Ray& ray) const
+	{
+		ENG::RayHit best;
+		float bestT = ray.maxT;
+		for (uint32_t nodeId = 0; nodeId < sceneState.pickMeshes.size(); ++nodeId) {
+			if (!sceneState.pickMeshes[nodeId]) continue;
+			const auto toModel = glm::inverse(sceneState.modelMatrices[nodeId]);
+			ENG::Ray local;
+			local.origin = glm::vec3(toModel * glm::vec4(ray.origin, 1.f));
+			local.direction = glm::vec3(toModel * glm::vec4(ray.direction, 0.f));
+			local.maxT = bestT;
+			ENG::TriangleHit hit;
+			if (sceneState.pickMeshes[nodeId]->intersect(local, hit)) {
+				bestT = hit.t;
+				best = { nodeId, hit.triangleId, hit.t, hit.u, hit.v };
+			}
+		}
+		return best;
+	}
+};
+
+// Coherent sweep from the origin, with a count that leaves a partial packet
+std::vector<ENG::Ray> sweep_rays(float maxT)
+{
+	std::vector<ENG::Ray> rays;
+	for (int y = 0; y < 13; ++y) {
+		for (int x = 0; x < 23; ++x) {
+			ENG::Ray ray;
+			ray.origin = { 0.f, 0.f, 0.f };
+			ray.direction = glm::normalize(glm::vec3(-0.6f + 0.055f * x, -0.4f + 0.06f * y, -1.f));
+			ray.maxT = maxT;
+			rays.push_back(ray);
+		}
+	}
+	return rays;
+}
+
+} // end namespace
+
+class RayQueries : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(RayQueries, ClosestHitsMatchPerRayTraversal) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	const RayScene scene;
+	const auto rays = sweep_rays(100.f);
+	std::vector<ENG::RayHit> hits(rays.size());
+	ENG::intersect_rays(scene.sceneState, rays, hits, level);
+
+	size_t hitCount = 0;
+	for (size_t i = 0; i < rays.size(); ++i) {
+		const auto expected = scene.brute_force(rays[i]);
+		ASSERT_EQ(hits[i].hit(), expected.hit()) << "ray " << i;
+		if (!expected.hit()) continue;
+		++hitCount;
+		EXPECT_NE(hits[i].nodeId, scene.unpickableId);
+		EXPECT_NEAR(hits[i].t, expected.t, 1e-3f) << "ray " << i;
+		// Coplanar ties aside, the same triangle of the same node
+		if (std::fabs(hits[i].t - expected.t) > 1e-4f) continue;
+		EXPECT_EQ(hits[i].nodeId, expected.nodeId) << "ray " << i;
+		EXPECT_EQ(hits[i].triangleId, expected.triangleId) << "ray " << i;
+		EXPECT_NEAR(hits[i].u, expected.u, 1e-3f) << "ray " << i;
+		EXPECT_NEAR(hits[i].v, expected.v, 1e-3f) << "ray " << i;
+	}
+	EXPECT_GT(hitCount, rays.size() / 10);
+	EXPECT_LT(hitCount, rays.size());
+}
+
+TEST_P(RayQueries, OcclusionMatchesClosestHitWithinRange) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	const RayScene scene;
+	// Short enough that only part of the hits are in range
+	auto rays = sweep_rays(11.f);
+	std::vector<uint8_t> occluded(rays.size(), 2);
+	ENG::occluded_rays(scene.sceneState, rays, occluded, level);
+
+	size_t blocked = 0;
+	for (size_t i = 0; i < rays.size(); ++i) {
+		const auto expected = scene.brute_force(rays[i]);
+		EXPECT_EQ(occluded[i], expected.hit() ? 1 : 0) << "ray " << i;
+		blocked += occluded[i];
+	}
+	EXPECT_GT(blocked, 0u);
+}
+
+TEST(RayQueryBatch, EmptyBatchAndShortOutputs) {
+	const RayScene scene;
+	ENG::intersect_rays(scene.sceneState, {}, {});
+
+	const auto rays = sweep_rays(100.f);
+	std::vector<ENG::RayHit> hits(rays.size() - 1);
+	EXPECT_THROW(ENG::intersect_rays(scene.sceneState, rays, hits), std::runtime_error);
+	std::vector<uint8_t> occluded(rays.size() - 1);
+	EXPECT_THROW(ENG::occluded_rays(scene.sceneState, rays, occluded), std::runtime_error);
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, RayQueries,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});
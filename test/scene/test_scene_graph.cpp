@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+
+#include "scene/Scene.hpp"
+
+TEST(SceneGraph, DestroySubtreeRecyclesNodeIds) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& keep = graph.create_node();
+	auto& doomed = graph.create_node();
+	auto& doomedChild = graph.create_node();
+	graph.add_child(root, keep);
+	graph.add_child(root, doomed);
+	graph.add_child(doomed, doomedChild);
+	const auto doomedId = doomed.nodeId;
+	const auto doomedChildId = doomedChild.nodeId;
+	const auto doomedHandle = graph.handle_of(doomed);
+
+	std::vector<uint32_t> destroyedIds;
+	const auto versionBefore = graph.structure_version();
+	graph.destroy_subtree(doomed, [&destroyedIds](ENG::Node& node) { destroyedIds.push_back(node.nodeId); });
+
+	EXPECT_EQ(destroyedIds, (std::vector<uint32_t>{ doomedId, doomedChildId }));
+	EXPECT_GT(graph.structure_version(), versionBefore);
+	EXPECT_EQ(root.children, (std::vector<ENG::Node*>{ &keep }));
+	EXPECT_EQ(graph.nodes.live_count(), 2u);
+	EXPECT_EQ(graph.try_get(doomedHandle), nullptr);
+
+	// Released ids are handed out again before the pool grows
+	const auto& reused = graph.create_node();
+	EXPECT_TRUE(reused.nodeId == doomedId || reused.nodeId == doomedChildId);
+	EXPECT_TRUE(reused.children.empty());
+	EXPECT_EQ(reused.parent, nullptr);
+	EXPECT_EQ(graph.nodes.size(), 4u);
+
+	ENG::TransformHierarchy transforms;
+	transforms.sync_structure(graph);
+	EXPECT_EQ(transforms.size(), 3u);
+}
+
+TEST(SceneGraph, DestroyCallbacksMayUseTheGraph) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& doomed = graph.create_node();
+	graph.add_child(root, doomed);
+	graph.set_name(doomed, "doomed");
+
+	// Would deadlock if callbacks ran under the graph lock
+	std::vector<bool> stillNamed;
+	graph.destroy_subtree(doomed, [&graph, &stillNamed](ENG::Node& node) {
+		stillNamed.push_back(graph.find_by_name("doomed") == &node);
+		graph.mark_transform_dirty(node);
+		graph.set_name(node, "");
+	});
+
+	EXPECT_EQ(stillNamed, (std::vector<bool>{ true }));
+	EXPECT_EQ(graph.find_by_name("doomed"), nullptr);
+	EXPECT_EQ(graph.nodes.live_count(), 1u);
+}
+
+TEST(SceneGraph, DestroyRootClearsGraph) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	graph.add_child(root, graph.create_node());
+	graph.destroy_subtree(root);
+	EXPECT_EQ(graph.root, nullptr);
+	EXPECT_TRUE(graph.nodes.empty());
+}
+
+TEST(SceneGraph, NameIndexTracksRenameAndDestroy) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& a = graph.create_node();
+	auto& b = graph.create_node();
+	graph.add_child(root, a);
+	graph.add_child(root, b);
+
+	graph.set_name(a, "Suzanne");
+	graph.set_name(b, "Suzanne");
+	EXPECT_EQ(a.name(), "Suzanne");
+	EXPECT_EQ(a.name_symbol(), b.name_symbol());
+	// Duplicates resolve to the lowest nodeId, as the linear scan did
+	EXPECT_EQ(ENG::find_node_by_name(graph, "Suzanne"), &a);
+
+	graph.set_name(a, "Room-0");
+	EXPECT_EQ(graph.find_by_name("Room-0"), &a);
+	EXPECT_EQ(graph.find_by_name("Suzanne"), &b);
+
+	graph.destroy_subtree(b);
+	EXPECT_EQ(graph.find_by_name("Suzanne"), nullptr);
+	EXPECT_EQ(graph.find_by_name("never interned"), nullptr);
+
+	// A recycled slot starts unnamed
+	const auto& reused = graph.create_node();
+	EXPECT_TRUE(reused.name().empty());
+	EXPECT_EQ(graph.find_by_name("Room-0"), &a);
+}
+
+TEST(SceneGraph, CreateNodesLinksBatchInOneStep) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	// Leave a hole on the free list; the batch must still be contiguous
+	graph.destroy_subtree(graph.create_node());
+
+	const uint32_t R = ENG::SceneGraph::BATCH_ROOT;
+	const std::vector<uint32_t> batchParents{ R, 0, 0, 1, R };
+	const auto versionBefore = graph.structure_version();
+	const auto range = graph.create_nodes(batchParents, &root);
+	EXPECT_EQ(graph.structure_version(), versionBefore + 1);
+
+	ASSERT_EQ(range.count, 5u);
+	EXPECT_EQ(range.first, 2u);
+	for (size_t i = 0; i < range.count; ++i) {
+		EXPECT_EQ(graph.nodes[range.id(i)].nodeId, range.id(i));
+	}
+
+	const auto n = [&graph, range](size_t i) { return &graph.nodes[range.id(i)]; };
+	EXPECT_EQ(root.children, (std::vector<ENG::Node*>{ n(0), n(4) }));
+	EXPECT_EQ(n(0)->children, (std::vector<ENG::Node*>{ n(1), n(2) }));
+	EXPECT_EQ(n(1)->children, (std::vector<ENG::Node*>{ n(3) }));
+	EXPECT_EQ(n(3)->parent, n(1));
+	EXPECT_EQ(n(4)->parent, &root);
+
+	const std::vector<std::string> names{ "a", "b", "c", "d", "e" };
+	graph.set_names(range, names);
+	EXPECT_EQ(graph.find_by_name("d"), n(3));
+
+	// The free slot is still handed out by single creation
+	EXPECT_EQ(graph.create_node().nodeId, 1u);
+
+	ENG::TransformHierarchy transforms;
+	transforms.sync_structure(graph);
+	EXPECT_EQ(transforms.size(), graph.nodes.live_count());
+}
+
+TEST(SceneGraph, WorldBoundsFollowTransformsIntoBvh) {
+	ENG::SceneState sceneState;
+	auto& graph = sceneState.graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& mesh = graph.create_node();
+	graph.add_child(root, mesh);
+	sceneState.aabbs.resize(2);
+	sceneState.aabbs[mesh.nodeId] = ENG::make_aabb(glm::vec3(-1.f), glm::vec3(1.f));
+
+	std::vector<ENG::MatrixRange> ranges;
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+	ASSERT_NE(mesh.bvhProxy, ENG::DynamicAabbTree::NULL_NODE);
+	EXPECT_EQ(graph.bvh.proxy_count(), 1u);
+
+	root.translation = { 100.f, 0.f, 0.f };
+	graph.mark_transform_dirty(root);
+	ranges.clear();
+	sceneState.transforms.update(graph, sceneState.modelMatrices, ranges);
+	ENG::update_world_bounds(sceneState, ranges);
+
+	std::vector<uint32_t> hits;
+	const auto probe = ENG::Sphere{ glm::vec3(100.f, 0.f, 0.f), 0.5f };
+	graph.bvh.query(probe, [&hits](uint32_t id) { hits.push_back(id); return true; });
+	EXPECT_EQ(hits, (std::vector<uint32_t>{ mesh.nodeId }));
+
+	graph.destroy_subtree(mesh);
+	EXPECT_EQ(graph.bvh.proxy_count(), 0u);
+}
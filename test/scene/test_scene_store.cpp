@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "scene/Node.hpp"
+
+TEST(SceneStore, HasPropertyTestsBitsNotTruthiness) {
+	ENG::property_t flags = ENG::HAS_DRAW_DATA;
+	EXPECT_TRUE(ENG::has_property(flags, ENG::HAS_DRAW_DATA));
+	EXPECT_FALSE(ENG::has_property(flags, ENG::IS_VISIBLE));
+	ENG::set_property(flags, ENG::IS_VISIBLE);
+	EXPECT_TRUE(ENG::has_property(flags, ENG::HAS_DRAW_DATA | ENG::IS_VISIBLE));
+	ENG::clear_property(flags, ENG::HAS_DRAW_DATA);
+	EXPECT_EQ(flags, ENG::IS_VISIBLE);
+}
+
+TEST(SceneStore, TraversalVisibilityAndDraws) {
+	ENG::SmallSceneStore store;
+	using Id = ENG::SmallSceneStore::id_type;
+	const auto root = store.create();
+	const auto a = store.create(root);
+	const auto b = store.create(root);
+	const auto a0 = store.create(a);
+	const auto b0 = store.create(b);
+	const auto otherRoot = store.create();
+	store.set_name(a, "A");
+	EXPECT_EQ(store.name(a), "A");
+	EXPECT_TRUE(store.has_property(a, ENG::HAS_NAME));
+
+	std::vector<std::pair<Id, uint32_t>> order;
+	store.depth_first_traverse([&order](Id id, uint32_t depth) { order.emplace_back(id, depth); });
+	const std::vector<std::pair<Id, uint32_t>> expected{
+		{ root, 0 }, { a, 1 }, { a0, 2 }, { b, 1 }, { b0, 2 }, { otherRoot, 0 } };
+	EXPECT_EQ(order, expected);
+
+	// Hiding a hides its whole subtree
+	store.clear_property(a, ENG::IS_VISIBLE);
+	std::vector<Id> visible;
+	store.gather_visible(visible);
+	EXPECT_EQ(visible, (std::vector<Id>{ root, b, b0, otherRoot }));
+
+	store.set_draw_data(a0, 7);
+	store.set_draw_data(b0, 3);
+	std::vector<std::pair<Id, uint32_t>> draws;
+	store.for_each_drawable([&draws](Id id, uint32_t drawIdx) { draws.emplace_back(id, drawIdx); });
+	EXPECT_EQ(draws, (std::vector<std::pair<Id, uint32_t>>{ { b0, 3 } }));
+
+	EXPECT_THROW(store.create(Id{ 100 }), std::out_of_range);
+}
+
+TEST(SceneStore, CapacityIsEnforced) {
+	ENG::SceneStore<uint8_t, 2> store;
+	store.create();
+	store.create(0);
+	EXPECT_THROW(store.create(), std::runtime_error);
+}
@@ -0,0 +1,191 @@
+#include <gtest/gtest.h>
+
+#include "scene/Scene.hpp"
+#include "scene/Transform.hpp"
+#include "application/ThreadPool.hpp"
+
+namespace {
+
+void expect_mat_near(const glm::mat4& a, const glm::mat4& b)
+{
+	for (int c = 0; c < 4; ++c)
+		for (int r = 0; r < 4; ++r)
+			EXPECT_NEAR(a[c][r], b[c][r], 1e-5f) << "column " << c << " row " << r;
+}
+
+} // end namespace
+
+TEST(TransformHierarchy, ParentsPrecedeChildren) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& a = graph.create_node();
+	auto& b = graph.create_node();
+	auto& c = graph.create_node();
+	graph.add_child(root, b);
+	graph.add_child(b, a);
+	graph.add_child(root, c);
+
+	ENG::TransformHierarchy transforms;
+	ASSERT_TRUE(transforms.sync_structure(graph));
+	ASSERT_EQ(transforms.size(), 4u);
+
+	const std::vector<uint32_t> expectedOrder{ root.nodeId, b.nodeId, a.nodeId, c.nodeId };
+	EXPECT_EQ(transforms.node_ids(), expectedOrder);
+	for (size_t slot = 0; slot < transforms.size(); ++slot) {
+		const auto parentSlot = transforms.parent_slots()[slot];
+		if (parentSlot != ENG::TransformHierarchy::NO_PARENT) {
+			EXPECT_LT(parentSlot, slot);
+		}
+	}
+
+	EXPECT_FALSE(transforms.sync_structure(graph));
+	graph.add_child(c, a);
+	EXPECT_TRUE(transforms.sync_structure(graph));
+}
+
+TEST(TransformHierarchy, WorldMatricesMatchNestedTransforms) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& parent = graph.create_node();
+	auto& child = graph.create_node();
+	auto& detached = graph.create_node();
+	graph.add_child(root, parent);
+	graph.add_child(parent, child);
+
+	root.translation = { 0.f, 1.f, 0.f };
+	parent.translation = { 1.f, 2.f, 3.f };
+	parent.rotation = glm::angleAxis(glm::radians(90.f), glm::vec3(0.f, 1.f, 0.f));
+	parent.scale = glm::vec3(2.f);
+	child.translation = { 0.f, 0.f, 1.f };
+	detached.translation = { 5.f, 0.f, 0.f };
+
+	ENG::TransformHierarchy transforms;
+	transforms.sync_structure(graph);
+	transforms.gather_local_transforms(graph);
+	std::vector<glm::mat4> modelMatrices(graph.nodes.size());
+	transforms.update_world_matrices(modelMatrices);
+
+	const auto local = [](const ENG::Node& n) {
+		return ENG::compose_trs(ENG::TRS{ n.translation, n.rotation, n.scale });
+	};
+	expect_mat_near(modelMatrices[root.nodeId], local(root));
+	expect_mat_near(modelMatrices[parent.nodeId], local(root) * local(parent));
+	expect_mat_near(modelMatrices[child.nodeId], local(root) * local(parent) * local(child));
+	expect_mat_near(modelMatrices[detached.nodeId], local(detached));
+
+	// Child origin: root (0,1,0) + parent (1,2,3) + (0,0,1) scaled to (0,0,2) and rotated to (2,0,0) -> (3,3,3)
+	const glm::vec4 origin = modelMatrices[child.nodeId] * glm::vec4(0.f, 0.f, 0.f, 1.f);
+	EXPECT_NEAR(origin.x, 3.f, 1e-5f);
+	EXPECT_NEAR(origin.y, 3.f, 1e-5f);
+	EXPECT_NEAR(origin.z, 3.f, 1e-5f);
+}
+
+TEST(TransformHierarchy, IncrementalUpdateTouchesOnlyDirtySubtrees) {
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	auto& a = graph.create_node();
+	auto& a1 = graph.create_node();
+	auto& b = graph.create_node();
+	auto& b1 = graph.create_node();
+	graph.add_child(root, a);
+	graph.add_child(a, a1);
+	graph.add_child(root, b);
+	graph.add_child(b, b1);
+
+	ENG::TransformHierarchy transforms;
+	std::vector<glm::mat4> modelMatrices(graph.nodes.size());
+	std::vector<ENG::MatrixRange> changed;
+
+	// First update after structural changes writes everything
+	transforms.update(graph, modelMatrices, changed);
+	ASSERT_EQ(changed.size(), 1u);
+	EXPECT_EQ(changed[0].first, 0u);
+	EXPECT_EQ(changed[0].count, graph.nodes.size());
+
+	// Nothing moved, nothing written
+	changed.clear();
+	transforms.update(graph, modelMatrices, changed);
+	EXPECT_TRUE(changed.empty());
+
+	// Moving a only rewrites a and a1
+	a.translation = { 1.f, 0.f, 0.f };
+	graph.mark_transform_dirty(a);
+	graph.mark_transform_dirty(a1);
+	changed.clear();
+	transforms.update(graph, modelMatrices, changed);
+	ASSERT_EQ(changed.size(), 1u);
+	EXPECT_EQ(changed[0].first, a.nodeId);
+	EXPECT_EQ(changed[0].count, 2u);
+	EXPECT_NEAR(modelMatrices[a1.nodeId][3].x, 1.f, 1e-6f);
+	EXPECT_NEAR(modelMatrices[b1.nodeId][3].x, 0.f, 1e-6f);
+}
+
+TEST(TransformHierarchy, MergeMatrixRanges) {
+	std::vector<ENG::MatrixRange> ranges{ { 10, 2 }, { 0, 3 }, { 3, 1 }, { 11, 4 }, { 20, 1 } };
+	ENG::merge_matrix_ranges(ranges);
+	ASSERT_EQ(ranges.size(), 3u);
+	EXPECT_EQ(ranges[0].first, 0u);
+	EXPECT_EQ(ranges[0].count, 4u);
+	EXPECT_EQ(ranges[1].first, 10u);
+	EXPECT_EQ(ranges[1].count, 5u);
+	EXPECT_EQ(ranges[2].first, 20u);
+	EXPECT_EQ(ranges[2].count, 1u);
+}
+
+TEST(TransformHierarchy, ParallelUpdateMatchesSerial) {
+	// Wide and deep mix: root -> 8 groups -> 64 children -> 4 leaves each
+	ENG::SceneGraph graph;
+	auto& root = graph.create_node();
+	graph.root = &root;
+	for (int g = 0; g < 8; ++g) {
+		auto& group = graph.create_node();
+		group.translation = { float(g), 0.f, 0.f };
+		graph.add_child(root, group);
+		for (int c = 0; c < 64; ++c) {
+			auto& child = graph.create_node();
+			child.rotation = glm::angleAxis(0.01f * c, glm::vec3(0.f, 1.f, 0.f));
+			child.translation = { 0.f, float(c), 0.f };
+			graph.add_child(group, child);
+			for (int l = 0; l < 4; ++l) {
+				auto& leaf = graph.create_node();
+				leaf.scale = glm::vec3(1.f + 0.1f * l);
+				leaf.translation = { 0.f, 0.f, float(l) };
+				graph.add_child(child, leaf);
+			}
+		}
+	}
+
+	ENG::TransformHierarchy serial;
+	serial.sync_structure(graph);
+	serial.gather_local_transforms(graph);
+	std::vector<glm::mat4> expected(graph.nodes.size());
+	serial.update_world_matrices(expected);
+
+	ThreadPool pool(3);
+	ENG::TransformHierarchy parallel;
+	parallel.set_thread_pool(&pool);
+	parallel.set_parallel_policy(0, 16);
+	parallel.sync_structure(graph);
+	parallel.gather_local_transforms(graph);
+	std::vector<glm::mat4> actual(graph.nodes.size());
+	parallel.update_world_matrices(actual);
+
+	for (size_t i = 0; i < expected.size(); ++i) {
+		ASSERT_TRUE(expected[i] == actual[i]) << "node " << i;
+	}
+
+	// Dirty update of one group subtree goes through the same partition
+	auto& group = *root.children[2];
+	group.translation = { 0.f, 0.f, -5.f };
+	graph.mark_transform_dirty(group);
+	serial.gather_local_transforms(graph);
+	serial.update_world_matrices(expected);
+	std::vector<ENG::MatrixRange> changed;
+	parallel.update(graph, actual, changed);
+	for (size_t i = 0; i < expected.size(); ++i) {
+		ASSERT_TRUE(expected[i] == actual[i]) << "node " << i;
+	}
+}
@@ -0,0 +1,58 @@
+#include <random>
+
+#include <gtest/gtest.h>
+
+#include "scene/TransformKernels.hpp"
+
+namespace {
+
+std::vector<ENG::TRS> random_transforms(size_t count)
+{
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> dist(-2.f, 2.f);
+	std::vector<ENG::TRS> transforms(count);
+	for (auto& trs : transforms) {
+		trs.translation = { dist(rng), dist(rng), dist(rng) };
+		trs.rotation = glm::normalize(glm::quat(dist(rng), dist(rng), dist(rng), dist(rng)));
+		trs.scale = { dist(rng), dist(rng), dist(rng) };
+	}
+	return transforms;
+}
+
+bool level_supported(ENG::SimdLevel level)
+{
+	return static_cast<int>(level) <= static_cast<int>(ENG::best_simd_level());
+}
+
+} // end namespace
+
+class ComposeTrsBatch : public ::testing::TestWithParam<ENG::SimdLevel> {};
+
+TEST_P(ComposeTrsBatch, MatchesComposeTrs) {
+	const auto level = GetParam();
+	if (!level_supported(level)) {
+		GTEST_SKIP() << ENG::to_string(level) << " not supported on this CPU";
+	}
+
+	// Odd count exercises the vector body and the scalar tail
+	const auto transforms = random_transforms(37);
+	std::vector<glm::mat4> batched(transforms.size());
+	ENG::compose_trs_batch(transforms.data(), batched.data(), transforms.size(), level);
+
+	for (size_t i = 0; i < transforms.size(); ++i) {
+		const auto expected = ENG::compose_trs(transforms[i]);
+		for (int c = 0; c < 4; ++c)
+			for (int r = 0; r < 4; ++r)
+				ASSERT_NEAR(batched[i][c][r], expected[c][r], 1e-5f) << "matrix " << i << " column " << c << " row " << r;
+	}
+}
+
+INSTANTIATE_TEST_SUITE_P(SimdLevels, ComposeTrsBatch,
+	::testing::Values(ENG::SimdLevel::Scalar, ENG::SimdLevel::SSE41, ENG::SimdLevel::AVX2),
+	[](const ::testing::TestParamInfo<ENG::SimdLevel>& info) {
+		switch (info.param) {
+		case ENG::SimdLevel::AVX2: return std::string("AVX2");
+		case ENG::SimdLevel::SSE41: return std::string("SSE41");
+		default: return std::string("Scalar");
+		}
+	});